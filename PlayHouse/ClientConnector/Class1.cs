@@ -1,7 +0,0 @@
-﻿namespace ClientConnector
-{
-    public class Class1
-    {
-
-    }
-}
\ No newline at end of file
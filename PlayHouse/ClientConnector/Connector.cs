@@ -0,0 +1,477 @@
+﻿using System.Buffers;
+using System.Diagnostics;
+using System.IO.Pipelines;
+using ClientConnector.Transport;
+using PlayHouse.Service.Session.Network;
+
+namespace ClientConnector;
+
+/// <summary>
+///     Client that connects to a session server.
+///     Requests are matched with replies by msgSeq, so several can be sent back to back without waiting (pipelining).
+///     Outgoing frames are written straight to the send pipe and the send loop hands whatever piled up to the
+///     transport at once. Received bytes are cut by PacketFrame, replies go to the RequestTable, the rest to OnReceive.
+/// </summary>
+public sealed class Connector : IAsyncDisposable
+{
+    private const int MaxBodySize = 1024 * 1024 * 2;
+    private const string HeartBeatMsgId = "@Heart@Beat@";
+    private const string CompressionMsgId = "@Compression@";
+    private const int TickMs = 100;
+
+    private readonly MsgIdCache _msgIds = new();
+    private readonly Stopwatch _stopwatch = Stopwatch.StartNew();
+    private readonly object _writeLock = new();
+
+    private ConnectorConfig _config = new();
+    private CancellationTokenSource? _cancel;
+    private volatile bool _compress;
+    private int _connected;
+    private long _lastReceiveMs;
+    private long _lastHeartBeatMs;
+    private Task? _receiveTask;
+    private RequestTable _requests = null!;
+    private Pipe? _sendPipe;
+    private Task? _sendTask;
+    private Timer? _timer;
+    private IConnectorTransport? _transport;
+
+    public bool IsConnected => Volatile.Read(ref _connected) == 1;
+    public bool IsAuthenticated { get; private set; }
+
+    // packets that are not replies (server push), the handler must Dispose them, called on the receive loop
+    public event Action<Packet>? OnReceive;
+    public event Action? OnDisconnect;
+
+    public void Init(ConnectorConfig config)
+    {
+        _config = config;
+        _requests = new RequestTable(config.MaxPendingRequests, config.RequestTimeoutMs);
+        _msgIds.Register(HeartBeatMsgId);
+    }
+
+    // registered up front so packets the server sends with a numeric msgId get their name
+    public void RegisterMsgId(string msgId)
+    {
+        _msgIds.Register(msgId);
+    }
+
+    public void Connect()
+    {
+        ConnectAsync().GetAwaiter().GetResult();
+    }
+
+    public async Task ConnectAsync(CancellationToken token = default)
+    {
+        if (IsConnected)
+        {
+            return;
+        }
+
+        _requests ??= new RequestTable(_config.MaxPendingRequests, _config.RequestTimeoutMs);
+
+        IConnectorTransport transport = _config.UseWebsocket
+            ? new WebSocketTransport(new UriBuilder("ws", _config.Host, _config.Port, _config.WebSocketPath).Uri)
+            : new TcpTransport(_config.Host, _config.Port);
+
+        await transport.ConnectAsync(token);
+
+        _transport = transport;
+        _cancel = new CancellationTokenSource();
+        _sendPipe = new Pipe(new PipeOptions(pauseWriterThreshold: 0, useSynchronizationContext: false));
+        IsAuthenticated = false;
+        _lastReceiveMs = _lastHeartBeatMs = _stopwatch.ElapsedMilliseconds;
+        Volatile.Write(ref _connected, 1);
+
+        _sendTask = SendLoop(_sendPipe.Reader, transport, _cancel.Token);
+        _receiveTask = ReceiveLoop(transport.Input, _cancel.Token);
+        _timer = new Timer(_ => OnTick(), null, TickMs, TickMs);
+
+        _compress = false;
+        if (_config.CompressThreshold > 0)
+        {
+            // once the server accepts, requests are compressed from then on
+            using var reply = await RequestAsync(0, new Packet(CompressionMsgId));
+            _compress = reply.ErrorCode == 0;
+        }
+    }
+
+    public void Disconnect()
+    {
+        DisconnectAsync().GetAwaiter().GetResult();
+    }
+
+    public async Task DisconnectAsync()
+    {
+        if (Interlocked.Exchange(ref _connected, 0) == 0)
+        {
+            return;
+        }
+
+        await CloseAsync();
+    }
+
+    public async ValueTask DisposeAsync()
+    {
+        await DisconnectAsync();
+    }
+
+    public void Send(ushort serviceId, Packet packet, long stageId = 0)
+    {
+        using (packet)
+        {
+            Write(serviceId, packet, 0, stageId);
+        }
+    }
+
+    // the result must be awaited to free its table slot, the reply packet must be disposed
+    // a reply with a non zero ErrorCode is returned as is, without an exception
+    public ValueTask<Packet> RequestAsync(ushort serviceId, Packet packet, long stageId = 0)
+    {
+        if (!IsConnected)
+        {
+            packet.Dispose();
+            return ValueTask.FromException<Packet>(new ConnectorException("connector is not connected"));
+        }
+
+        var seq = _requests.Reserve(out var task);
+        try
+        {
+            using (packet)
+            {
+                Write(serviceId, packet, seq, stageId);
+            }
+        }
+        catch (Exception e)
+        {
+            _requests.Cancel(seq, e);
+        }
+
+        return task;
+    }
+
+    public async ValueTask<Packet> AuthenticateAsync(ushort serviceId, Packet packet)
+    {
+        var reply = await RequestAsync(serviceId, packet);
+        if (reply.ErrorCode == 0)
+        {
+            IsAuthenticated = true;
+        }
+
+        return reply;
+    }
+
+    private void Write(ushort serviceId, Packet packet, ushort msgSeq, long stageId)
+    {
+        var bodySize = packet.BodySize;
+        if (bodySize > MaxBodySize)
+        {
+            throw new ConnectorException($"body size is over : {bodySize}");
+        }
+
+        var msgNum = _config.UseNumericMsgId ? _msgIds.Register(packet.MsgId) : 0;
+        var maxHeaderSize = PacketFrame.RequestHeaderSize + PacketFrame.MaxMsgIdSize * 3;
+
+        if (_compress && bodySize >= _config.CompressThreshold)
+        {
+            WriteCompressed(serviceId, packet, msgSeq, stageId, msgNum, bodySize, maxHeaderSize);
+            return;
+        }
+
+        lock (_writeLock)
+        {
+            var writer = _sendPipe?.Writer ?? throw new ConnectorException("connector is not connected");
+            var span = writer.GetSpan(maxHeaderSize + bodySize);
+            var headerSize = PacketFrame.WriteHeader(span, bodySize, serviceId, packet.MsgId, msgNum, msgSeq,
+                stageId, null);
+            packet.WriteBody(span[headerSize..], bodySize);
+            writer.Advance(headerSize + bodySize);
+
+            // completes right away since pauseWriterThreshold is 0, the actual send happens on the send loop
+            _ = writer.FlushAsync();
+        }
+    }
+
+    private void WriteCompressed(ushort serviceId, Packet packet, ushort msgSeq, long stageId, int msgNum,
+        int bodySize, int maxHeaderSize)
+    {
+        var body = ArrayPool<byte>.Shared.Rent(bodySize);
+        try
+        {
+            packet.WriteBody(body, bodySize);
+
+            lock (_writeLock)
+            {
+                var writer = _sendPipe?.Writer ?? throw new ConnectorException("connector is not connected");
+                var span = writer.GetSpan(maxHeaderSize + FrameCompression.MaxCompressedSize(bodySize));
+                var headerSize = PacketFrame.WriteHeader(span, bodySize, serviceId, packet.MsgId, msgNum, msgSeq,
+                    stageId, null);
+
+                var size = FrameCompression.Compress(body.AsSpan(0, bodySize), span[headerSize..]);
+                if (size > 0)
+                {
+                    PacketFrame.WriteBodySize(span, size, true);
+                }
+                else
+                {
+                    // sent as is when it does not shrink
+                    body.AsSpan(0, bodySize).CopyTo(span[headerSize..]);
+                    size = bodySize;
+                }
+
+                writer.Advance(headerSize + size);
+                _ = writer.FlushAsync();
+            }
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(body);
+        }
+    }
+
+    private async Task SendLoop(PipeReader reader, IConnectorTransport transport, CancellationToken token)
+    {
+        try
+        {
+            while (true)
+            {
+                var result = await reader.ReadAsync(token);
+                var buffer = result.Buffer;
+                if (!buffer.IsEmpty)
+                {
+                    await transport.SendAsync(buffer, token);
+                }
+
+                reader.AdvanceTo(buffer.End);
+                if (result.IsCompleted)
+                {
+                    break;
+                }
+            }
+        }
+        catch (Exception)
+        {
+            // disconnected while sending
+            OnBroken();
+        }
+
+        await reader.CompleteAsync();
+    }
+
+    private async Task ReceiveLoop(PipeReader input, CancellationToken token)
+    {
+        try
+        {
+            while (true)
+            {
+                var result = await input.ReadAsync(token);
+                var buffer = result.Buffer;
+
+                while (TryReadFrame(ref buffer, out var packet))
+                {
+                    Dispatch(packet);
+                }
+
+                input.AdvanceTo(buffer.Start, buffer.End);
+                if (result.IsCompleted)
+                {
+                    break;
+                }
+            }
+        }
+        catch (Exception)
+        {
+            // fails as expected while disconnecting, either way OnBroken cleans up
+        }
+
+        OnBroken();
+    }
+
+    // when the server disconnected or the transport failed, during Disconnect it is already 0 and does nothing
+    private void OnBroken()
+    {
+        if (Interlocked.Exchange(ref _connected, 0) == 1)
+        {
+            _ = CloseAsync();
+        }
+    }
+
+    private bool TryReadFrame(ref ReadOnlySequence<byte> buffer, out Packet packet)
+    {
+        packet = null!;
+        if (buffer.Length <= PacketFrame.MsgIdSizeOffset)
+        {
+            return false;
+        }
+
+        Span<byte> head = stackalloc byte[PacketFrame.MsgIdSizeOffset + 1];
+        buffer.Slice(0, head.Length).CopyTo(head);
+        var bodySize = PacketFrame.BodySizeOf(head);
+        if (bodySize > MaxBodySize)
+        {
+            throw new ConnectorException($"body size is invalid : {bodySize}");
+        }
+
+        var frameSize = PacketFrame.FrameSizeOf(head, true);
+        if (buffer.Length < frameSize)
+        {
+            return false;
+        }
+
+        var frame = buffer.Slice(0, frameSize);
+        if (frame.IsSingleSegment)
+        {
+            packet = Parse(frame.FirstSpan);
+        }
+        else
+        {
+            // copies only when a frame spans several segments
+            var rented = ArrayPool<byte>.Shared.Rent(frameSize);
+            try
+            {
+                frame.CopyTo(rented);
+                packet = Parse(rented.AsSpan(0, frameSize));
+            }
+            finally
+            {
+                ArrayPool<byte>.Shared.Return(rented);
+            }
+        }
+
+        buffer = buffer.Slice(frameSize);
+        return true;
+    }
+
+    private Packet Parse(ReadOnlySpan<byte> frame)
+    {
+        var header = PacketFrame.ReadHeader(frame, true);
+        var msgId = header.MsgIdSize == 0
+            ? _msgIds.NameOf(header.MsgNum)
+            : _msgIds.Intern(frame.Slice(header.MsgIdOffset, header.MsgIdSize));
+
+        var body = frame.Slice(header.BodyOffset, header.BodySize);
+        if (!header.Compressed)
+        {
+            return Packet.Received(msgId, header.MsgNum, header.ServiceId, header.MsgSeq, header.StageId,
+                header.ErrorCode, body);
+        }
+
+        var rawSize = body.Length < FrameCompression.RawSizeFieldSize ? -1 : FrameCompression.RawSizeOf(body);
+        if (rawSize <= 0 || rawSize > MaxBodySize)
+        {
+            throw new ConnectorException($"compressed body size is invalid : {rawSize}");
+        }
+
+        var rented = ArrayPool<byte>.Shared.Rent(rawSize);
+        try
+        {
+            FrameCompression.Decompress(body, rented.AsSpan(0, rawSize));
+        }
+        catch
+        {
+            ArrayPool<byte>.Shared.Return(rented);
+            throw;
+        }
+
+        return Packet.Received(msgId, header.MsgNum, header.ServiceId, header.MsgSeq, header.StageId,
+            header.ErrorCode, rented, rawSize);
+    }
+
+    private void Dispatch(Packet packet)
+    {
+        Volatile.Write(ref _lastReceiveMs, _stopwatch.ElapsedMilliseconds);
+
+        if (packet.MsgId == HeartBeatMsgId)
+        {
+            packet.Dispose();
+            return;
+        }
+
+        if (packet.MsgSeq != 0)
+        {
+            if (!_requests.TryComplete(packet))
+            {
+                packet.Dispose();
+            }
+
+            return;
+        }
+
+        var handler = OnReceive;
+        if (handler == null)
+        {
+            packet.Dispose();
+            return;
+        }
+
+        handler(packet);
+    }
+
+    private void OnTick()
+    {
+        if (!IsConnected)
+        {
+            return;
+        }
+
+        _requests.ExpireTimeouts();
+
+        var now = _stopwatch.ElapsedMilliseconds;
+        if (_config.HeartBeatTimeoutMs > 0 && now - Volatile.Read(ref _lastReceiveMs) > _config.HeartBeatTimeoutMs)
+        {
+            _ = DisconnectAsync();
+            return;
+        }
+
+        if (_config.HeartBeatIntervalMs > 0 && now - _lastHeartBeatMs >= _config.HeartBeatIntervalMs)
+        {
+            _lastHeartBeatMs = now;
+            try
+            {
+                Write(0, new Packet(HeartBeatMsgId), 0, 0);
+            }
+            catch (ConnectorException)
+            {
+            }
+        }
+    }
+
+    // can start inside the send or receive loop, neither waits for CloseAsync so waiting on each other is safe
+    private async Task CloseAsync()
+    {
+        if (_timer != null)
+        {
+            await _timer.DisposeAsync();
+        }
+
+        lock (_writeLock)
+        {
+            _sendPipe?.Writer.Complete();
+            _sendPipe = null;
+        }
+
+        // sends the remaining frames and ends
+        if (_sendTask != null)
+        {
+            await _sendTask;
+        }
+
+        _cancel?.Cancel();
+        if (_receiveTask != null)
+        {
+            await _receiveTask;
+        }
+
+        if (_transport != null)
+        {
+            await _transport.DisposeAsync();
+        }
+
+        _requests.FailAll(new ConnectorException("connector is disconnected"));
+        _cancel?.Dispose();
+        _cancel = null;
+        _transport = null;
+
+        OnDisconnect?.Invoke();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+﻿namespace ClientConnector;
+
+public class ConnectorConfig
+{
+    public string Host { get; set; } = "127.0.0.1";
+    public int Port { get; set; }
+    public bool UseWebsocket { get; set; }
+    public string WebSocketPath { get; set; } = "/";
+
+    public int RequestTimeoutMs { get; set; } = 5000; // 0 means no timeout
+    public int HeartBeatIntervalMs { get; set; } = 1000; // 0 sends no heartbeat
+    public int HeartBeatTimeoutMs { get; set; } = 0; // disconnects when nothing is received for this long, 0 disables the check
+
+    // requests that can wait for a reply at the same time, a power of two
+    public int MaxPendingRequests { get; set; } = 1024;
+
+    // sends msgIds as their hash, the server only accepts registered msgIds as numbers
+    public bool UseNumericMsgId { get; set; }
+
+    // above 0 compression is negotiated with the server on connect, requests with a body of this size or more are compressed
+    // compressed packets from the server are accepted whatever this is
+    public int CompressThreshold { get; set; }
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+﻿namespace ClientConnector;
+
+public class ConnectorException(string message) : Exception(message)
+{
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+﻿using System.Collections.Concurrent;
+using System.Text;
+using PlayHouse.Service.Session.Network;
+
+namespace ClientConnector;
+
+// caches received msgIds by hash so they are not turned into strings every time, also maps numeric msgIds back to names
+internal sealed class MsgIdCache
+{
+    private const int MaxCount = 4096;
+
+    private readonly ConcurrentDictionary<int, (string name, byte[] utf8)> _names = new();
+
+    public int Register(string msgId)
+    {
+        var id = PacketFrame.HashOf(msgId);
+        if (id != 0 && _names.Count < MaxCount)
+        {
+            _names.TryAdd(id, (msgId, Encoding.UTF8.GetBytes(msgId)));
+        }
+
+        return id;
+    }
+
+    public string NameOf(int msgNum)
+    {
+        return _names.TryGetValue(msgNum, out var entry) ? entry.name : string.Empty;
+    }
+
+    public string Intern(ReadOnlySpan<byte> utf8)
+    {
+        var id = PacketFrame.HashOf(utf8);
+        if (_names.TryGetValue(id, out var entry) && utf8.SequenceEqual(entry.utf8))
+        {
+            return entry.name;
+        }
+
+        var name = Encoding.UTF8.GetString(utf8);
+        if (_names.Count < MaxCount)
+        {
+            _names.TryAdd(id, (name, utf8.ToArray()));
+        }
+
+        return name;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+﻿using System.Buffers;
+using System.Collections.Concurrent;
+using Google.Protobuf;
+
+namespace ClientConnector;
+
+/// <summary>
+///     Packets to send are built from an IMessage or bytes, received packets are pooled instances holding a pool buffer.
+///     Dispose a received packet when done so the instance and buffer are reused.
+/// </summary>
+public sealed class Packet : IDisposable
+{
+    private const int MaxPoolSize = 4096;
+    private static readonly ConcurrentQueue<Packet> Pool = new();
+
+    private byte[]? _rented;
+    private ReadOnlyMemory<byte> _data;
+    private IMessage? _message;
+    private bool _pooled;
+
+    public Packet(IMessage message)
+    {
+        MsgId = message.Descriptor.Name;
+        _message = message;
+    }
+
+    public Packet(string msgId, ReadOnlyMemory<byte> data)
+    {
+        MsgId = msgId;
+        _data = data;
+    }
+
+    public Packet(string msgId) : this(msgId, ReadOnlyMemory<byte>.Empty)
+    {
+    }
+
+    private Packet()
+    {
+        MsgId = string.Empty;
+    }
+
+    public string MsgId { get; private set; }
+
+    // header of a packet received from the server
+    public int MsgNum { get; private set; } // MsgId is empty when a numeric msgId arrived with an unknown id
+    public ushort ServiceId { get; private set; }
+    public ushort MsgSeq { get; private set; }
+    public long StageId { get; private set; }
+    public ushort ErrorCode { get; private set; }
+
+    public ReadOnlyMemory<byte> Data => _message != null ? _message.ToByteArray() : _data;
+    public ReadOnlySpan<byte> DataSpan => Data.Span;
+
+    internal int BodySize => _message?.CalculateSize() ?? _data.Length;
+
+    public void Dispose()
+    {
+        if (_rented != null)
+        {
+            ArrayPool<byte>.Shared.Return(_rented);
+            _rented = null;
+        }
+
+        _data = ReadOnlyMemory<byte>.Empty;
+        _message = null;
+
+        if (_pooled && Pool.Count < MaxPoolSize)
+        {
+            _pooled = false;
+            Pool.Enqueue(this);
+        }
+    }
+
+    public T Parse<T>(MessageParser<T> parser) where T : IMessage<T>
+    {
+        return parser.ParseFrom(DataSpan);
+    }
+
+    internal void WriteBody(Span<byte> destination, int bodySize)
+    {
+        if (_message != null)
+        {
+            _message.WriteTo(destination[..bodySize]);
+        }
+        else
+        {
+            _data.Span.CopyTo(destination);
+        }
+    }
+
+    internal static Packet Received(string msgId, int msgNum, ushort serviceId, ushort msgSeq, long stageId,
+        ushort errorCode, ReadOnlySpan<byte> body)
+    {
+        if (!Pool.TryDequeue(out var packet))
+        {
+            packet = new Packet();
+        }
+
+        packet._pooled = true;
+        packet.MsgId = msgId;
+        packet.MsgNum = msgNum;
+        packet.ServiceId = serviceId;
+        packet.MsgSeq = msgSeq;
+        packet.StageId = stageId;
+        packet.ErrorCode = errorCode;
+
+        if (body.Length > 0)
+        {
+            packet._rented = ArrayPool<byte>.Shared.Rent(body.Length);
+            body.CopyTo(packet._rented);
+            packet._data = packet._rented.AsMemory(0, body.Length);
+        }
+
+        return packet;
+    }
+
+    // takes over the ArrayPool buffer holding the decompressed body without copying
+    internal static Packet Received(string msgId, int msgNum, ushort serviceId, ushort msgSeq, long stageId,
+        ushort errorCode, byte[] rented, int length)
+    {
+        var packet = Received(msgId, msgNum, serviceId, msgSeq, stageId, errorCode, ReadOnlySpan<byte>.Empty);
+        packet._rented = rented;
+        packet._data = rented.AsMemory(0, length);
+        return packet;
+    }
+}
\ No newline at end of file
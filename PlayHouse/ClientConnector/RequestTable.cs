@@ -0,0 +1,170 @@
+﻿using System.Collections.Concurrent;
+using System.Diagnostics;
+using System.Threading.Tasks.Sources;
+
+namespace ClientConnector;
+
+/// <summary>
+///     Fixed size table that finds requests waiting for a reply by msgSeq, slot = msgSeq &amp; (capacity - 1).
+///     A slot is an IValueTaskSource so no Task is allocated per request. The slot is freed only when its result is
+///     awaited, so the result of RequestAsync must always be awaited.
+///     Timeouts are checked on a queue of deadlines in registration order (one timeout value keeps it sorted).
+/// </summary>
+internal sealed class RequestTable
+{
+    private readonly int _mask;
+    private readonly Slot[] _slots;
+    private readonly Stopwatch _stopwatch = Stopwatch.StartNew();
+    private readonly ConcurrentQueue<(int index, ushort seq, long deadline)> _timeouts = new();
+    private readonly long _timeoutMs;
+    private int _sequence;
+
+    public RequestTable(int capacity, int timeoutMs)
+    {
+        if (capacity <= 0 || (capacity & (capacity - 1)) != 0 || capacity > 1 << 15)
+        {
+            throw new ArgumentException($"capacity must be a power of 2 up to 32768 - [capacity:{capacity}]");
+        }
+
+        _mask = capacity - 1;
+        _timeoutMs = timeoutMs;
+        _slots = new Slot[capacity];
+        for (var i = 0; i < capacity; i++)
+        {
+            _slots[i] = new Slot();
+        }
+    }
+
+    // claims a free slot and returns its msgSeq
+    public ushort Reserve(out ValueTask<Packet> task)
+    {
+        for (var probe = 0; probe <= _mask; probe++)
+        {
+            var seq = (ushort)Interlocked.Increment(ref _sequence);
+            if (seq == 0)
+            {
+                continue; // 0 is not a request
+            }
+
+            var slot = _slots[seq & _mask];
+            if (!slot.TryReserve(seq))
+            {
+                continue;
+            }
+
+            if (_timeoutMs > 0)
+            {
+                _timeouts.Enqueue((seq & _mask, seq, _stopwatch.ElapsedMilliseconds + _timeoutMs));
+            }
+
+            task = new ValueTask<Packet>(slot, slot.Version);
+            return seq;
+        }
+
+        throw new ConnectorException($"too many pending requests - [capacity:{_mask + 1}]");
+    }
+
+    // rolls back a request that could not be sent
+    public void Cancel(ushort seq, Exception exception)
+    {
+        _slots[seq & _mask].TryFail(seq, exception);
+    }
+
+    public bool TryComplete(Packet packet)
+    {
+        return _slots[packet.MsgSeq & _mask].TryComplete(packet);
+    }
+
+    public void ExpireTimeouts()
+    {
+        var now = _stopwatch.ElapsedMilliseconds;
+        while (_timeouts.TryPeek(out var entry) && entry.deadline <= now)
+        {
+            _timeouts.TryDequeue(out _);
+            _slots[entry.index].TryFail(entry.seq,
+                new TimeoutException($"request is timeout - [msgSeq:{entry.seq}]"));
+        }
+    }
+
+    public void FailAll(Exception exception)
+    {
+        foreach (var slot in _slots)
+        {
+            slot.TryFail(null, exception);
+        }
+
+        _timeouts.Clear();
+    }
+
+    private sealed class Slot : IValueTaskSource<Packet>
+    {
+        private const int Free = 0;
+        private const int Pending = 1;
+        private const int Completed = 2;
+
+        private ManualResetValueTaskSourceCore<Packet> _core = new() { RunContinuationsAsynchronously = true };
+        private ushort _seq;
+        private int _state;
+
+        public short Version => _core.Version;
+
+        public Packet GetResult(short token)
+        {
+            try
+            {
+                return _core.GetResult(token);
+            }
+            finally
+            {
+                _core.Reset();
+                Volatile.Write(ref _state, Free);
+            }
+        }
+
+        public ValueTaskSourceStatus GetStatus(short token)
+        {
+            return _core.GetStatus(token);
+        }
+
+        public void OnCompleted(Action<object?> continuation, object? state, short token,
+            ValueTaskSourceOnCompletedFlags flags)
+        {
+            _core.OnCompleted(continuation, state, token, flags);
+        }
+
+        public bool TryReserve(ushort seq)
+        {
+            if (Interlocked.CompareExchange(ref _state, Pending, Free) != Free)
+            {
+                return false;
+            }
+
+            _seq = seq;
+            return true;
+        }
+
+        public bool TryComplete(Packet packet)
+        {
+            if (Volatile.Read(ref _seq) != packet.MsgSeq ||
+                Interlocked.CompareExchange(ref _state, Completed, Pending) != Pending)
+            {
+                return false; // a late reply after the timeout
+            }
+
+            _core.SetResult(packet);
+            return true;
+        }
+
+        // with a null seq, every waiting request
+        public void TryFail(ushort? seq, Exception exception)
+        {
+            if ((seq.HasValue && Volatile.Read(ref _seq) != seq.Value) ||
+                Interlocked.CompareExchange(ref _state, Completed, Pending) != Pending)
+            {
+                return;
+            }
+
+            _core.SetException(exception);
+        }
+    }
+}
\ No newline at end of file
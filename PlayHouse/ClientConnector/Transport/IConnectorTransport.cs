@@ -0,0 +1,13 @@
+﻿using System.Buffers;
+using System.IO.Pipelines;
+
+namespace ClientConnector.Transport;
+
+internal interface IConnectorTransport : IAsyncDisposable
+{
+    // byte stream received from the server, unrelated to frame boundaries
+    PipeReader Input { get; }
+
+    Task ConnectAsync(CancellationToken token);
+    ValueTask SendAsync(ReadOnlySequence<byte> data, CancellationToken token);
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+﻿using System.Buffers;
+using System.IO.Pipelines;
+using System.Net.Sockets;
+
+namespace ClientConnector.Transport;
+
+internal sealed class TcpTransport(string host, int port) : IConnectorTransport
+{
+    private readonly Socket _socket = new(SocketType.Stream, ProtocolType.Tcp)
+    {
+        NoDelay = true
+    };
+
+    private PipeReader? _input;
+
+    public PipeReader Input => _input ?? throw new InvalidOperationException("not connected");
+
+    public async Task ConnectAsync(CancellationToken token)
+    {
+        await _socket.ConnectAsync(host, port, token);
+        _input = PipeReader.Create(new NetworkStream(_socket, false),
+            new StreamPipeReaderOptions(bufferSize: 64 * 1024, leaveOpen: true));
+    }
+
+    public async ValueTask SendAsync(ReadOnlySequence<byte> data, CancellationToken token)
+    {
+        if (data.IsSingleSegment)
+        {
+            await SendAllAsync(data.First, token);
+            return;
+        }
+
+        foreach (var segment in data)
+        {
+            await SendAllAsync(segment, token);
+        }
+    }
+
+    public async ValueTask DisposeAsync()
+    {
+        if (_input != null)
+        {
+            await _input.CompleteAsync();
+        }
+
+        try
+        {
+            _socket.Shutdown(SocketShutdown.Both);
+        }
+        catch (SocketException)
+        {
+        }
+
+        _socket.Dispose();
+    }
+
+    private async ValueTask SendAllAsync(ReadOnlyMemory<byte> buffer, CancellationToken token)
+    {
+        while (buffer.Length > 0)
+        {
+            var sent = await _socket.SendAsync(buffer, SocketFlags.None, token);
+            buffer = buffer[sent..];
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+﻿using System.Buffers;
+using System.IO.Pipelines;
+using System.Net.WebSockets;
+
+namespace ClientConnector.Transport;
+
+// exchanges binary messages, received messages are appended to the pipe without boundaries
+internal sealed class WebSocketTransport(Uri uri) : IConnectorTransport
+{
+    private const int ReceiveChunkSize = 16 * 1024;
+
+    private readonly Pipe _pipe = new(new PipeOptions(useSynchronizationContext: false));
+    private readonly CancellationTokenSource _receiveCancel = new();
+    private readonly ClientWebSocket _socket = new();
+    private Task? _receiveTask;
+
+    public PipeReader Input => _pipe.Reader;
+
+    public async Task ConnectAsync(CancellationToken token)
+    {
+        _socket.Options.KeepAliveInterval = TimeSpan.Zero; // the connector sends the heartbeats
+        await _socket.ConnectAsync(uri, token);
+        _receiveTask = ReceiveLoop(_receiveCancel.Token);
+    }
+
+    public async ValueTask SendAsync(ReadOnlySequence<byte> data, CancellationToken token)
+    {
+        if (data.IsSingleSegment)
+        {
+            await _socket.SendAsync(data.First, WebSocketMessageType.Binary, true, token);
+            return;
+        }
+
+        var position = data.Start;
+        var hasNext = data.TryGet(ref position, out var segment);
+        while (hasNext)
+        {
+            var current = segment;
+            hasNext = data.TryGet(ref position, out segment);
+            await _socket.SendAsync(current, WebSocketMessageType.Binary, !hasNext, token);
+        }
+    }
+
+    public async ValueTask DisposeAsync()
+    {
+        await _receiveCancel.CancelAsync();
+        if (_socket.State == WebSocketState.Open)
+        {
+            try
+            {
+                await _socket.CloseOutputAsync(WebSocketCloseStatus.NormalClosure, null, CancellationToken.None);
+            }
+            catch (WebSocketException)
+            {
+            }
+        }
+
+        if (_receiveTask != null)
+        {
+            await _receiveTask;
+        }
+
+        _socket.Dispose();
+        _receiveCancel.Dispose();
+    }
+
+    private async Task ReceiveLoop(CancellationToken token)
+    {
+        Exception? error = null;
+        try
+        {
+            while (true)
+            {
+                var memory = _pipe.Writer.GetMemory(ReceiveChunkSize);
+                var result = await _socket.ReceiveAsync(memory, token);
+                if (result.MessageType == WebSocketMessageType.Close)
+                {
+                    break;
+                }
+
+                _pipe.Writer.Advance(result.Count);
+                var flush = await _pipe.Writer.FlushAsync(token);
+                if (flush.IsCompleted)
+                {
+                    break;
+                }
+            }
+        }
+        catch (OperationCanceledException)
+        {
+        }
+        catch (Exception e)
+        {
+            error = e;
+        }
+
+        await _pipe.Writer.CompleteAsync(error);
+    }
+}
\ No newline at end of file
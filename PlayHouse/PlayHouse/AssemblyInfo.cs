@@ -1,4 +1,5 @@
 ﻿using System.Runtime.CompilerServices;
 
 [assembly: InternalsVisibleTo("PlayHouseTests")]
+[assembly: InternalsVisibleTo("PlayHouseBenchmark")]
 [assembly: InternalsVisibleTo("DynamicProxyGenAssembly2")]
\ No newline at end of file
@@ -16,7 +16,8 @@ public class CommunicatorOption
         int nodeId,
         ushort addressServerId,
         List<string> addressServerEndpoints,
-        Func<string, IPayload, ushort, IPacket> packetProducer
+        Func<string, IPayload, ushort, IPacket> packetProducer,
+        bool useLocalTransport
     )
     {
         BindEndpoint = bindEndpoint;
@@ -26,6 +27,7 @@ public class CommunicatorOption
         AddressServerId = addressServerId;
         AddressServerEndpoints = addressServerEndpoints;
         PacketProducer = packetProducer;
+        UseLocalTransport = useLocalTransport;
     }
 
     public string BindEndpoint { get; }
@@ -36,6 +38,7 @@ public class CommunicatorOption
     public List<string> AddressServerEndpoints { get; }
 
     public Func<string, IPayload, ushort, IPacket>? PacketProducer { get; }
+    public bool UseLocalTransport { get; }
 
     public class Builder
     {
@@ -47,6 +50,7 @@ public class CommunicatorOption
         private int _port;
         private IServiceProvider? _serviceProvider;
         private bool _showQps;
+        private bool _useLocalTransport;
 
         public Builder SetIp(string ip)
         {
@@ -67,6 +71,12 @@ public class CommunicatorOption
             return this;
         }
 
+        public Builder SetUseLocalTransport(bool useLocalTransport)
+        {
+            _useLocalTransport = useLocalTransport;
+            return this;
+        }
+
         public Builder SetServiceProvider(IServiceProvider? serviceProvider)
         {
             _serviceProvider = serviceProvider;
@@ -101,7 +111,8 @@ public class CommunicatorOption
                 _nodeId,
                 _addressServerId,
                 _addressServerEndpoints,
-                _packetProducer
+                _packetProducer,
+                _useLocalTransport
             );
         }
 
@@ -153,6 +164,7 @@ internal class Communicator : ICommunicateListener
 {
     private readonly ServerAddressResolver _addressResolver;
     private readonly XClientCommunicator _clientCommunicator;
+    private readonly LocalEndpoint? _localEndpoint;
     private readonly LOG<Communicator> _log = new();
     private readonly MessageLoop _messageLoop;
     private readonly CommunicatorOption _option;
@@ -186,7 +198,8 @@ internal class Communicator : ICommunicateListener
         _serverCommunicator =
             new XServerCommunicator(PlaySocketFactory.CreatePlaySocket(new SocketConfig(), _option.BindEndpoint));
         _performanceTester = new PerformanceTester(_option.ShowQps);
-        _messageLoop = new MessageLoop(_serverCommunicator, _clientCommunicator);
+        _localEndpoint = _option.UseLocalTransport ? new LocalEndpoint(this) : null;
+        _messageLoop = new MessageLoop(_serverCommunicator, _clientCommunicator, _localEndpoint);
         _sender = new XSender(_serviceId, _clientCommunicator, _requestCache);
         _systemPanel = new XSystemPanel(_serverInfoCenter, _clientCommunicator, _option.NodeId, _option.BindEndpoint);
         _serverRetriever = new ServerInfoRetriever(option.AddressServerId, option.AddressServerEndpoints, _sender);
@@ -220,6 +233,11 @@ internal class Communicator : ICommunicateListener
 
         _messageLoop.Start();
 
+        if (_localEndpoint != null)
+        {
+            LocalTransport.Register(bindEndpoint, _localEndpoint);
+        }
+
         _clientCommunicator.Connect(bindEndpoint);
 
         _option.AddressServerEndpoints.ForEach(endpoint => { _clientCommunicator.Connect(endpoint); });
@@ -250,8 +268,15 @@ internal class Communicator : ICommunicateListener
 
         _performanceTester.Stop();
         _addressResolver.Stop();
+
+        if (_localEndpoint != null)
+        {
+            LocalTransport.Unregister(_option.BindEndpoint, _localEndpoint);
+        }
+
         _messageLoop.Stop();
         _systemDispatcher.Stop();
+        _requestCache.Stop();
 
         _log.Info(() => "============== server stop ==============");
     }
@@ -259,6 +284,7 @@ internal class Communicator : ICommunicateListener
     public void AwaitTermination()
     {
         _messageLoop.AwaitTermination();
+        _localEndpoint?.Dispose();
     }
 
     private void Dispatch(RoutePacket routePacket)
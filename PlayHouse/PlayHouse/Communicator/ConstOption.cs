@@ -4,6 +4,9 @@ public static class ConstOption
 {
     public const int ThreadSleep = 10;
 
+    // max commands or packets handled per poller event before yielding to the other sockets
+    public const int CommunicatorBatchSize = 1000;
+
     public const int SessionBufferSize = 4 * 1024;
 
     public const int MaxPacketSize = 2097152;
@@ -12,6 +15,7 @@ public static class ConstOption
     public const int LengthFieldSize = 3;
     public const int MinClientHeaderSize = 18;
     public const int MinServerHeaderSize = 20;
+    public const int MaxClientHeaderSize = MinServerHeaderSize + 256; // msgId limit
     public static int AddressResolverInitialDelayMs { get; internal set; } = 1000;
     public static int AddressResolverPeriodMs { get; internal set; } = 1000;
     public static ushort DefaultServiceId { get; internal set; } = 0;
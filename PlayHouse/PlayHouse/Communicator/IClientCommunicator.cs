@@ -1,4 +1,5 @@
-﻿using PlayHouse.Communicator.Message;
+﻿using NetMQ;
+using PlayHouse.Communicator.Message;
 
 namespace PlayHouse.Communicator;
 
@@ -6,6 +7,7 @@ internal interface IClientCommunicator
 {
     void Connect(string endpoint);
     void Send(string endpoint, RoutePacket routePacket);
+    void Attach(NetMQPoller poller);
     void Communicate();
     void Disconnect(string endpoint);
     void Stop();
@@ -1,8 +1,11 @@
-﻿namespace PlayHouse.Communicator;
+﻿using NetMQ;
+
+namespace PlayHouse.Communicator;
 
 internal interface IServerCommunicator
 {
     void Bind(ICommunicateListener listener);
+    void Attach(NetMQPoller poller);
     void Communicate();
     void Stop();
 }
\ No newline at end of file
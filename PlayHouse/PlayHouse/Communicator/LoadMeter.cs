@@ -0,0 +1,37 @@
+﻿using System.Diagnostics;
+
+namespace PlayHouse.Communicator;
+
+// converts the cpu time the process used since the previous Sample to 0~100
+internal class LoadMeter
+{
+    private readonly Process _process = Process.GetCurrentProcess();
+    private TimeSpan _lastCpu;
+    private long _lastTick;
+
+    public LoadMeter()
+    {
+        _lastCpu = _process.TotalProcessorTime;
+        _lastTick = Stopwatch.GetTimestamp();
+    }
+
+    public int Sample()
+    {
+        _process.Refresh();
+        var cpu = _process.TotalProcessorTime;
+        var tick = Stopwatch.GetTimestamp();
+
+        var elapsed = Stopwatch.GetElapsedTime(_lastTick, tick).TotalMilliseconds * Environment.ProcessorCount;
+        var used = (cpu - _lastCpu).TotalMilliseconds;
+
+        _lastCpu = cpu;
+        _lastTick = tick;
+
+        if (elapsed <= 0)
+        {
+            return 0;
+        }
+
+        return (int)Math.Clamp(used * 100 / elapsed, 0, 100);
+    }
+}
\ No newline at end of file
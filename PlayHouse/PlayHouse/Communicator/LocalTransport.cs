@@ -0,0 +1,139 @@
+﻿using System.Collections.Concurrent;
+using System.Text;
+using NetMQ;
+using PlayHouse.Communicator.Message;
+using Playhouse.Protocol;
+using PlayHouse.Service.Session.Network;
+using PlayHouse.Utils;
+
+namespace PlayHouse.Communicator;
+
+// packets to a server bound in the same process skip the socket and go straight into the receiver's queue
+// the header is copied with the same values a socket receive would give, the payload is passed on without serializing
+internal static class LocalTransport
+{
+    private static readonly ConcurrentDictionary<string, LocalEndpoint> _endpoints = new();
+
+    public static void Register(string bindEndpoint, LocalEndpoint localEndpoint)
+    {
+        _endpoints[bindEndpoint] = localEndpoint;
+    }
+
+    public static void Unregister(string bindEndpoint, LocalEndpoint localEndpoint)
+    {
+        _endpoints.TryRemove(new KeyValuePair<string, LocalEndpoint>(bindEndpoint, localEndpoint));
+    }
+
+    // from : the sender's bind endpoint, replies come back to it
+    public static bool TrySend(string from, string endpoint, RoutePacket routePacket)
+    {
+        if (!_endpoints.TryGetValue(endpoint, out var localEndpoint))
+        {
+            return false;
+        }
+
+        localEndpoint.Post(ToLocal(from, routePacket));
+        return true;
+    }
+
+    internal static RoutePacket ToLocal(string from, RoutePacket routePacket)
+    {
+        using (routePacket)
+        {
+            var routeHeader = RouteHeader.CopyOf(routePacket.RouteHeader);
+            routeHeader.From = from;
+
+            // sessions send payloads for the client as is, so they are turned into client frames like after a socket hop
+            var payload = routePacket.IsToClient()
+                ? ClientFrameOf(routePacket.ToClientPacket())
+                : routePacket.MovePayload();
+
+            return RoutePacket.OwnedOf(routeHeader, payload);
+        }
+    }
+
+    private static IPayload ClientFrameOf(ClientPacket clientPacket)
+    {
+        using (clientPacket)
+        {
+            var header = clientPacket.Header;
+            var payload = clientPacket.Payload;
+            var bodySize = payload.Length;
+
+            if (bodySize > ConstOption.MaxPacketSize)
+            {
+                throw new Exception($"body size is over : {bodySize}");
+            }
+
+            var msgNum = MsgIdRegistry.WriteNumeric(header.MsgId, header.MsgNum) ? header.MsgNum : 0;
+            var msgIdSize = msgNum != 0 ? 0 : Encoding.UTF8.GetByteCount(header.MsgId);
+            var frame = new byte[PacketFrame.HeaderSizeOf(msgIdSize, true) + bodySize];
+
+            var headerSize = PacketFrame.WriteHeader(frame, bodySize, header.ServiceId, header.MsgId, msgNum,
+                header.MsgSeq, header.StageId, header.ErrorCode);
+            payload.WriteTo(frame.AsSpan(headerSize, bodySize));
+
+            return new MemoryPayload(frame.AsMemory(0, headerSize + bodySize));
+        }
+    }
+}
+
+// taken out on the receiving server's Communicator poller, so OnReceive runs on the same thread as for socket receives
+internal class LocalEndpoint : IDisposable
+{
+    private readonly ICommunicateListener _listener;
+    private readonly LOG<LocalEndpoint> _log = new();
+    private readonly NetMQQueue<RoutePacket> _queue = new();
+
+    public LocalEndpoint(ICommunicateListener listener)
+    {
+        _listener = listener;
+        _queue.ReceiveReady += OnReceiveReady;
+    }
+
+    public void Dispose()
+    {
+        while (_queue.TryDequeue(out var routePacket, TimeSpan.Zero))
+        {
+            routePacket.Dispose();
+        }
+
+        _queue.Dispose();
+    }
+
+    public void Attach(NetMQPoller poller)
+    {
+        poller.Add(_queue);
+    }
+
+    public void Post(RoutePacket routePacket)
+    {
+        _queue.Enqueue(routePacket);
+    }
+
+    private void OnReceiveReady(object? sender, NetMQQueueEventArgs<RoutePacket> args)
+    {
+        for (var i = 0; i < ConstOption.CommunicatorBatchSize; i++)
+        {
+            if (!args.Queue.TryDequeue(out var routePacket, TimeSpan.Zero))
+            {
+                return;
+            }
+
+            try
+            {
+                if (routePacket.MsgId != UpdateServerInfoReq.Descriptor.Name &&
+                    routePacket.MsgId != UpdateServerInfoRes.Descriptor.Name)
+                {
+                    _log.Trace(() => $"recvFrom:{routePacket.RouteHeader.From} (local) - [packetInfo:{routePacket.RouteHeader}]");
+                }
+
+                _listener.OnReceive(routePacket);
+            }
+            catch (Exception e)
+            {
+                _log.Error(() => $"Error during local communication - {e.Message}");
+            }
+        }
+    }
+}
\ No newline at end of file
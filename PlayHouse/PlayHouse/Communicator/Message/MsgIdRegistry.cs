@@ -0,0 +1,125 @@
+﻿using System.Collections.Concurrent;
+using System.Text;
+using Google.Protobuf.Reflection;
+using Playhouse.Protocol;
+using PlayHouse.Service.Session.Network;
+
+namespace PlayHouse.Communicator.Message;
+
+/// <summary>
+///     msgId string <-> numeric id registry.
+///     The id is the FNV-1a hash of the msgId, so it does not depend on registration order and clients can compute it.
+///     In numeric mode only msgIds registered cluster-wide (built-in protos and MsgIdDescriptors) go on the wire as
+///     numbers. msgIds that each node registers on its own, like handler keys, are sent as strings.
+///     A receiver never throws on an unknown numeric id, it carries the id along without a name.
+/// </summary>
+internal static class MsgIdRegistry
+{
+    private static readonly ConcurrentDictionary<int, string> _names = new();
+    private static readonly ConcurrentDictionary<int, byte[]> _utf8Names = new();
+    private static readonly ConcurrentDictionary<int, bool> _sharedIds = new();
+
+    static MsgIdRegistry()
+    {
+        RegisterShared(ServerReflection.Descriptor);
+        RegisterShared(CommonReflection.Descriptor);
+        _sharedIds[Register(PacketConst.HeartBeat)] = true;
+        _sharedIds[Register(PacketConst.Debug)] = true;
+        _sharedIds[Register(PacketConst.Timeout)] = true;
+    }
+
+    public static bool NumericMode { get; private set; }
+
+    public static void Init(bool numericMode, IEnumerable<FileDescriptor>? descriptors = null)
+    {
+        if (descriptors != null)
+        {
+            foreach (var descriptor in descriptors)
+            {
+                RegisterShared(descriptor);
+            }
+        }
+
+        NumericMode = numericMode;
+    }
+
+    public static int IdOf(string msgId)
+    {
+        return PacketFrame.HashOf(msgId);
+    }
+
+    public static int IdOf(ReadOnlySpan<byte> utf8)
+    {
+        return PacketFrame.HashOf(utf8);
+    }
+
+    public static int Register(string msgId)
+    {
+        var id = IdOf(msgId);
+        if (id == 0)
+        {
+            return id;
+        }
+
+        var name = _names.GetOrAdd(id, msgId);
+        if (name != msgId)
+        {
+            throw new Exception($"msgId hash is collided - [msgId:{msgId}, registered:{name}, id:{id}]");
+        }
+
+        _utf8Names.TryAdd(id, Encoding.UTF8.GetBytes(msgId));
+
+        return id;
+    }
+
+    public static void Register(FileDescriptor descriptor)
+    {
+        foreach (var messageType in descriptor.MessageTypes)
+        {
+            Register(messageType.Name);
+        }
+    }
+
+    // descriptors registered by every node of the cluster
+    private static void RegisterShared(FileDescriptor descriptor)
+    {
+        foreach (var messageType in descriptor.MessageTypes)
+        {
+            _sharedIds[Register(messageType.Name)] = true;
+        }
+    }
+
+    public static bool IsRegistered(int id)
+    {
+        return _names.ContainsKey(id);
+    }
+
+    public static bool IsShared(int id)
+    {
+        return _sharedIds.ContainsKey(id);
+    }
+
+    // whether to send as a number, an id received without a known name is passed on as the same number
+    public static bool WriteNumeric(string msgId, int msgNum)
+    {
+        return msgNum != 0 && (msgId.Length == 0 || NumericMode && IsShared(msgNum));
+    }
+
+    // returns the registered string instance for a registered msgId, otherwise creates a new one
+    public static string Intern(ReadOnlySpan<byte> utf8)
+    {
+        var id = IdOf(utf8);
+        if (id != 0 && _utf8Names.TryGetValue(id, out var bytes) && utf8.SequenceEqual(bytes))
+        {
+            return _names[id];
+        }
+
+        return Encoding.UTF8.GetString(utf8);
+    }
+
+    // empty string for an unknown id, called on the receive path so it never throws
+    public static string NameOf(int id)
+    {
+        return id != 0 && _names.TryGetValue(id, out var name) ? name : "";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+﻿using System.Collections.Concurrent;
+
+namespace PlayHouse.Communicator.Message;
+
+/// <summary>
+///     Object pool mode for RoutePacket and RouteHeader.
+///     Pooled objects go back to the pool on Dispose, so a packet must not be touched after it is disposed.
+///     In debug mode returned objects are never reused and any later access throws, to find such misuse.
+/// </summary>
+internal static class PacketPool
+{
+    private const int LocalCapacity = 256;
+    private const int SharedCapacity = 8192;
+
+    public static bool Enabled { get; private set; }
+    public static bool DebugMode { get; private set; }
+
+    internal static ObjectPool<RoutePacket> RoutePackets { get; } =
+        new(RoutePacket.CreatePooled, LocalCapacity, SharedCapacity);
+
+    internal static ObjectPool<RouteHeader> RouteHeaders { get; } =
+        new(RouteHeader.CreatePooled, LocalCapacity, SharedCapacity);
+
+    internal static ObjectPool<AsyncBlockPacket> AsyncBlocks { get; } =
+        new(AsyncBlockPacket.CreatePooled, LocalCapacity, SharedCapacity);
+
+    public static void Init(bool enabled, bool debugMode)
+    {
+        Enabled = enabled;
+        DebugMode = debugMode;
+    }
+}
+
+/// <summary>
+///     Per thread free list with a shared overflow queue.
+///     Packets are often rented on the socket thread and returned on a stage or actor thread,
+///     the shared queue carries them back instead of growing one thread's list forever.
+/// </summary>
+internal class ObjectPool<T>(Func<T> factory, int localCapacity, int sharedCapacity) where T : class
+{
+    private readonly ThreadLocal<Stack<T>> _local = new(() => new Stack<T>(localCapacity));
+    private readonly ConcurrentQueue<T> _shared = new();
+    private int _sharedCount;
+
+    public T Rent()
+    {
+        var local = _local.Value!;
+        if (local.TryPop(out var item))
+        {
+            return item;
+        }
+
+        if (_shared.TryDequeue(out item))
+        {
+            Interlocked.Decrement(ref _sharedCount);
+            return item;
+        }
+
+        return factory();
+    }
+
+    public void Return(T item)
+    {
+        var local = _local.Value!;
+        if (local.Count < localCapacity)
+        {
+            local.Push(item);
+            return;
+        }
+
+        if (Interlocked.Increment(ref _sharedCount) <= sharedCapacity)
+        {
+            _shared.Enqueue(item);
+        }
+        else
+        {
+            Interlocked.Decrement(ref _sharedCount);
+        }
+    }
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
-﻿using Google.Protobuf;
+﻿using System.Buffers;
+using Google.Protobuf;
 using NetMQ;
 
 namespace PlayHouse.Communicator.Message;
@@ -7,6 +8,22 @@ public interface IPayload : IDisposable
 {
     public ReadOnlyMemory<byte> Data { get; }
     public ReadOnlySpan<byte> DataSpan => Data.Span;
+
+    // serialized body size, payloads that know it without building Data return it directly
+    public int Length => Data.Length;
+
+    // destination is Length bytes, payloads that are not serialized yet write into it without an intermediate buffer
+    public void WriteTo(Span<byte> destination)
+    {
+        DataSpan.CopyTo(destination);
+    }
+
+    public void WriteTo(IBufferWriter<byte> writer)
+    {
+        var length = Length;
+        WriteTo(writer.GetSpan(length)[..length]);
+        writer.Advance(length);
+    }
 }
 
 public class CopyPayload(IPayload payload) : IPayload
@@ -21,9 +38,48 @@ public class CopyPayload(IPayload payload) : IPayload
     }
 }
 
+// serialized lazily, the proto must not be changed once the payload is created
+// the first WriteTo serializes straight into the destination without keeping a copy,
+// bytes are only cached when the payload is written again (broadcast, retry) or Data is read
+// the same packet can be sent several times, so the cached buffer is not returned to a pool
 public class ProtoPayload(IMessage proto) : IPayload
 {
-    public ReadOnlyMemory<byte> Data => proto.ToByteArray();
+    private byte[]? _data;
+    private int _length = -1;
+    private bool _written;
+
+    public ReadOnlyMemory<byte> Data => _data ??= proto.ToByteArray();
+
+    public int Length
+    {
+        get
+        {
+            if (_length < 0)
+            {
+                _length = _data?.Length ?? proto.CalculateSize();
+            }
+
+            return _length;
+        }
+    }
+
+    public void WriteTo(Span<byte> destination)
+    {
+        if (_data != null)
+        {
+            _data.CopyTo(destination);
+        }
+        else if (_written)
+        {
+            _data = proto.ToByteArray();
+            _data.CopyTo(destination);
+        }
+        else
+        {
+            proto.WriteTo(destination[..Length]);
+            _written = true;
+        }
+    }
 
     public void Dispose()
     {
@@ -41,7 +97,17 @@ public class ByteStringPayload(ByteString byteString) : IPayload
     {
     }
 
-    public ReadOnlyMemory<byte> Data => byteString.ToByteArray();
+    public ReadOnlyMemory<byte> Data => byteString.Memory;
+}
+
+// shares already serialized bytes, e.g. one broadcast body for several packets
+public class MemoryPayload(ReadOnlyMemory<byte> data) : IPayload
+{
+    public ReadOnlyMemory<byte> Data { get; } = data;
+
+    public void Dispose()
+    {
+    }
 }
 
 public class EmptyPayload : IPayload
@@ -64,6 +130,23 @@ public class FramePayload(NetMQFrame frame) : IPayload
     }
 }
 
+// the first length bytes of a buffer rented from ArrayPool, returned on Dispose
+public class RentedPayload(byte[] buffer, int length) : IPayload
+{
+    private byte[]? _buffer = buffer;
+
+    public ReadOnlyMemory<byte> Data => _buffer == null ? new ReadOnlyMemory<byte>() : _buffer.AsMemory(0, length);
+
+    public void Dispose()
+    {
+        if (_buffer != null)
+        {
+            ArrayPool<byte>.Shared.Return(_buffer);
+            _buffer = null;
+        }
+    }
+}
+
 public class PooledBytePayload(PooledByteBuffer ringBuffer) : IPayload
 {
     public ReadOnlyMemory<byte> Data => ringBuffer.AsMemory();
@@ -72,4 +155,42 @@ public class PooledBytePayload(PooledByteBuffer ringBuffer) : IPayload
     {
         ringBuffer.Clear();
     }
+}
+
+// body in a NetMQ pool buffer, the socket takes the Msg over on send instead of copying it
+public class MsgPayload : IPayload
+{
+    private Msg _msg;
+
+    public MsgPayload(int size)
+    {
+        _msg = new Msg();
+        _msg.InitPool(size);
+    }
+
+    // takes over a received Msg without copying, msg is left empty
+    internal MsgPayload(ref Msg msg)
+    {
+        _msg = new Msg();
+        _msg.InitEmpty();
+        _msg.Move(ref msg);
+    }
+
+    // writable body area, filled once right after the payload is created
+    public ArraySegment<byte> Segment => new(_msg.Data!, _msg.Offset, _msg.Size);
+
+    public ReadOnlyMemory<byte> Data => _msg.IsInitialised ? new ReadOnlyMemory<byte>(_msg.Data, _msg.Offset, _msg.Size) : new();
+
+    public void Dispose()
+    {
+        if (_msg.IsInitialised)
+        {
+            _msg.Close();
+        }
+    }
+
+    internal void MoveTo(ref Msg target)
+    {
+        target.Move(ref _msg);
+    }
 }
\ No newline at end of file
@@ -9,6 +9,9 @@ namespace PlayHouse.Communicator.Message;
 
 public class Header
 {
+    private string _msgId = "";
+    private int _msgNum;
+
     public Header(ushort serviceId = 0, string msgId = "", ushort msgSeq = 0, ushort errorCode = 0, long stageId = 0)
     {
         ServiceId = serviceId;
@@ -19,27 +22,97 @@ public class Header
     }
 
     public ushort ServiceId { get; set; }
-    public string MsgId { get; set; }
+    public string MsgId
+    {
+        get => _msgId;
+        set
+        {
+            _msgId = value;
+            _msgNum = 0;
+        }
+    }
+
+    // numeric id from MsgIdRegistry, used as the dispatch table key
+    public int MsgNum
+    {
+        get
+        {
+            if (_msgNum == 0)
+            {
+                _msgNum = MsgIdRegistry.IdOf(_msgId);
+            }
+
+            return _msgNum;
+        }
+    }
+
     public ushort MsgSeq { get; set; }
     public ushort ErrorCode { get; set; }
     public long StageId { get; set; }
 
     public static Header Of(HeaderMsg headerMsg)
     {
-        return new Header((ushort)headerMsg.ServiceId, headerMsg.MsgId, (ushort)headerMsg.MsgSeq,
-            (ushort)headerMsg.ErrorCode, (byte)headerMsg.StageId);
+        var header = new Header();
+        header.Set(headerMsg);
+        return header;
     }
 
     public HeaderMsg ToMsg()
     {
-        return new HeaderMsg
+        var message = new HeaderMsg();
+        CopyTo(message);
+        return message;
+    }
+
+    internal void Set(HeaderMsg headerMsg)
+    {
+        ServiceId = (ushort)headerMsg.ServiceId;
+        if (headerMsg.MsgNum != 0)
         {
-            ServiceId = ServiceId,
-            MsgId = MsgId,
-            MsgSeq = MsgSeq,
-            ErrorCode = ErrorCode,
-            StageId = StageId
-        };
+            SetMsgId(MsgIdRegistry.NameOf(headerMsg.MsgNum), headerMsg.MsgNum);
+        }
+        else
+        {
+            MsgId = headerMsg.MsgId;
+        }
+
+        MsgSeq = (ushort)headerMsg.MsgSeq;
+        ErrorCode = (ushort)headerMsg.ErrorCode;
+        StageId = headerMsg.StageId;
+    }
+
+    internal void CopyTo(HeaderMsg message)
+    {
+        message.ServiceId = ServiceId;
+        if (MsgIdRegistry.WriteNumeric(MsgId, MsgNum))
+        {
+            message.MsgId = "";
+            message.MsgNum = MsgNum;
+        }
+        else
+        {
+            message.MsgId = MsgId;
+            message.MsgNum = 0;
+        }
+
+        message.MsgSeq = MsgSeq;
+        message.ErrorCode = ErrorCode;
+        message.StageId = StageId;
+    }
+
+    internal void SetMsgId(string msgId, int msgNum)
+    {
+        _msgId = msgId;
+        _msgNum = msgNum;
+    }
+
+    internal void Reset()
+    {
+        ServiceId = 0;
+        MsgId = "";
+        MsgSeq = 0;
+        ErrorCode = 0;
+        StageId = 0;
     }
 
     public override string ToString()
@@ -51,24 +124,34 @@ public class Header
 
 public class RouteHeader
 {
+    private readonly Header _header;
+    private bool _pooled;
+    private bool _returned;
+
     public RouteHeader(Header header)
     {
-        Header = header;
+        _header = header;
     }
 
     public RouteHeader(RouteHeaderMsg headerMsg)
         : this(Header.Of(headerMsg.HeaderMsg))
     {
-        Sid = headerMsg.Sid;
-        IsSystem = headerMsg.IsSystem;
-        IsBase = headerMsg.IsBase;
-        IsBackend = headerMsg.IsBackend;
-        IsReply = headerMsg.IsReply;
-        AccountId = headerMsg.AccountId;
-        StageId = headerMsg.StageId;
+        Set(headerMsg);
+    }
+
+    public Header Header
+    {
+        get
+        {
+            if (_returned)
+            {
+                throw new InvalidOperationException($"RouteHeader is used after returned to the pool - [msgId:{_header.MsgId}]");
+            }
+
+            return _header;
+        }
     }
 
-    public Header Header { get; }
     public long Sid { get; set; }
     public bool IsSystem { get; set; }
     public bool IsBase { get; set; }
@@ -77,6 +160,9 @@ public class RouteHeader
     public long AccountId { get; set; }
     public long StageId { get; set; }
 
+    // sids a broadcast goes to, the session server sends it to each sid
+    public long[]? Sids { get; set; }
+
     public string From { get; set; } = "";
 
     public bool IsToClient { get; set; }
@@ -90,8 +176,15 @@ public class RouteHeader
 
     public RouteHeaderMsg ToMsg()
     {
-        var message = new RouteHeaderMsg();
-        message.HeaderMsg = Header.ToMsg();
+        var message = new RouteHeaderMsg { HeaderMsg = new HeaderMsg() };
+        CopyTo(message);
+        return message;
+    }
+
+    // fills a reusable message, HeaderMsg has to be set already
+    internal void CopyTo(RouteHeaderMsg message)
+    {
+        Header.CopyTo(message.HeaderMsg);
         message.Sid = Sid;
         message.IsSystem = IsSystem;
         message.IsBase = IsBase;
@@ -99,7 +192,23 @@ public class RouteHeader
         message.IsReply = IsReply;
         message.AccountId = AccountId;
         message.StageId = StageId;
-        return message;
+        message.Sids.Clear();
+        if (Sids != null)
+        {
+            message.Sids.AddRange(Sids);
+        }
+    }
+
+    private void Set(RouteHeaderMsg headerMsg)
+    {
+        Sid = headerMsg.Sid;
+        IsSystem = headerMsg.IsSystem;
+        IsBase = headerMsg.IsBase;
+        IsBackend = headerMsg.IsBackend;
+        IsReply = headerMsg.IsReply;
+        AccountId = headerMsg.AccountId;
+        StageId = headerMsg.StageId;
+        Sids = headerMsg.Sids.Count > 0 ? headerMsg.Sids.ToArray() : null;
     }
 
     public static RouteHeader Of(HeaderMsg header)
@@ -112,6 +221,87 @@ public class RouteHeader
         return new RouteHeader(header);
     }
 
+    internal static RouteHeader Of(RouteHeaderMsg headerMsg)
+    {
+        var routeHeader = Create();
+        routeHeader._header.Set(headerMsg.HeaderMsg);
+        routeHeader.Set(headerMsg);
+        return routeHeader;
+    }
+
+    // rented from the pool in pool mode, the packet built on it owns it and gives it back on Dispose
+    internal static RouteHeader Create(string msgId = "")
+    {
+        if (!PacketPool.Enabled)
+        {
+            return new RouteHeader(new Header(msgId: msgId));
+        }
+
+        var routeHeader = PacketPool.RouteHeaders.Rent();
+        routeHeader._header.MsgId = msgId;
+        return routeHeader;
+    }
+
+    // keeps the msgId and its cached id of the source packet
+    internal static RouteHeader Create(Header source)
+    {
+        var routeHeader = Create();
+        routeHeader._header.SetMsgId(source.MsgId, source.MsgNum);
+        return routeHeader;
+    }
+
+    // copies only what a socket round trip would carry, From and IsToClient are set by the receiver
+    internal static RouteHeader CopyOf(RouteHeader source)
+    {
+        var routeHeader = Create(source.Header);
+        var header = routeHeader._header;
+        header.ServiceId = source.Header.ServiceId;
+        header.MsgSeq = source.Header.MsgSeq;
+        header.ErrorCode = source.Header.ErrorCode;
+        header.StageId = source.Header.StageId;
+        routeHeader.Sid = source.Sid;
+        routeHeader.IsSystem = source.IsSystem;
+        routeHeader.IsBase = source.IsBase;
+        routeHeader.IsBackend = source.IsBackend;
+        routeHeader.IsReply = source.IsReply;
+        routeHeader.AccountId = source.AccountId;
+        routeHeader.StageId = source.StageId;
+        routeHeader.Sids = source.Sids;
+        return routeHeader;
+    }
+
+    internal static RouteHeader CreatePooled()
+    {
+        return new RouteHeader(new Header()) { _pooled = true };
+    }
+
+    internal void Return()
+    {
+        if (!_pooled || _returned)
+        {
+            return;
+        }
+
+        if (PacketPool.DebugMode)
+        {
+            _returned = true;
+            return;
+        }
+
+        _header.Reset();
+        Sid = 0;
+        IsSystem = false;
+        IsBase = false;
+        IsBackend = false;
+        IsReply = false;
+        AccountId = 0;
+        StageId = 0;
+        Sids = null;
+        From = "";
+        IsToClient = false;
+        PacketPool.RouteHeaders.Return(this);
+    }
+
     public static RouteHeader TimerOf(long stageId, string msgId)
     {
         return new RouteHeader(new Header(msgId: msgId))
@@ -129,15 +319,39 @@ public class RouteHeader
 
 internal class RoutePacket : IBasePacket
 {
-    public RouteHeader RouteHeader;
+    private bool _disposed;
+    private bool _ownsHeader;
+
+    // MoveOf does not create a new packet, it only adds an owner, the packet is cleaned up when the last owner disposes it
+    private int _owners = 1;
+    private IPayload _payload;
+    private readonly bool _pooled;
+    private RouteHeader _routeHeader;
     public TimerCallbackTask? TimerCallback;
 
     public long TimerId;
 
-    protected RoutePacket(RouteHeader routeHeader, IPayload payload)
+    // timers of the same stage that were due on the same tick, set instead of TimerId/TimerCallback
+    public StageTimerFire[]? StageTimers;
+
+    // when the packet entered a mailbox (Stopwatch timestamp), recorded only while metrics are listened to
+    public long PostedAt;
+
+    protected RoutePacket(RouteHeader routeHeader, IPayload payload, bool pooled = false)
+    {
+        _routeHeader = routeHeader;
+        _payload = payload;
+        _pooled = pooled;
+    }
+
+    public RouteHeader RouteHeader
     {
-        RouteHeader = routeHeader;
-        Payload = payload;
+        get
+        {
+            CheckAlive();
+            return _routeHeader;
+        }
+        set => _routeHeader = value;
     }
 
 
@@ -153,7 +367,15 @@ internal class RoutePacket : IBasePacket
 
     public bool IsSystem => RouteHeader.IsSystem;
 
-    public IPayload Payload { get; private set; }
+    public IPayload Payload
+    {
+        get
+        {
+            CheckAlive();
+            return _payload;
+        }
+        private set => _payload = value;
+    }
 
     public object? TimerObject { get; }
     public ushort MsgSeq => Header.MsgSeq;
@@ -191,12 +413,98 @@ internal class RoutePacket : IBasePacket
         return temp;
     }
 
-    public ReadOnlyMemory<byte> Data => Payload.Data;
-    public ReadOnlySpan<byte> Span => Payload.DataSpan;
+    public ReadOnlyMemory<byte> Data
+    {
+        get
+        {
+            CheckAlive();
+            return _payload.Data;
+        }
+    }
+
+    public ReadOnlySpan<byte> Span
+    {
+        get
+        {
+            CheckAlive();
+            return _payload.DataSpan;
+        }
+    }
 
     public void Dispose()
     {
-        Payload.Dispose();
+        if (_disposed || Interlocked.Decrement(ref _owners) > 0)
+        {
+            return;
+        }
+
+        _disposed = true;
+        _payload.Dispose();
+
+        if (_ownsHeader)
+        {
+            _routeHeader.Return();
+        }
+
+        if (!_pooled || PacketPool.DebugMode)
+        {
+            return;
+        }
+
+        _routeHeader = null!;
+        _payload = null!;
+        _ownsHeader = false;
+        TimerCallback = null;
+        TimerId = 0;
+        StageTimers = null;
+        PostedAt = 0;
+        ReturnToPool();
+    }
+
+    private protected virtual void ReturnToPool()
+    {
+        PacketPool.RoutePackets.Return(this);
+    }
+
+    // in debug mode a packet outside the pool also throws when used after Dispose, so misuse shows up right away
+    private void CheckAlive()
+    {
+        if (_disposed && PacketPool.DebugMode)
+        {
+            throw new InvalidOperationException("RoutePacket is used after it is disposed");
+        }
+    }
+
+    internal static RoutePacket CreatePooled()
+    {
+        return new RoutePacket(null!, null!, true);
+    }
+
+    // reinitializes a packet taken from the pool
+    private protected void Reuse(RouteHeader routeHeader, IPayload payload, bool ownsHeader)
+    {
+        _routeHeader = routeHeader;
+        _payload = payload;
+        _ownsHeader = ownsHeader;
+        _owners = 1;
+        _disposed = false;
+    }
+
+    // ownsHeader : the header was made for this packet, so it goes back to the pool together with the packet
+    private static RoutePacket Create(RouteHeader routeHeader, IPayload payload, bool ownsHeader = true)
+    {
+        var routePacket = PacketPool.Enabled ? PacketPool.RoutePackets.Rent() : new RoutePacket(null!, null!);
+        routePacket.Reuse(routeHeader, payload, ownsHeader);
+        return routePacket;
+    }
+
+    // the same packet gets one more owner, so sub classes keep their state and no new shell is rented
+    // the source owner still disposes it, the packet is cleaned up when the last owner does
+    private RoutePacket Move()
+    {
+        CheckAlive();
+        Interlocked.Increment(ref _owners);
+        return this;
     }
 
     public ushort ServiceId()
@@ -246,73 +554,73 @@ internal class RoutePacket : IBasePacket
 
     public static RoutePacket Of(ushort errorCode)
     {
-        return new RoutePacket(new RouteHeader(new Header { ErrorCode = errorCode }), new EmptyPayload());
+        var routeHeader = RouteHeader.Create();
+        routeHeader.Header.ErrorCode = errorCode;
+        return Create(routeHeader, new EmptyPayload());
     }
 
     public static RoutePacket MoveOf(RoutePacket routePacket)
     {
-        var movePacket = Of(routePacket.RouteHeader, routePacket.MovePayload());
-        movePacket.TimerId = routePacket.TimerId;
-        movePacket.TimerCallback = routePacket.TimerCallback;
-        return movePacket;
+        return routePacket.Move();
     }
 
 
     public static RoutePacket Of(RouteHeader routeHeader, IPayload payload)
     {
-        return new RoutePacket(routeHeader, payload);
+        return Create(routeHeader, payload, false);
+    }
+
+    // the packet takes over the header, e.g. a header that was just decoded from the socket
+    internal static RoutePacket OwnedOf(RouteHeader routeHeader, IPayload payload)
+    {
+        return Create(routeHeader, payload);
     }
 
     internal static RoutePacket Of(string msgId, IPayload payload)
     {
-        return new RoutePacket(new RouteHeader(new Header { MsgId = msgId }), payload);
+        return Create(RouteHeader.Create(msgId), payload);
     }
 
     internal static RoutePacket Of(IMessage message)
     {
-        return new RoutePacket(new RouteHeader(new Header { MsgId = message.Descriptor.Name }),
-            new ProtoPayload(message));
+        return Create(RouteHeader.Create(message.Descriptor.Name), new ProtoPayload(message));
     }
 
     internal static RoutePacket Of(IPacket packet)
     {
-        return new RoutePacket(new RouteHeader(new Header { MsgId = packet.MsgId }), packet.Payload);
+        return Create(RouteHeader.Create(packet.MsgId), packet.Payload);
     }
 
     public static RoutePacket SystemOf(RoutePacket packet, bool isBase)
     {
-        var header = new Header(msgId: packet.MsgId);
-        var routeHeader = RouteHeader.Of(header);
+        var routeHeader = RouteHeader.Create(packet.Header);
         routeHeader.IsSystem = true;
         routeHeader.IsBase = isBase;
-        return new RoutePacket(routeHeader, packet.MovePayload());
+        return Create(routeHeader, packet.MovePayload());
     }
 
     public static RoutePacket ApiOf(RoutePacket packet, bool isBase, bool isBackend)
     {
-        var header = new Header(msgId: packet.MsgId);
-        var routeHeader = RouteHeader.Of(header);
+        var routeHeader = RouteHeader.Create(packet.Header);
         routeHeader.IsBase = isBase;
         routeHeader.IsBackend = isBackend;
-        return new RoutePacket(routeHeader, packet.MovePayload());
+        return Create(routeHeader, packet.MovePayload());
     }
 
     public static RoutePacket SessionOf(long sid, RoutePacket packet, bool isBase, bool isBackend)
     {
-        var header = new Header(msgId: packet.MsgId);
-        var routeHeader = RouteHeader.Of(header);
+        var routeHeader = RouteHeader.Create(packet.Header);
         routeHeader.Sid = sid;
         routeHeader.IsBase = isBase;
         routeHeader.IsBackend = isBackend;
 
-        return new RoutePacket(routeHeader, packet.MovePayload());
+        return Create(routeHeader, packet.MovePayload());
     }
 
     public static RoutePacket AddTimerOf(TimerMsg.Types.Type type, long stageId, long timerId,
         TimerCallbackTask timerCallback, TimeSpan initialDelay, TimeSpan period, int count = 0)
     {
-        var header = new Header(msgId: TimerMsg.Descriptor.Name);
-        var routeHeader = RouteHeader.Of(header);
+        var routeHeader = RouteHeader.Create(TimerMsg.Descriptor.Name);
         routeHeader.StageId = stageId;
         routeHeader.IsBase = true;
 
@@ -324,36 +632,44 @@ internal class RoutePacket : IBasePacket
             Period = (long)period.TotalMilliseconds
         };
 
-        return new RoutePacket(routeHeader, new ProtoPayload(message))
-        {
-            TimerCallback = timerCallback,
-            TimerId = timerId
-        };
+        var routePacket = Create(routeHeader, new ProtoPayload(message));
+        routePacket.TimerCallback = timerCallback;
+        routePacket.TimerId = timerId;
+        return routePacket;
     }
 
     public static RoutePacket StageTimerOf(long stageId, long timerId, TimerCallbackTask timerCallback,
         object? timerState)
     {
-        var header = new Header(msgId: StageTimer.Descriptor.Name);
-        var routeHeader = RouteHeader.Of(header);
+        var routeHeader = RouteHeader.Create(StageTimer.Descriptor.Name);
+        routeHeader.StageId = stageId;
+        routeHeader.IsBase = true;
 
-        return new RoutePacket(routeHeader, new EmptyPayload())
-        {
-            RouteHeader = { StageId = stageId, IsBase = true },
-            TimerId = timerId,
-            TimerCallback = timerCallback
-        };
+        var routePacket = Create(routeHeader, new EmptyPayload());
+        routePacket.TimerId = timerId;
+        routePacket.TimerCallback = timerCallback;
+        return routePacket;
+    }
+
+    public static RoutePacket StageTimerOf(long stageId, StageTimerFire[] stageTimers)
+    {
+        var routeHeader = RouteHeader.Create(StageTimer.Descriptor.Name);
+        routeHeader.StageId = stageId;
+        routeHeader.IsBase = true;
+
+        var routePacket = Create(routeHeader, new EmptyPayload());
+        routePacket.StageTimers = stageTimers;
+        return routePacket;
     }
 
     public static RoutePacket StageOf(long stageId, long accountId, RoutePacket packet, bool isBase, bool isBackend)
     {
-        var header = new Header(msgId: packet.MsgId);
-        var routeHeader = RouteHeader.Of(header);
+        var routeHeader = RouteHeader.Create(packet.Header);
         routeHeader.StageId = stageId;
         routeHeader.AccountId = accountId;
         routeHeader.IsBase = isBase;
         routeHeader.IsBackend = isBackend;
-        return new RoutePacket(routeHeader, packet.MovePayload());
+        return Create(routeHeader, packet.MovePayload());
     }
 
     //public static RoutePacket ReplyOf(ushort serviceId, ushort msgSeq, int sid,bool forClient, ReplyPacket reply)
@@ -375,13 +691,9 @@ internal class RoutePacket : IBasePacket
     //}
     public static RoutePacket ReplyOf(ushort serviceId, RouteHeader sourceHeader, ushort errorCode, IPacket? reply)
     {
-        Header header = new(msgId: reply != null ? reply.MsgId : "")
-        {
-            ServiceId = serviceId,
-            MsgSeq = sourceHeader.Header.MsgSeq
-        };
-
-        var routeHeader = RouteHeader.Of(header);
+        var routeHeader = RouteHeader.Create(reply != null ? reply.MsgId : "");
+        routeHeader.Header.ServiceId = serviceId;
+        routeHeader.Header.MsgSeq = sourceHeader.Header.MsgSeq;
         routeHeader.IsReply = true;
         routeHeader.IsToClient = !sourceHeader.IsBackend;
         routeHeader.Sid = sourceHeader.Sid;
@@ -390,25 +702,50 @@ internal class RoutePacket : IBasePacket
         routeHeader.AccountId = sourceHeader.AccountId;
 
         var routePacket = reply != null
-            ? new RoutePacket(routeHeader, reply.Payload)
-            : new RoutePacket(routeHeader, new EmptyPayload());
+            ? Create(routeHeader, reply.Payload)
+            : Create(routeHeader, new EmptyPayload());
         routePacket.RouteHeader.Header.ErrorCode = errorCode;
         return routePacket;
     }
 
     public static RoutePacket ClientOf(ushort serviceId, long sid, IPacket packet, long stageId = 0)
     {
-        Header header = new(msgId: packet.MsgId)
-        {
-            ServiceId = serviceId
-        };
-
-        var routeHeader = RouteHeader.Of(header);
+        var routeHeader = RouteHeader.Create(packet.MsgId);
+        routeHeader.Header.ServiceId = serviceId;
         routeHeader.Sid = sid;
         routeHeader.IsToClient = true;
         routeHeader.StageId = stageId;
 
-        return new RoutePacket(routeHeader, packet.Payload);
+        return Create(routeHeader, packet.Payload);
+    }
+
+    // one packet for several sessions of the same session server, the payload is shared by all of them
+    public static RoutePacket ClientOf(ushort serviceId, long[] sids, IPacket packet, IPayload payload, long stageId)
+    {
+        var routeHeader = RouteHeader.Create(packet.MsgId);
+        routeHeader.Header.ServiceId = serviceId;
+        routeHeader.Sids = sids;
+        routeHeader.IsToClient = true;
+        routeHeader.StageId = stageId;
+
+        return Create(routeHeader, payload);
+    }
+
+    // a copy of a broadcast packet for one of its sessions
+    internal static RoutePacket FanOutOf(RoutePacket broadcast, long sid, IPayload payload)
+    {
+        var routeHeader = RouteHeader.Create(broadcast.Header);
+        var header = routeHeader.Header;
+        header.ServiceId = broadcast.Header.ServiceId;
+        header.MsgSeq = broadcast.Header.MsgSeq;
+        header.ErrorCode = broadcast.Header.ErrorCode;
+        header.StageId = broadcast.Header.StageId;
+        routeHeader.Sid = sid;
+        routeHeader.StageId = broadcast.StageId;
+        routeHeader.AccountId = broadcast.AccountId;
+        routeHeader.From = broadcast.RouteHeader.From;
+
+        return Create(routeHeader, payload);
     }
 
     public void WriteClientPacketBytes(PooledByteBuffer buffer)
@@ -420,29 +757,42 @@ internal class RoutePacket : IBasePacket
 
     public static void WriteClientPacketBytes(ClientPacket clientPacket, PooledByteBuffer buffer)
     {
+        var payload = clientPacket.Payload;
+        WriteClientHeaderBytes(clientPacket, payload.Length, buffer);
+        buffer.Write(payload.DataSpan);
+    }
 
+    // writes the client frame header only, the body of bodySize bytes has to follow right after it
+    internal static void WriteClientHeaderBytes(ClientPacket clientPacket, int bodySize, PooledByteBuffer buffer)
+    {
         int msgIdLength = clientPacket.MsgId.Length;
         if (msgIdLength > PacketConst.MsgIdLimit)
         {
             throw new Exception($"MsgId size is over : {msgIdLength}");
         }
 
-        var body = clientPacket.Payload.Data;
-        var bodySize = body.Length;
         if (bodySize > ConstOption.MaxPacketSize)
         {
             throw new Exception($"body size is over : {bodySize}");
         }
-        
 
         buffer.WriteInt32(bodySize);
         buffer.WriteInt16(clientPacket.ServiceId);
         //buffer.Write((byte)msgIdLength);
-        buffer.Write(clientPacket.MsgId);
+        if (MsgIdRegistry.WriteNumeric(clientPacket.MsgId, clientPacket.Header.MsgNum))
+        {
+            // msgId size 0 + 4byte id
+            buffer.Write((byte)0);
+            buffer.WriteInt32(clientPacket.Header.MsgNum);
+        }
+        else
+        {
+            buffer.Write(clientPacket.MsgId);
+        }
+
         buffer.WriteInt16(clientPacket.MsgSeq);
         buffer.WriteInt64(clientPacket.Header.StageId);
         buffer.WriteInt16(clientPacket.Header.ErrorCode);
-        buffer.Write(clientPacket.Payload.DataSpan);
     }
 
     //public  ReplyPacket ToReplyPacket()
@@ -458,23 +808,35 @@ internal class RoutePacket : IBasePacket
 
 internal class AsyncBlockPacket : RoutePacket
 {
-    private AsyncBlockPacket(AsyncPostCallback asyncPostCallback, object result, RouteHeader routeHeader) : base(
-        routeHeader, new EmptyPayload())
+    private AsyncBlockPacket(bool pooled) : base(null!, null!, pooled)
+    {
+    }
+
+    public AsyncPostCallback AsyncPostCallback { get; private set; } = null!;
+    public object Result { get; private set; } = null!;
+
+    internal static AsyncBlockPacket CreatePooled()
     {
-        AsyncPostCallback = asyncPostCallback;
-        Result = result;
+        return new AsyncBlockPacket(true);
     }
 
-    public AsyncPostCallback AsyncPostCallback { get; }
-    public object Result { get; }
+    private protected override void ReturnToPool()
+    {
+        AsyncPostCallback = null!;
+        Result = null!;
+        PacketPool.AsyncBlocks.Return(this);
+    }
 
     public static RoutePacket Of(long stageId, AsyncPostCallback asyncPostCallback, object result)
     {
-        var header = new Header(msgId: AsyncBlock.Descriptor.Name);
-        var routeHeader = RouteHeader.Of(header);
-        var packet = new AsyncBlockPacket(asyncPostCallback, result, routeHeader);
-        packet.RouteHeader.StageId = stageId;
-        packet.RouteHeader.IsBase = true;
+        var routeHeader = RouteHeader.Create(AsyncBlock.Descriptor.Name);
+        routeHeader.StageId = stageId;
+        routeHeader.IsBase = true;
+
+        var packet = PacketPool.Enabled ? PacketPool.AsyncBlocks.Rent() : new AsyncBlockPacket(false);
+        packet.Reuse(routeHeader, new EmptyPayload(), true);
+        packet.AsyncPostCallback = asyncPostCallback;
+        packet.Result = result;
         return packet;
     }
 }
\ No newline at end of file
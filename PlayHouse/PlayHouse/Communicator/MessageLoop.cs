@@ -1,54 +1,53 @@
-﻿using PlayHouse.Utils;
+﻿using NetMQ;
+using PlayHouse.Utils;
 
 namespace PlayHouse.Communicator;
 
+// One poller thread drives both the receive socket and the send queue, so a packet is handled
+// as soon as it arrives or is enqueued instead of waiting for the next sleep interval.
 internal class MessageLoop
 {
     private readonly IClientCommunicator _client;
-    private readonly Thread _clientThread;
+    private readonly LocalEndpoint? _local;
     private readonly LOG<MessageLoop> _log = new();
+    private readonly NetMQPoller _poller = new();
     private readonly IServerCommunicator _server;
-    private readonly Thread _serverThread;
+    private readonly Thread _thread;
 
-    public MessageLoop(IServerCommunicator server, IClientCommunicator client)
+    public MessageLoop(IServerCommunicator server, IClientCommunicator client, LocalEndpoint? local = null)
     {
         _server = server;
         _client = client;
+        _local = local;
 
-        _serverThread = new Thread(() =>
+        _thread = new Thread(() =>
         {
-            _log.Info(() => "start Server Communicator");
-            _server.Communicate();
+            _log.Info(() => "start Communicator");
+            _poller.Run();
         })
         {
-            Name = "server:Communicator"
-        };
-
-        _clientThread = new Thread(() =>
-        {
-            _log.Info(() => "start client Communicator");
-            _client.Communicate();
-        })
-        {
-            Name = "client:Communicator"
+            Name = "Communicator"
         };
     }
 
     public void Start()
     {
-        _serverThread.Start();
-        _clientThread.Start();
+        _server.Attach(_poller);
+        _client.Attach(_poller);
+        _local?.Attach(_poller);
+        _thread.Start();
     }
 
     public void Stop()
     {
-        _server.Stop();
-        _client.Stop();
+        if (_poller.IsRunning)
+        {
+            _poller.StopAsync();
+        }
     }
 
     public void AwaitTermination()
     {
-        _clientThread.Join();
-        _serverThread.Join();
+        _thread.Join();
     }
 }
\ No newline at end of file
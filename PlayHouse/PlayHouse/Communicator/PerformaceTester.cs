@@ -21,6 +21,8 @@ internal class PerformanceTester
 
     public void IncCounter()
     {
+        PlayMetrics.ReceivedPackets.Add(1, new KeyValuePair<string, object?>("from", _from));
+
         if (_showQps)
         {
             Interlocked.Increment(ref _counter);
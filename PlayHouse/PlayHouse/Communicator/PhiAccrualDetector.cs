@@ -0,0 +1,67 @@
+﻿namespace PlayHouse.Communicator;
+
+// computes how unusual the current silence is (phi) from the distribution of heartbeat intervals
+// phi 1 is about a 10% chance of a false suspicion, 8 about 1e-8, a lower threshold detects faster with more false suspicions
+internal class PhiAccrualDetector(
+    long expectedIntervalMs,
+    long acceptablePauseMs,
+    int maxSamples = 100,
+    double minStdDevMs = 100)
+{
+    private readonly Queue<long> _intervals = new();
+    private long _lastHeartbeat = -1;
+    private double _sum;
+    private double _squaredSum;
+
+    public void Heartbeat(long nowMs)
+    {
+        if (_lastHeartbeat < 0)
+        {
+            // the first heartbeat has no interval, so the distribution starts from the expected period
+            AddInterval(expectedIntervalMs);
+            AddInterval(expectedIntervalMs + expectedIntervalMs / 4);
+        }
+        else
+        {
+            AddInterval(nowMs - _lastHeartbeat);
+        }
+
+        _lastHeartbeat = nowMs;
+    }
+
+    public double Phi(long nowMs)
+    {
+        if (_lastHeartbeat < 0)
+        {
+            return 0;
+        }
+
+        var mean = _sum / _intervals.Count + acceptablePauseMs;
+        var variance = _squaredSum / _intervals.Count - Math.Pow(_sum / _intervals.Count, 2);
+        var stdDev = Math.Max(Math.Sqrt(Math.Max(variance, 0)), minStdDevMs);
+
+        // logistic approximation of the normal cumulative distribution
+        var y = (nowMs - _lastHeartbeat - mean) / stdDev;
+        var e = Math.Exp(-y * (1.5976 + 0.070566 * y * y));
+        return nowMs - _lastHeartbeat > mean ? -Math.Log10(e / (1.0 + e)) : -Math.Log10(1.0 - 1.0 / (1.0 + e));
+    }
+
+    public bool IsAvailable(long nowMs, double threshold)
+    {
+        return Phi(nowMs) < threshold;
+    }
+
+    private void AddInterval(long interval)
+    {
+        if (_intervals.Count >= maxSamples)
+        {
+            var dropped = _intervals.Dequeue();
+            _sum -= dropped;
+            _squaredSum -= (double)dropped * dropped;
+        }
+
+        _intervals.Enqueue(interval);
+        _sum += interval;
+        _squaredSum += (double)interval * interval;
+    }
+}
\ No newline at end of file
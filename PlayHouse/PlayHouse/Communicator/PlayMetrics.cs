@@ -0,0 +1,124 @@
+﻿using System.Diagnostics;
+using System.Diagnostics.Metrics;
+using PlayHouse.Communicator.Message;
+
+namespace PlayHouse.Communicator;
+
+// instruments exposed through System.Diagnostics.Metrics, subscribe by MeterName (dotnet-counters, OpenTelemetry)
+// without a listener Enabled is false and nothing is timed
+// latency distributions get HDR-like resolution with the exporter's exponential histogram
+public static class PlayMetrics
+{
+    public const string MeterName = "PlayHouse";
+
+    private static readonly Meter Meter = new(MeterName);
+    private static readonly List<(string name, string kind, Func<long> value)> Sources = new();
+
+    internal static readonly Counter<long> ReceivedPackets =
+        Meter.CreateCounter<long>("playhouse.packets.received", null, "received packets");
+
+    internal static readonly Histogram<double> RequestDuration =
+        Meter.CreateHistogram<double>("playhouse.request.duration", "ms", "time from request to reply");
+
+    internal static readonly Counter<long> RequestTimeouts =
+        Meter.CreateCounter<long>("playhouse.request.timeouts", null, "timed out requests");
+
+    internal static readonly Histogram<double> MailboxWait =
+        Meter.CreateHistogram<double>("playhouse.mailbox.wait", "ms", "time spent waiting in an actor mailbox");
+
+    internal static readonly Histogram<double> HandlerDuration =
+        Meter.CreateHistogram<double>("playhouse.handler.duration", "ms", "handler run time per msgId");
+
+    internal static readonly Histogram<double> FrameDuration =
+        Meter.CreateHistogram<double>("playhouse.stage.frame.duration", "ms", "run time of one game loop frame");
+
+    internal static readonly Counter<long> FrameOverruns =
+        Meter.CreateCounter<long>("playhouse.stage.frame.overruns", null, "game loop frames skipped because they could not run on time");
+
+    static PlayMetrics()
+    {
+        Meter.CreateObservableGauge("playhouse.mailbox.depth", () => Observe("mailbox"), null,
+            "packets queued in actor mailboxes");
+        Meter.CreateObservableGauge("playhouse.send.queue", () => Observe("send"), null,
+            "packets waiting to be sent to the backbone");
+    }
+
+    // several servers in one process are summed per kind
+    // dispose the returned value on Stop so a stopped server's values are dropped
+    internal static IDisposable ObserveMailbox(string actor, Func<long> depth)
+    {
+        return AddSource(("mailbox", actor, depth));
+    }
+
+    internal static IDisposable ObserveSendQueue(Func<long> depth)
+    {
+        return AddSource(("send", string.Empty, depth));
+    }
+
+    private static IDisposable AddSource((string name, string kind, Func<long> value) source)
+    {
+        lock (Sources)
+        {
+            Sources.Add(source);
+        }
+
+        return new SourceRegistration(source);
+    }
+
+    internal static long StartTimestamp(Histogram<double> histogram)
+    {
+        return histogram.Enabled ? Stopwatch.GetTimestamp() : 0;
+    }
+
+    internal static void RecordElapsed(Histogram<double> histogram, long startTimestamp,
+        KeyValuePair<string, object?> tag)
+    {
+        if (startTimestamp != 0)
+        {
+            histogram.Record(Stopwatch.GetElapsedTime(startTimestamp).TotalMilliseconds, tag);
+        }
+    }
+
+    internal static void OnPosted(RoutePacket routePacket)
+    {
+        routePacket.PostedAt = StartTimestamp(MailboxWait);
+    }
+
+    internal static void OnDequeued(RoutePacket routePacket, string actor)
+    {
+        RecordElapsed(MailboxWait, routePacket.PostedAt, new KeyValuePair<string, object?>("actor", actor));
+    }
+
+    internal static void RecordHandler(long startTimestamp, string actor, string msgId)
+    {
+        if (startTimestamp != 0)
+        {
+            HandlerDuration.Record(Stopwatch.GetElapsedTime(startTimestamp).TotalMilliseconds,
+                new KeyValuePair<string, object?>("actor", actor), new KeyValuePair<string, object?>("msg_id", msgId));
+        }
+    }
+
+    private static IEnumerable<Measurement<long>> Observe(string name)
+    {
+        lock (Sources)
+        {
+            return Sources.Where(s => s.name == name)
+                .GroupBy(s => s.kind)
+                .Select(g => g.Key == string.Empty
+                    ? new Measurement<long>(g.Sum(s => s.value()))
+                    : new Measurement<long>(g.Sum(s => s.value()), new KeyValuePair<string, object?>("actor", g.Key)))
+                .ToList();
+        }
+    }
+
+    private class SourceRegistration((string name, string kind, Func<long> value) source) : IDisposable
+    {
+        public void Dispose()
+        {
+            lock (Sources)
+            {
+                Sources.Remove(source);
+            }
+        }
+    }
+}
\ No newline at end of file
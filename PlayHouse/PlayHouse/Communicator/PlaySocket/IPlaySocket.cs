@@ -1,4 +1,5 @@
-﻿using PlayHouse.Communicator.Message;
+﻿using NetMQ;
+using PlayHouse.Communicator.Message;
 
 namespace PlayHouse.Communicator.PlaySocket;
 
@@ -11,6 +12,9 @@ internal interface IPlaySocket
     RoutePacket? Receive();
     void Disconnect(string endpoint);
 
+    // receiveReady is invoked on the poller thread whenever there is something to Receive()
+    void Attach(NetMQPoller poller, Action receiveReady);
+
     void Close();
 
     string Id();
@@ -1,9 +1,11 @@
-﻿using System.Text;
+﻿using System.Buffers;
+using System.Text;
 using Google.Protobuf;
 using NetMQ;
 using NetMQ.Sockets;
 using PlayHouse.Communicator.Message;
 using Playhouse.Protocol;
+using PlayHouse.Service.Session.Network;
 using PlayHouse.Utils;
 
 namespace PlayHouse.Communicator.PlaySocket;
@@ -11,15 +13,20 @@ namespace PlayHouse.Communicator.PlaySocket;
 internal class NetMqPlaySocket : IPlaySocket
 {
     private readonly string _bindEndpoint;
-    private readonly PooledByteBuffer _buffer = new(ConstOption.MaxPacketSize);
+    private readonly int _compressThreshold;
+    private readonly PooledByteBuffer _headerBuffer = new(ConstOption.MaxClientHeaderSize);
+    private readonly IdentityCache _identityCache = new();
     private readonly LOG<NetMqPlaySocket> _log = new();
+    private readonly RouteHeaderMsg _receiveHeaderMsg = new() { HeaderMsg = new HeaderMsg() };
+    private readonly RouteHeaderMsg _sendHeaderMsg = new() { HeaderMsg = new HeaderMsg() };
     private readonly RouterSocket _socket = new();
 
     public NetMqPlaySocket(SocketConfig socketConfig, string bindEndpoint)
     {
         _bindEndpoint = bindEndpoint;
+        _compressThreshold = socketConfig.CompressThreshold;
 
-        _socket.Options.Identity = Encoding.UTF8.GetBytes(_bindEndpoint);
+        _socket.Options.Identity = _identityCache.BytesOf(_bindEndpoint);
         _socket.Options.DelayAttachOnConnect = true; // immediate
         _socket.Options.RouterHandover = true;
         _socket.Options.Backlog = socketConfig.BackLog;
@@ -68,6 +75,12 @@ internal class NetMqPlaySocket : IPlaySocket
         _socket.Disconnect(endpoint);
     }
 
+    public void Attach(NetMQPoller poller, Action receiveReady)
+    {
+        _socket.ReceiveReady += (_, _) => receiveReady();
+        poller.Add(_socket);
+    }
+
     public string GetBindEndpoint()
     {
         return _bindEndpoint;
@@ -80,26 +93,70 @@ internal class NetMqPlaySocket : IPlaySocket
 
     public RoutePacket? Receive()
     {
-        var message = new NetMQMessage();
-        if (_socket.TryReceiveMultipartMessage(ref message))
+        var identity = new Msg();
+        identity.InitEmpty();
+
+        if (!_socket.TryReceive(ref identity, TimeSpan.Zero))
         {
-            if (message.Count() < 3)
+            identity.Close();
+            return null;
+        }
+
+        var header = new Msg();
+        var body = new Msg();
+        header.InitEmpty();
+        body.InitEmpty();
+
+        try
+        {
+            if (!identity.HasMore || !_socket.TryReceive(ref header, TimeSpan.Zero) ||
+                !header.HasMore || !_socket.TryReceive(ref body, TimeSpan.Zero))
             {
-                _log.Error(() => $"message size is invalid : {message.Count()}");
+                var from = _identityCache.NameOf(SpanOf(ref identity));
+                _log.Error(() => $"message size is invalid : from {from}");
+                SkipRemainFrames(header.HasMore || body.HasMore);
                 return null;
             }
 
-            var target = Encoding.UTF8.GetString(message[0].Buffer);
-            var header = RouteHeaderMsg.Parser.ParseFrom(message[1].Buffer);
-            //PooledBufferPayload payload = new(new (message[2].Buffer));
-            var payload = new FramePayload(message[2]);
+            SkipRemainFrames(body.HasMore);
+
+            var target = _identityCache.NameOf(SpanOf(ref identity));
+
+            // the header message is reused, only the decoded values are copied into a (pooled) RouteHeader
+            ResetReceiveHeaderMsg();
+            _receiveHeaderMsg.MergeFrom(SpanOf(ref header));
+            var routeHeader = RouteHeader.Of(_receiveHeaderMsg);
+
+            // the received buffer is handed over to the payload as is, so the body is not copied again
+            // and goes back to the pool when the payload is disposed or moved into a send
+            IPayload payload;
+            if (_receiveHeaderMsg.HeaderMsg.Compressed)
+            {
+                payload = PacketParser.Decompress(SpanOf(ref body));
+            }
+            else if (body.Size == 0)
+            {
+                payload = new FramePayload(NetMQFrame.Empty);
+            }
+            else if (body.Offset == 0)
+            {
+                payload = new MsgPayload(ref body);
+            }
+            else
+            {
+                payload = new FramePayload(new NetMQFrame(body.CloneData()));
+            }
 
-            var routePacket = RoutePacket.Of(new RouteHeader(header), payload);
+            var routePacket = RoutePacket.OwnedOf(routeHeader, payload);
             routePacket.RouteHeader.From = target;
             return routePacket;
         }
-
-        return null;
+        finally
+        {
+            identity.Close();
+            header.Close();
+            body.Close();
+        }
     }
 
     public void Send(string endpoint, RoutePacket routePacket)
@@ -111,50 +168,213 @@ internal class NetMqPlaySocket : IPlaySocket
 
         using (routePacket)
         {
-            var message = new NetMQMessage();
-            var payload = routePacket.Payload;
+            var identity = new Msg();
+            var header = new Msg();
+            var body = new Msg();
+            identity.InitEmpty();
+            header.InitEmpty();
+            body.InitEmpty();
 
-            NetMQFrame frame;
-
-            _buffer.Clear();
-            if (routePacket.IsToClient())
+            try
             {
-                routePacket.WriteClientPacketBytes(_buffer);
-                frame = new NetMQFrame(_buffer.Buffer(), _buffer.Count);
-            }
-            else
-            {
-                if (payload is FramePayload framePayload)
+                // every frame is prepared before the first one is sent,
+                // so a serialize error can't leave a half sent multipart message on the socket
+                var identityBytes = _identityCache.BytesOf(endpoint);
+                identity.InitGC(identityBytes, identityBytes.Length);
+
+                if (routePacket.IsToClient())
                 {
-                    frame = framePayload.Frame;
+                    WriteClientBody(ref body, routePacket.ToClientPacket());
                 }
                 else
                 {
-                    _buffer.Write(payload.DataSpan);
-                    frame = new NetMQFrame(_buffer.Buffer(), _buffer.Count);
+                    WriteBody(ref body, routePacket.Payload);
                 }
+
+                routePacket.RouteHeader.CopyTo(_sendHeaderMsg);
+                _sendHeaderMsg.HeaderMsg.Compressed =
+                    _compressThreshold > 0 && body.Size >= _compressThreshold && Compress(ref body);
+                header.InitPool(_sendHeaderMsg.CalculateSize());
+                _sendHeaderMsg.WriteTo(SpanOf(ref header));
+
+                if (!_socket.TrySend(ref identity, TimeSpan.Zero, true))
+                {
+                    _log.Error(() => $"PostAsync fail to {endpoint}, MsgName:{routePacket.MsgId}");
+                    return;
+                }
+
+                // if a later frame fails, the Msgs not sent yet are closed in finally
+                if (!_socket.TrySend(ref header, TimeSpan.Zero, true) ||
+                    !_socket.TrySend(ref body, TimeSpan.Zero, false))
+                {
+                    _log.Error(() => $"PostAsync fail in the middle of message to {endpoint}, MsgName:{routePacket.MsgId}");
+                }
+            }
+            finally
+            {
+                identity.Close();
+                header.Close();
+                body.Close();
             }
+        }
+    }
 
+    private void WriteClientBody(ref Msg body, ClientPacket clientPacket)
+    {
+        var payload = clientPacket.Payload;
+        var bodySize = payload.Length;
 
-            message.Append(new NetMQFrame(Encoding.UTF8.GetBytes(endpoint)));
-            var routerHeaderMsg = routePacket.RouteHeader.ToMsg();
+        _headerBuffer.Clear();
+        RoutePacket.WriteClientHeaderBytes(clientPacket, bodySize, _headerBuffer);
 
-            var headerSize = routerHeaderMsg.CalculateSize();
-            var headerFrame = new NetMQFrame(headerSize);
-            routerHeaderMsg.WriteTo(new MemoryStream(headerFrame.Buffer));
+        var headerSize = _headerBuffer.Count;
+        body.InitPool(headerSize + bodySize);
 
-            message.Append(headerFrame);
-            message.Append(frame);
+        var span = SpanOf(ref body);
+        _headerBuffer.Buffer().AsSpan(0, headerSize).CopyTo(span);
+        payload.WriteTo(span.Slice(headerSize, bodySize));
+    }
 
-            if (!_socket.TrySendMultipartMessage(message))
+    private static void WriteBody(ref Msg body, IPayload payload)
+    {
+        if (payload is FramePayload framePayload)
+        {
+            var frame = framePayload.Frame;
+            if (frame.MessageSize > 0)
             {
-                _log.Error(() => $"PostAsync fail to {endpoint}, MsgName:{routePacket.MsgId}");
+                body.InitGC(frame.Buffer, frame.MessageSize);
             }
+
+            return;
+        }
+
+        if (payload is MsgPayload msgPayload)
+        {
+            // pooled body of a client packet, NetMQ gives the buffer back to the pool once it is sent
+            msgPayload.MoveTo(ref body);
+            return;
+        }
+
+        var bodySize = payload.Length;
+        if (bodySize == 0)
+        {
+            return;
+        }
+
+        body.InitPool(bodySize);
+        payload.WriteTo(SpanOf(ref body));
+    }
+
+    // swaps the body for the compressed pool buffer only when it shrinks
+    private static bool Compress(ref Msg body)
+    {
+        var rented = ArrayPool<byte>.Shared.Rent(FrameCompression.MaxCompressedSize(body.Size));
+        try
+        {
+            var size = FrameCompression.Compress(SpanOf(ref body), rented);
+            if (size == 0)
+            {
+                return false;
+            }
+
+            body.Close();
+            body.InitPool(size);
+            rented.AsSpan(0, size).CopyTo(SpanOf(ref body));
+            return true;
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(rented);
+        }
+    }
+
+    private void ResetReceiveHeaderMsg()
+    {
+        var headerMsg = _receiveHeaderMsg.HeaderMsg;
+        headerMsg.ServiceId = 0;
+        headerMsg.Compressed = false;
+        headerMsg.MsgId = "";
+        headerMsg.MsgNum = 0;
+        headerMsg.MsgSeq = 0;
+        headerMsg.ErrorCode = 0;
+        headerMsg.StageId = 0;
+
+        _receiveHeaderMsg.Sid = 0;
+        _receiveHeaderMsg.IsSystem = false;
+        _receiveHeaderMsg.IsReply = false;
+        _receiveHeaderMsg.IsBase = false;
+        _receiveHeaderMsg.IsBackend = false;
+        _receiveHeaderMsg.StageId = 0;
+        _receiveHeaderMsg.AccountId = 0;
+        _receiveHeaderMsg.Sids.Clear();
+    }
+
+    private void SkipRemainFrames(bool hasMore)
+    {
+        if (!hasMore)
+        {
+            return;
+        }
+
+        var msg = new Msg();
+        msg.InitEmpty();
+        try
+        {
+            while (_socket.TryReceive(ref msg, TimeSpan.Zero) && msg.HasMore)
+            {
+            }
+        }
+        finally
+        {
+            msg.Close();
         }
     }
 
+    private static Span<byte> SpanOf(ref Msg msg)
+    {
+        return msg.Size == 0 ? Span<byte>.Empty : new Span<byte>(msg.Data, msg.Offset, msg.Size);
+    }
+
     public void Dispose()
     {
         throw new NotImplementedException();
     }
+}
+
+/// <summary>
+///     Caches the conversion between endpoint strings and router identity frames.
+///     There is one entry per server so entries are never removed, used only on the socket thread.
+/// </summary>
+internal class IdentityCache
+{
+    private readonly Dictionary<string, byte[]> _bytes = new();
+    private readonly Dictionary<int, (byte[] Bytes, string Name)> _names = new();
+
+    public byte[] BytesOf(string endpoint)
+    {
+        if (!_bytes.TryGetValue(endpoint, out var bytes))
+        {
+            bytes = Encoding.UTF8.GetBytes(endpoint);
+            _bytes[endpoint] = bytes;
+        }
+
+        return bytes;
+    }
+
+    public string NameOf(ReadOnlySpan<byte> identity)
+    {
+        var hash = Fnv1a.Hash32(identity);
+        if (_names.TryGetValue(hash, out var entry) && identity.SequenceEqual(entry.Bytes))
+        {
+            return entry.Name;
+        }
+
+        var name = Encoding.UTF8.GetString(identity);
+        if (entry.Bytes == null)
+        {
+            _names[hash] = (identity.ToArray(), name);
+        }
+
+        return name;
+    }
 }
\ No newline at end of file
@@ -1,9 +1,23 @@
-﻿namespace PlayHouse.Communicator.PlaySocket;
+﻿using NetMQ;
+
+namespace PlayHouse.Communicator.PlaySocket;
 
 internal abstract class PlaySocketFactory
 {
+    private static int _bufferPoolInitialized;
+
     public static IPlaySocket CreatePlaySocket(SocketConfig config, string bindEndpoint)
     {
         return new NetMqPlaySocket(config, bindEndpoint);
     }
+
+    // send frames are rented from the NetMQ buffer pool and given back by NetMQ once they are written,
+    // the pool is process wide so it is set only once and before any socket is created
+    public static void InitBufferPool(long maxBufferPoolSize)
+    {
+        if (Interlocked.Exchange(ref _bufferPoolInitialized, 1) == 0)
+        {
+            BufferPool.SetBufferManagerBufferPool(maxBufferPoolSize, ConstOption.MaxPacketSize);
+        }
+    }
 }
\ No newline at end of file
@@ -8,4 +8,7 @@ public class SocketConfig
     public int ReceiveBufferSize { get; internal set; } = 1024 * 1024;
     public int SendHighWatermark { get; internal set; } = 1000000;
     public int ReceiveHighWatermark { get; internal set; } = 1000000;
+
+    // compresses sent bodies of this size or more, 0 disables it, receivers decompress whatever this is
+    public int CompressThreshold { get; internal set; } = 0;
 }
\ No newline at end of file
@@ -1,5 +1,5 @@
-﻿using System.Collections.Specialized;
-using System.Runtime.Caching;
+﻿using System.Collections.Concurrent;
+using System.Diagnostics;
 using PlayHouse.Communicator.Message;
 using Playhouse.Protocol;
 using PlayHouse.Service.Shared;
@@ -11,6 +11,11 @@ internal class ReplyObject(
     ReplyCallback? callback = null,
     TaskCompletionSource<RoutePacket>? taskCompletionSource = null)
 {
+    // distinguishes requests that reused the same 16 bit sequence slot
+    internal int Generation { get; set; }
+
+    internal long StartedAt { get; set; }
+
     public void OnReceive(RoutePacket routePacket)
     {
         if (callback != null)
@@ -39,70 +44,123 @@ internal class ReplyObject(
     }
 }
 
+/// <summary>
+///     Pending request table indexed by the 16 bit msgSeq.
+///     Slots are claimed and released with interlocked operations, a request is completed exactly once
+///     by whichever of reply and timeout takes the slot first.
+///     Timeouts are expired by a hashed timer wheel, entries carry the slot generation
+///     so an already answered slot that got reused is not expired by a stale entry.
+/// </summary>
 internal class RequestCache
 {
+    private const int TickMs = 100;
+    private const int WheelSize = 512; // power of 2
+    private const int MaxSequenceProbe = 64;
+
+    private readonly ConcurrentQueue<WheelEntry>[] _wheel;
     private readonly LOG<RequestCache> _log = new();
-    private readonly CacheItemPolicy _policy;
-    private readonly AtomicShort _sequence = new();
-    private MemoryCache _cache;
+    private readonly ReplyObject?[] _slots = new ReplyObject?[ushort.MaxValue + 1];
+    private readonly Stopwatch _stopwatch = Stopwatch.StartNew();
+    private readonly Timer? _timer;
+    private readonly long _timeoutTicks;
+
+    private int _generation;
+    private long _inFlight;
+    private long _lateReplies;
+    private long _processedTick;
+    private int _sequence;
+    private int _ticking;
+    private long _timedOut;
 
     public RequestCache(int timeout)
     {
-        _policy = new CacheItemPolicy();
+        _wheel = new ConcurrentQueue<WheelEntry>[WheelSize];
+        for (var i = 0; i < WheelSize; i++)
+        {
+            _wheel[i] = new ConcurrentQueue<WheelEntry>();
+        }
+
         if (timeout > 0)
         {
-            _policy.SlidingExpiration = TimeSpan.FromSeconds(timeout);
+            _timeoutTicks = Math.Max(1, timeout * 1000 / TickMs);
+            _timer = new Timer(_ => OnTick(), null, TickMs, TickMs);
         }
+    }
+
+    public long InFlightCount => Interlocked.Read(ref _inFlight);
+    public long TimedOutCount => Interlocked.Read(ref _timedOut);
+    public long LateReplyCount => Interlocked.Read(ref _lateReplies);
 
-        // Set a callback to be called when the cache item is removed
-        _policy.RemovedCallback = args =>
+    public ushort GetSequence()
+    {
+        // 0 means "not a request", and a slot that is still waiting for its reply is skipped
+        ushort seq = 0;
+        for (var i = 0; i < MaxSequenceProbe; i++)
         {
-            if (args.RemovedReason == CacheEntryRemovedReason.Expired)
+            seq = (ushort)Interlocked.Increment(ref _sequence);
+            if (seq != 0 && Volatile.Read(ref _slots[seq]) == null)
             {
-                var replyObject = (ReplyObject)args.CacheItem.Value;
-                replyObject.Throw((int)BaseErrorCode.RequestTimeout);
+                return seq;
             }
-        };
+        }
 
-        var cacheSettings = new NameValueCollection
-        {
-            { "CacheMemoryLimitMegabytes", "10" },
-            { "PhysicalMemoryLimitPercentage", "1" }
-        };
-        _cache = new MemoryCache("RequestCache", cacheSettings);
+        return seq == 0 ? (ushort)Interlocked.Increment(ref _sequence) : seq;
     }
 
-    public ushort GetSequence()
+    public void Put(int seq, ReplyObject replyObject)
     {
-        return _sequence.IncrementAndGet();
+        replyObject.Generation = Interlocked.Increment(ref _generation);
+        replyObject.StartedAt = PlayMetrics.StartTimestamp(PlayMetrics.RequestDuration);
+
+        var old = Interlocked.Exchange(ref _slots[(ushort)seq], replyObject);
+        if (old != null)
+        {
+            // the sequence space wrapped around while the old request was still pending
+            _log.Error(() => $"request slot is overwritten - [seq:{seq}]");
+            Interlocked.Increment(ref _timedOut);
+            PlayMetrics.RequestTimeouts.Add(1);
+            old.Throw((int)BaseErrorCode.RequestTimeout);
+        }
+        else
+        {
+            Interlocked.Increment(ref _inFlight);
+        }
+
+        if (_timer != null)
+        {
+            var deadline = CurrentTick() + _timeoutTicks;
+            _wheel[deadline & (WheelSize - 1)]
+                .Enqueue(new WheelEntry((ushort)seq, replyObject.Generation, deadline));
+        }
     }
 
-    public void Put(int seq, ReplyObject replyObject)
+    public void Stop()
     {
-        var cacheItem = new CacheItem(seq.ToString(), replyObject);
-        MemoryCache.Default.Add(cacheItem, _policy);
+        _timer?.Dispose();
     }
 
     public ReplyObject? Get(int seq)
     {
-        return (ReplyObject?)MemoryCache.Default.Get(seq.ToString());
+        return Volatile.Read(ref _slots[(ushort)seq]);
     }
 
     public void OnReply(RoutePacket routePacket)
     {
         try
         {
-            int msgSeq = routePacket.Header.MsgSeq;
-            var key = msgSeq.ToString();
-            var replyObject = (ReplyObject?)MemoryCache.Default.Get(key);
+            var msgSeq = routePacket.Header.MsgSeq;
+            var replyObject = Interlocked.Exchange(ref _slots[msgSeq], null);
 
             if (replyObject != null)
             {
+                Interlocked.Decrement(ref _inFlight);
+                PlayMetrics.RecordElapsed(PlayMetrics.RequestDuration, replyObject.StartedAt,
+                    new KeyValuePair<string, object?>("result", routePacket.ErrorCode == 0 ? "ok" : "error"));
                 replyObject.OnReceive(routePacket);
-                MemoryCache.Default.Remove(key);
             }
             else
             {
+                Interlocked.Increment(ref _lateReplies);
                 _log.Error(() => $"request is not exist - [packetInfo:{routePacket.RouteHeader}]");
             }
         }
@@ -111,4 +169,83 @@ internal class RequestCache
             _log.Error(() => $"{ex}");
         }
     }
+
+    private long CurrentTick()
+    {
+        return _stopwatch.ElapsedMilliseconds / TickMs;
+    }
+
+    private void OnTick()
+    {
+        if (Interlocked.CompareExchange(ref _ticking, 1, 0) != 0)
+        {
+            return;
+        }
+
+        try
+        {
+            var now = CurrentTick();
+            while (_processedTick < now)
+            {
+                _processedTick++;
+                ExpireBucket(_processedTick);
+            }
+        }
+        catch (Exception ex)
+        {
+            _log.Error(() => $"{ex}");
+        }
+        finally
+        {
+            Volatile.Write(ref _ticking, 0);
+        }
+    }
+
+    private void ExpireBucket(long tick)
+    {
+        var bucket = _wheel[tick & (WheelSize - 1)];
+        var count = bucket.Count;
+
+        for (var i = 0; i < count && bucket.TryDequeue(out var entry); i++)
+        {
+            if (entry.Deadline > tick)
+            {
+                // belongs to a later round of the wheel
+                bucket.Enqueue(entry);
+                continue;
+            }
+
+            var replyObject = Volatile.Read(ref _slots[entry.Seq]);
+            if (replyObject == null || replyObject.Generation != entry.Generation)
+            {
+                continue;
+            }
+
+            if (Interlocked.CompareExchange(ref _slots[entry.Seq], null, replyObject) != replyObject)
+            {
+                continue;
+            }
+
+            Interlocked.Decrement(ref _inFlight);
+            Interlocked.Increment(ref _timedOut);
+            PlayMetrics.RequestTimeouts.Add(1);
+
+            // one entry throwing does not stop the rest of the bucket from expiring
+            try
+            {
+                replyObject.Throw((int)BaseErrorCode.RequestTimeout);
+            }
+            catch (Exception ex)
+            {
+                _log.Error(() => $"request timeout error - [seq:{entry.Seq}] - {ex}");
+            }
+        }
+    }
+
+    private readonly struct WheelEntry(ushort seq, int generation, long deadline)
+    {
+        public ushort Seq { get; } = seq;
+        public int Generation { get; } = generation;
+        public long Deadline { get; } = deadline;
+    }
 }
\ No newline at end of file
@@ -11,6 +11,7 @@ internal class ServerAddressResolver(
     IServerInfoRetriever storageClient)
 {
     private readonly LOG<ServerAddressResolver> _log = new();
+    private readonly LoadMeter _loadMeter = new();
 
     private Timer? _timer;
 
@@ -23,7 +24,8 @@ internal class ServerAddressResolver(
             try
             {
                 var myServerInfo = new XServerInfo(bindEndpoint, service.GetServiceType(), service.ServiceId,
-                    service.GetServerState(), service.GetActorCount(), DateTimeOffset.UtcNow.ToUnixTimeMilliseconds());
+                    service.GetServerState(), service.GetActorCount(), DateTimeOffset.UtcNow.ToUnixTimeMilliseconds(),
+                    _loadMeter.Sample());
 
                 //자신의 정보먼저  update
                 serverInfoCenter.Update(new List<XServerInfo> { myServerInfo });
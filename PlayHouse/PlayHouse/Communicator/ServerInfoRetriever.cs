@@ -16,33 +16,67 @@ internal class ServerInfoRetriever(
     XSender sender)
     : IServerInfoRetriever
 {
+    private readonly Dictionary<string, XServerInfo> _members = new();
+    private long _epoch;
     private int _index;
     private LOG<ServerInfoRetriever> _log = new();
+    private long _version;
 
+    // stays on the same address server to receive deltas, moves to the next one only on failure
     public async Task<List<XServerInfo>> UpdateServerListAsync(XServerInfo serverInfo)
     {
-        if (_index <= apiEndpoints.Count)
+        if (_index >= apiEndpoints.Count)
         {
             _index = 0;
         }
 
-        var endpoint = apiEndpoints[_index++];
+        var endpoint = apiEndpoints[_index];
 
+        UpdateServerInfoRes updateRes;
+        try
+        {
+            using var res = await sender.RequestToBaseApi(endpoint,
+                RoutePacket.Of(new UpdateServerInfoReq
+                    { ServerInfo = serverInfo.ToMsg(), Epoch = _epoch, Version = _version }));
 
-        using var res = await sender.RequestToBaseApi(endpoint,
-            RoutePacket.Of(new UpdateServerInfoReq { ServerInfo = serverInfo.ToMsg() }));
-
-        var updateRes = UpdateServerInfoRes.Parser.ParseFrom(res.Payload.DataSpan);
+            updateRes = UpdateServerInfoRes.Parser.ParseFrom(res.Payload.DataSpan);
+        }
+        catch
+        {
+            _index++;
+            throw;
+        }
 
         //_log.Info(() => $"update - [target endpoint:{endpoint},server count:{updateRes.ServerInfos.Count}]");
 
-        var endpoints = updateRes.ServerInfos.Where(e => e.ServiceId == apiServiceId).Select(e => e.Endpoint).ToList();
-        if (endpoints.Count > 0)
+        if (!updateRes.Delta)
+        {
+            _members.Clear();
+        }
+
+        foreach (var info in updateRes.ServerInfos)
+        {
+            _members[info.Endpoint] = XServerInfo.Of(info);
+        }
+
+        _epoch = updateRes.Epoch;
+        _version = updateRes.Version;
+
+        var endpoints = _members.Values.Where(e => e.GetServiceId() == apiServiceId && e.IsValid())
+            .Select(e => e.GetBindEndpoint()).ToList();
+        if (endpoints.Count > 0 && !endpoints.SequenceEqual(apiEndpoints))
         {
             apiEndpoints = endpoints;
+            _index = Math.Max(0, apiEndpoints.IndexOf(endpoint));
         }
 
-        return updateRes.ServerInfos.Select(e => XServerInfo.Of(e)).ToList();
-        //return updateRes.ServerInfos.Where(e=>e.Endpoint != serverInfo.GetBindEndpoint()).Select(e=>XServerInfo.Of(e)).ToList();
+        // unchanged servers are not sent again, so they are passed on refreshed to when the address server last saw them alive
+        var now = DateTimeOffset.UtcNow.ToUnixTimeMilliseconds();
+        return _members.Values.Select(e =>
+        {
+            var info = XServerInfo.Of(e);
+            info.SetLastUpdate(now);
+            return info;
+        }).ToList();
     }
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+﻿namespace PlayHouse.Communicator;
+
+// picks one from the running servers of a serviceId, the list is never empty
+internal static class ServerSelector
+{
+    public static XServerInfo LeastActor(XServerInfo[] servers)
+    {
+        // ties on actor count are broken randomly so load does not pile onto one server
+        var start = Random.Shared.Next(servers.Length);
+        var best = servers[start];
+        for (var i = 1; i < servers.Length; i++)
+        {
+            var server = servers[(start + i) % servers.Length];
+            if (server.GetActorCount() < best.GetActorCount())
+            {
+                best = server;
+            }
+        }
+
+        return best;
+    }
+
+    public static XServerInfo PowerOfTwoChoices(XServerInfo[] servers)
+    {
+        if (servers.Length == 1)
+        {
+            return servers[0];
+        }
+
+        var first = Random.Shared.Next(servers.Length);
+        var second = Random.Shared.Next(servers.Length - 1);
+        if (second >= first)
+        {
+            second++;
+        }
+
+        var a = servers[first];
+        var b = servers[second];
+        return b.GetActorCount() < a.GetActorCount() ? b : a;
+    }
+
+    public static XServerInfo WeightedLoad(XServerInfo[] servers)
+    {
+        // minimum weight 1 so a server at load 100 is still picked once in a while
+        var total = 0;
+        foreach (var server in servers)
+        {
+            total += WeightOf(server);
+        }
+
+        var pick = Random.Shared.Next(total);
+        foreach (var server in servers)
+        {
+            pick -= WeightOf(server);
+            if (pick < 0)
+            {
+                return server;
+            }
+        }
+
+        return servers[^1];
+    }
+
+    private static int WeightOf(XServerInfo server)
+    {
+        return Math.Max(1, 100 - server.GetLoad());
+    }
+}
\ No newline at end of file
@@ -1,4 +1,4 @@
-﻿using System.Collections.Concurrent;
+﻿using NetMQ;
 using PlayHouse.Communicator.Message;
 using PlayHouse.Communicator.PlaySocket;
 using Playhouse.Protocol;
@@ -6,13 +6,43 @@ using PlayHouse.Utils;
 
 namespace PlayHouse.Communicator;
 
-internal class XClientCommunicator(IPlaySocket playSocket) : IClientCommunicator
+internal enum ClientCommandType
+{
+    Connect,
+    Disconnect,
+    Send
+}
+
+internal readonly struct ClientCommand(ClientCommandType type, string endpoint, RoutePacket? routePacket = null)
+{
+    public ClientCommandType Type { get; } = type;
+    public string Endpoint { get; } = endpoint;
+    public RoutePacket? RoutePacket { get; } = routePacket;
+}
+
+internal class XClientCommunicator : IClientCommunicator
 {
     private readonly HashSet<string> _connected = new();
     private readonly HashSet<string> _disconnected = new();
     private readonly LOG<XClientCommunicator> _log = new();
-    private readonly ConcurrentQueue<Action> _queue = new();
-    private bool _running = true;
+    private readonly IDisposable _sendQueueMetric;
+    private readonly IPlaySocket _playSocket;
+    private readonly NetMQQueue<ClientCommand> _queue = new();
+    private readonly int _sendQueueCapacity;
+    private readonly bool _useLocalTransport;
+    private NetMQPoller? _poller;
+    private long _pendingSends;
+
+    // sendQueueCapacity : 0 means unbounded, beyond it packets are dropped (requests time out on the requesting side)
+    // useLocalTransport : servers in the same process are sent to through LocalTransport instead of the socket
+    public XClientCommunicator(IPlaySocket playSocket, int sendQueueCapacity = 0, bool useLocalTransport = false)
+    {
+        _playSocket = playSocket;
+        _sendQueueCapacity = sendQueueCapacity;
+        _useLocalTransport = useLocalTransport;
+        _queue.ReceiveReady += OnCommandReady;
+        _sendQueueMetric = PlayMetrics.ObserveSendQueue(() => Interlocked.Read(ref _pendingSends));
+    }
 
     public void Connect(string endpoint)
     {
@@ -21,20 +51,7 @@ internal class XClientCommunicator(IPlaySocket playSocket) : IClientCommunicator
             return;
         }
 
-        _queue.Enqueue(() =>
-        {
-            try
-            {
-                playSocket.Connect(endpoint);
-                _connected.Add(endpoint);
-                _disconnected.Remove(endpoint);
-                _log.Info(() => $"connected with {endpoint}");
-            }
-            catch (Exception ex)
-            {
-                _log.Error(() => $"connect error - endpoint:{endpoint}, error:{ex.Message}");
-            }
-        });
+        _queue.Enqueue(new ClientCommand(ClientCommandType.Connect, endpoint));
     }
 
     public void Disconnect(string endpoint)
@@ -44,77 +61,161 @@ internal class XClientCommunicator(IPlaySocket playSocket) : IClientCommunicator
             return;
         }
 
-        _queue.Enqueue(() =>
-        {
-            try
-            {
-                playSocket.Disconnect(endpoint);
-                _log.Info(() => $"disconnected with {endpoint}");
-            }
-            catch (Exception ex)
-            {
-                _log.Error(() => $"disconnect error - endpoint:{endpoint}, error:{ex.Message}");
-            }
-            finally
-            {
-                _connected.Remove(endpoint);
-                _disconnected.Add(endpoint);
-            }
-        });
+        _queue.Enqueue(new ClientCommand(ClientCommandType.Disconnect, endpoint));
     }
 
     public void Stop()
     {
-        _running = false;
+        if (_poller is { IsRunning: true })
+        {
+            _poller.StopAsync();
+        }
+
+        _sendQueueMetric.Dispose();
     }
 
     public void Send(string endpoint, RoutePacket routePacket)
     {
-        _queue.Enqueue(() =>
+        if (_useLocalTransport && TrySendLocal(endpoint, routePacket))
         {
-            try
+            return;
+        }
+
+        var pending = Interlocked.Increment(ref _pendingSends);
+        if (_sendQueueCapacity > 0 && pending > _sendQueueCapacity)
+        {
+            Interlocked.Decrement(ref _pendingSends);
+            _log.Warn(() => $"send queue is full, packet is dropped - [target endpoint:{endpoint},msgId:{routePacket.MsgId}]");
+            routePacket.Dispose();
+            return;
+        }
+
+        _queue.Enqueue(new ClientCommand(ClientCommandType.Send, endpoint, routePacket));
+    }
+
+    private bool TrySendLocal(string endpoint, RoutePacket routePacket)
+    {
+        try
+        {
+            return LocalTransport.TrySend(_playSocket.Id(), endpoint, routePacket);
+        }
+        catch (Exception e)
+        {
+            _log.Error(
+                () => $"local send error : [target endpoint:{endpoint}] - {e.Message}"
+            );
+            return true;
+        }
+    }
+
+    public void Attach(NetMQPoller poller)
+    {
+        poller.Add(_queue);
+    }
+
+    public void Communicate()
+    {
+        using var poller = new NetMQPoller();
+        _poller = poller;
+        Attach(poller);
+        poller.Run();
+    }
+
+    private void OnCommandReady(object? sender, NetMQQueueEventArgs<ClientCommand> args)
+    {
+        for (var i = 0; i < ConstOption.CommunicatorBatchSize; i++)
+        {
+            if (!args.Queue.TryDequeue(out var command, TimeSpan.Zero))
             {
-                using (routePacket)
-                {
-                    if (routePacket.MsgId != UpdateServerInfoReq.Descriptor.Name &&
-                        routePacket.MsgId != UpdateServerInfoRes.Descriptor.Name)
-                    {
-                        _log.Trace(() => $"sendTo:{endpoint} - [packetInfo:{routePacket.RouteHeader}]");
-                    }
+                return;
+            }
 
-                    playSocket.Send(endpoint, routePacket);
-                }
+            try
+            {
+                Execute(command);
             }
             catch (Exception e)
             {
                 _log.Error(
-                    () =>
-                        $"socket send error : [target endpoint:{endpoint},target msgId:{routePacket.MsgId}] - {e.Message}"
+                    () => $"{_playSocket.Id()} Error during communication - {e.Message}"
                 );
             }
-        });
+        }
     }
 
-    public void Communicate()
+    private void Execute(ClientCommand command)
+    {
+        switch (command.Type)
+        {
+            case ClientCommandType.Connect:
+                DoConnect(command.Endpoint);
+                break;
+            case ClientCommandType.Disconnect:
+                DoDisconnect(command.Endpoint);
+                break;
+            case ClientCommandType.Send:
+                Interlocked.Decrement(ref _pendingSends);
+                DoSend(command.Endpoint, command.RoutePacket!);
+                break;
+        }
+    }
+
+    private void DoConnect(string endpoint)
+    {
+        try
+        {
+            _playSocket.Connect(endpoint);
+            _connected.Add(endpoint);
+            _disconnected.Remove(endpoint);
+            _log.Info(() => $"connected with {endpoint}");
+        }
+        catch (Exception ex)
+        {
+            _log.Error(() => $"connect error - endpoint:{endpoint}, error:{ex.Message}");
+        }
+    }
+
+    private void DoDisconnect(string endpoint)
     {
-        while (_running)
+        try
         {
-            //var action = _jobBucket.Get();
-            while (_queue.TryDequeue(out var action))
+            _playSocket.Disconnect(endpoint);
+            _log.Info(() => $"disconnected with {endpoint}");
+        }
+        catch (Exception ex)
+        {
+            _log.Error(() => $"disconnect error - endpoint:{endpoint}, error:{ex.Message}");
+        }
+        finally
+        {
+            _connected.Remove(endpoint);
+            _disconnected.Add(endpoint);
+        }
+    }
+
+    private void DoSend(string endpoint, RoutePacket routePacket)
+    {
+        // in pool mode a disposed packet is reused elsewhere right away, so the values for the log are read first
+        var msgId = routePacket.MsgId;
+        try
+        {
+            using (routePacket)
             {
-                try
-                {
-                    action.Invoke();
-                }
-                catch (Exception e)
+                if (msgId != UpdateServerInfoReq.Descriptor.Name &&
+                    msgId != UpdateServerInfoRes.Descriptor.Name)
                 {
-                    _log.Error(
-                        () => $"{playSocket.Id()} Error during communication - {e.Message}"
-                    );
+                    _log.Trace(() => $"sendTo:{endpoint} - [packetInfo:{routePacket.RouteHeader}]");
                 }
-            }
 
-            Thread.Sleep(ConstOption.ThreadSleep);
+                _playSocket.Send(endpoint, routePacket);
+            }
+        }
+        catch (Exception e)
+        {
+            _log.Error(
+                () =>
+                    $"socket send error : [target endpoint:{endpoint},target msgId:{msgId}] - {e.Message}"
+            );
         }
     }
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
-﻿using PlayHouse.Communicator.PlaySocket;
+﻿using NetMQ;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Communicator.PlaySocket;
 using Playhouse.Protocol;
 using PlayHouse.Utils;
 
@@ -9,7 +11,7 @@ internal class XServerCommunicator(IPlaySocket playSocket) : IServerCommunicator
     private readonly LOG<XServerCommunicator> _log = new();
 
     private ICommunicateListener? _listener;
-    private bool _running = true;
+    private NetMQPoller? _poller;
 
     public void Bind(ICommunicateListener listener)
     {
@@ -17,38 +19,67 @@ internal class XServerCommunicator(IPlaySocket playSocket) : IServerCommunicator
         playSocket.Bind();
     }
 
+    public void Attach(NetMQPoller poller)
+    {
+        playSocket.Attach(poller, OnReceiveReady);
+    }
 
     public void Communicate()
     {
-        while (_running)
+        using var poller = new NetMQPoller();
+        _poller = poller;
+        Attach(poller);
+        poller.Run();
+    }
+
+    public void Stop()
+    {
+        if (_poller is { IsRunning: true })
         {
-            var packet = playSocket.Receive();
-            while (packet != null)
-            {
-                try
-                {
-                    if (packet.MsgId != UpdateServerInfoReq.Descriptor.Name &&
-                        packet.MsgId != UpdateServerInfoRes.Descriptor.Name)
-                    {
-                        _log.Trace(() => $"recvFrom:{packet.RouteHeader.From} - [packetInfo:${packet.RouteHeader}]");
-                    }
-
-                    _listener!.OnReceive(packet);
-                }
-                catch (Exception e)
-                {
-                    _log.Error(() => $"{playSocket.Id()} Error during communication - {e.Message}");
-                }
+            _poller.StopAsync();
+        }
+    }
 
+    private void OnReceiveReady()
+    {
+        for (var i = 0; i < ConstOption.CommunicatorBatchSize; i++)
+        {
+            RoutePacket? packet;
+            try
+            {
                 packet = playSocket.Receive();
             }
+            catch (Exception e)
+            {
+                // only the broken message is dropped, the poller keeps running
+                _log.Error(() => $"{playSocket.Id()} invalid message is dropped - {e}");
+                continue;
+            }
+
+            if (packet == null)
+            {
+                return;
+            }
 
-            Thread.Sleep(ConstOption.ThreadSleep);
+            Dispatch(packet);
         }
     }
 
-    public void Stop()
+    private void Dispatch(RoutePacket packet)
     {
-        _running = false;
+        try
+        {
+            if (packet.MsgId != UpdateServerInfoReq.Descriptor.Name &&
+                packet.MsgId != UpdateServerInfoRes.Descriptor.Name)
+            {
+                _log.Trace(() => $"recvFrom:{packet.RouteHeader.From} - [packetInfo:${packet.RouteHeader}]");
+            }
+
+            _listener!.OnReceive(packet);
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => $"{playSocket.Id()} Error during communication - {e.Message}");
+        }
     }
 }
\ No newline at end of file
@@ -10,6 +10,7 @@ internal class XServerInfo : IServerInfo
     private readonly ushort _serviceId;
     private readonly ServiceType _serviceType;
     private int _actorCount;
+    private int _load;
     private long _lastUpdate;
     private ServerState _serverState;
 
@@ -19,7 +20,8 @@ internal class XServerInfo : IServerInfo
         ushort serviceId,
         ServerState state,
         int actorCount,
-        long lastUpdate)
+        long lastUpdate,
+        int load = 0)
     {
         _bindEndpoint = bindEndpoint;
         _serviceType = serviceType;
@@ -27,6 +29,7 @@ internal class XServerInfo : IServerInfo
         _serverState = state;
         _actorCount = actorCount;
         _lastUpdate = lastUpdate;
+        _load = load;
     }
 
     public string GetBindEndpoint()
@@ -59,6 +62,11 @@ internal class XServerInfo : IServerInfo
         return _actorCount;
     }
 
+    public int GetLoad()
+    {
+        return _load;
+    }
+
     public static XServerInfo Of(string bindEndpoint, IService service)
     {
         return new XServerInfo(
@@ -79,7 +87,8 @@ internal class XServerInfo : IServerInfo
             (ushort)infoMsg.ServiceId,
             Enum.Parse<ServerState>(infoMsg.ServerState),
             infoMsg.ActorCount,
-            infoMsg.Timestamp
+            infoMsg.Timestamp,
+            infoMsg.Load
         );
     }
 
@@ -108,7 +117,8 @@ internal class XServerInfo : IServerInfo
             serverInfo.GetServiceId(),
             serverInfo.GetState(),
             serverInfo.GetActorCount(),
-            serverInfo.GetLastUpdate());
+            serverInfo.GetLastUpdate(),
+            serverInfo.GetLoad());
     }
 
     public ServerInfoMsg ToMsg()
@@ -120,7 +130,8 @@ internal class XServerInfo : IServerInfo
             Endpoint = _bindEndpoint,
             ServerState = _serverState.ToString(),
             Timestamp = _lastUpdate,
-            ActorCount = _actorCount
+            ActorCount = _actorCount,
+            Load = _load
         };
     }
 
@@ -131,7 +142,7 @@ internal class XServerInfo : IServerInfo
 
     public bool Update(XServerInfo serverInfo)
     {
-        var stateChanged = GetState != serverInfo.GetState;
+        var stateChanged = GetState() != serverInfo.GetState();
 
         _serverState = serverInfo.GetState();
 
@@ -139,6 +150,8 @@ internal class XServerInfo : IServerInfo
 
         _actorCount = serverInfo.GetActorCount();
 
+        _load = serverInfo.GetLoad();
+
         return stateChanged;
     }
 
@@ -167,7 +180,7 @@ internal class XServerInfo : IServerInfo
     public override string ToString()
     {
         return
-            $"[endpoint: {GetBindEndpoint}, service type: {GetServiceType}, serviceId: {GetServiceId}, state: {GetState}, actor count: {GetActorCount}, GetLastUpdate: {GetLastUpdate}]";
+            $"[endpoint: {GetBindEndpoint}, service type: {GetServiceType}, serviceId: {GetServiceId}, state: {GetState}, actor count: {GetActorCount}, load: {GetLoad}, GetLastUpdate: {GetLastUpdate}]";
     }
 
     internal void SetState(ServerState state)
@@ -3,24 +3,18 @@ using PlayHouse.Production.Shared;
 
 namespace PlayHouse.Communicator;
 
-internal class XServerInfoCenter : IServerInfoCenter
+internal class XServerInfoCenter(ServerSelectStrategy strategy = ServerSelectStrategy.RoundRobin) : IServerInfoCenter
 {
     private readonly IDictionary<string, XServerInfo> _serverInfoMap = new ConcurrentDictionary<string, XServerInfo>();
     private int _offset;
-    private List<XServerInfo> _serverInfoList = new();
+
+    // lookups read the current table without a lock, Update swaps in a new table only when something actually changed
+    private volatile RoutingTable _table = RoutingTable.Empty;
 
     public IList<XServerInfo> Update(IList<XServerInfo> serverList)
     {
-        //var serverInfoMap = new ConcurrentDictionary<string, XServerInfo>();
-        //foreach (XServerInfo serverInfo in serverList)
-        //{
-        //    serverInfo.CheckTimeout();
-        //    _serverInfoMap.Add(serverInfo.GetBindEndpoint,serverInfo);
-        //}
-        //_serverInfoMap = serverInfoMap;
-        //_serverInfoList = _serverInfoMap.Values.ToList().OrderBy(x => x.GetBindEndpoint).ToList();
-        //return _serverInfoList;
         var updatedMap = new Dictionary<string, XServerInfo>();
+        var changed = false;
         foreach (var newInfo in serverList)
         {
             newInfo.CheckTimeout();
@@ -30,34 +24,32 @@ internal class XServerInfoCenter : IServerInfoCenter
                 if (oldInfo.Update(newInfo))
                 {
                     updatedMap[newInfo.GetBindEndpoint()] = newInfo;
+                    changed = true;
                 }
             }
             else
             {
                 _serverInfoMap[newInfo.GetBindEndpoint()] = newInfo;
                 updatedMap[newInfo.GetBindEndpoint()] = newInfo;
+                changed = true;
             }
         }
 
         // Remove server info if it's not in the list
-        foreach (var oldInfo in _serverInfoMap.Values.ToList())
+        foreach (var oldInfo in _serverInfoMap.Values)
         {
+            var wasValid = oldInfo.IsValid();
             if (oldInfo.CheckTimeout())
             {
                 updatedMap[oldInfo.GetBindEndpoint()] = oldInfo;
+                changed |= wasValid;
             }
-
-            //if (!serverList.Contains(oldInfo))
-            //{
-            //    _serverInfoMap.Remove(oldInfo.GetBindEndpoint);
-            //    if (oldInfo.CheckTimeout())
-            //    {
-            //        updatedMap[oldInfo.GetBindEndpoint] = oldInfo;
-            //    }
-            //}
         }
 
-        _serverInfoList = _serverInfoMap.Values.ToList().OrderBy(x => x.GetBindEndpoint()).ToList();
+        if (changed)
+        {
+            _table = new RoutingTable(_serverInfoMap.Values);
+        }
 
         return updatedMap.Values.ToList();
     }
@@ -74,11 +66,9 @@ internal class XServerInfoCenter : IServerInfoCenter
 
     public XServerInfo FindRoundRobinServer(ushort serviceId)
     {
-        var list = _serverInfoList
-            .Where(x => x.GetState() == ServerState.RUNNING && x.GetServiceId() == serviceId)
-            .ToList();
+        var list = _table.RunningOf(serviceId);
 
-        if (!list.Any())
+        if (list.Length == 0)
         {
             throw new CommunicatorException.NotExistServerInfo($"serviceId:{serviceId} , ServerInfo is not exist");
         }
@@ -89,41 +79,133 @@ internal class XServerInfoCenter : IServerInfoCenter
             next *= next * -1;
         }
 
-        var index = next % list.Count;
+        var index = next % list.Length;
         return list[index];
     }
 
+    public XServerInfo FindServerBy(ushort serviceId)
+    {
+        return FindServerBy(serviceId, strategy);
+    }
+
+    public XServerInfo FindServerBy(ushort serviceId, ServerSelectStrategy selectStrategy)
+    {
+        if (selectStrategy == ServerSelectStrategy.RoundRobin)
+        {
+            return FindRoundRobinServer(serviceId);
+        }
+
+        var list = _table.RunningOf(serviceId);
+
+        if (list.Length == 0)
+        {
+            throw new CommunicatorException.NotExistServerInfo($"serviceId:{serviceId} , ServerInfo is not exist");
+        }
+
+        return selectStrategy switch
+        {
+            ServerSelectStrategy.LeastActor => ServerSelector.LeastActor(list),
+            ServerSelectStrategy.PowerOfTwoChoices => ServerSelector.PowerOfTwoChoices(list),
+            ServerSelectStrategy.WeightedLoad => ServerSelector.WeightedLoad(list),
+            _ => throw new ArgumentOutOfRangeException(nameof(selectStrategy), selectStrategy, null)
+        };
+    }
+
     public IList<XServerInfo> GetServerList()
     {
-        return _serverInfoList;
+        return _table.All;
     }
 
+    // rendezvous hashing, when a server joins or leaves only the accounts of that server move
     public XServerInfo FindServerByAccountId(ushort serviceId, long accountId)
     {
-        var list = _serverInfoList
-            .Where(info => info.GetState() == ServerState.RUNNING && info.GetServiceId() == serviceId)
-            .ToList();
+        var table = _table;
+        var list = table.RunningOf(serviceId);
 
-        if (list.Count == 0)
+        if (list.Length == 0)
         {
             throw new CommunicatorException.NotExistServerInfo($"serviceId:{serviceId} , ServerInfo is not exist");
         }
 
-        var index = (int)(accountId % list.Count);
-        return list[index];
+        var seeds = table.SeedsOf(serviceId);
+        var best = 0;
+        var bestScore = 0UL;
+        for (var i = 0; i < list.Length; i++)
+        {
+            var score = Mix((ulong)accountId ^ seeds[i]);
+            if (score >= bestScore)
+            {
+                best = i;
+                bestScore = score;
+            }
+        }
+
+        return list[best];
     }
 
     public ServiceType FindServerType(ushort serviceId)
     {
-        var list = _serverInfoList
-            .Where(info => info.GetServiceId() == serviceId)
-            .ToList();
-
-        if (list.Count == 0)
+        if (!_table.Types.TryGetValue(serviceId, out var serviceType))
         {
             throw new CommunicatorException.NotExistServerInfo($"serviceId:{serviceId} , ServerInfo is not exist");
         }
 
-        return list.First().GetServiceType();
+        return serviceType;
+    }
+
+    // splitmix64 finalizer
+    private static ulong Mix(ulong value)
+    {
+        value += 0x9E3779B97F4A7C15UL;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9UL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBUL;
+        return value ^ (value >> 31);
+    }
+
+    // must be the same on every node, so FNV-1a 64 instead of string.GetHashCode
+    private static ulong SeedOf(string endpoint)
+    {
+        var hash = 14695981039346656037UL;
+        foreach (var ch in endpoint)
+        {
+            hash = (hash ^ ch) * 1099511628211UL;
+        }
+
+        return hash;
+    }
+
+    private sealed class RoutingTable
+    {
+        public static readonly RoutingTable Empty = new(Array.Empty<XServerInfo>());
+
+        private readonly Dictionary<ushort, XServerInfo[]> _running = new();
+        private readonly Dictionary<ushort, ulong[]> _seeds = new();
+
+        public RoutingTable(IEnumerable<XServerInfo> serverInfos)
+        {
+            All = serverInfos.OrderBy(x => x.GetBindEndpoint(), StringComparer.Ordinal).ToArray();
+
+            foreach (var group in All.GroupBy(x => x.GetServiceId()))
+            {
+                Types[group.Key] = group.First().GetServiceType();
+
+                var running = group.Where(x => x.GetState() == ServerState.RUNNING).ToArray();
+                _running[group.Key] = running;
+                _seeds[group.Key] = running.Select(x => SeedOf(x.GetBindEndpoint())).ToArray();
+            }
+        }
+
+        public XServerInfo[] All { get; }
+        public Dictionary<ushort, ServiceType> Types { get; } = new();
+
+        public XServerInfo[] RunningOf(ushort serviceId)
+        {
+            return _running.GetValueOrDefault(serviceId) ?? Array.Empty<XServerInfo>();
+        }
+
+        public ulong[] SeedsOf(ushort serviceId)
+        {
+            return _seeds.GetValueOrDefault(serviceId) ?? Array.Empty<ulong>();
+        }
     }
 }
\ No newline at end of file
@@ -5,4 +5,15 @@ namespace PlayHouse.Production.Api;
 public class ApiOption
 {
     public ApiControllAspectifyManager AspectifyManager { get; } = new();
+
+    // when acting as address server, the threshold for marking a server with missing heartbeats DISABLE (phi accrual)
+    public double FailurePhiThreshold { get; set; } = 8.0;
+    public long FailureAcceptablePauseMs { get; set; } = 3000;
+
+    // evicts the actor of an account with no packets and nothing in progress for this long, 0 disables eviction
+    public int ActorIdleTimeoutSec { get; set; } = 300;
+
+    // how many unauthenticated (accountId 0) requests run at once and how many may wait, overflowing requests get SERVER_BUSY
+    public int UnauthenticatedConcurrency { get; set; } = Environment.ProcessorCount * 4;
+    public int UnauthenticatedQueueCapacity { get; set; } = 10000; // 0 means unbounded
 }
\ No newline at end of file
@@ -4,6 +4,7 @@ namespace PlayHouse.Production.Api.Aspectify;
 
 public class Invocation
 {
+    private readonly Func<Invocation, Task>[]? _chain;
     private readonly List<AspectifyAttribute> _interceptors;
     private readonly object _target;
     private int _currentInterceptorIndex = -1;
@@ -22,6 +23,18 @@ public class Invocation
         ServiceProvider = serviceProvider;
     }
 
+    // chain : filter -> handler call order built at registration, the filter list is not looked at per request
+    internal Invocation(
+        object target,
+        MethodInfo method,
+        object[] arguments,
+        IServiceProvider serviceProvider,
+        Func<Invocation, Task>[] chain)
+        : this(target, method, arguments, [], serviceProvider)
+    {
+        _chain = chain;
+    }
+
     public dynamic? ReturnValue { get; private set; }
 
     public MethodInfo Method { get; }
@@ -30,27 +43,45 @@ public class Invocation
 
     public IServiceProvider ServiceProvider { get; }
 
-    public async Task Proceed()
+    public Task Proceed()
     {
         _currentInterceptorIndex++;
-        if (_currentInterceptorIndex < _interceptors.Count)
+        if (_chain != null)
+        {
+            return _currentInterceptorIndex < _chain.Length
+                ? _chain[_currentInterceptorIndex](this)
+                : Task.CompletedTask;
+        }
+
+        return _currentInterceptorIndex < _interceptors.Count
+            ? _interceptors[_currentInterceptorIndex].Intercept(this)
+            : InvokeMethod();
+    }
+
+    // end of the chain, calls the compiled handler
+    internal async Task InvokeTarget(Func<object, object[], Task> invoker, Func<Task, object?>? resultOf)
+    {
+        var task = invoker(_target, Arguments);
+        await task;
+        if (resultOf != null)
+        {
+            ReturnValue = resultOf(task);
+        }
+    }
+
+    internal async Task InvokeMethod()
+    {
+        var returnType = Method.ReturnType;
+
+        if (returnType == typeof(Task))
         {
-            await _interceptors[_currentInterceptorIndex].Intercept(this);
+            // 반환 타입이 void
+            await (Task)Method.Invoke(_target, Arguments)!;
         }
         else
         {
-            var returnType = Method.ReturnType;
-
-            if (returnType == typeof(Task))
-            {
-                // 반환 타입이 void
-                await (Task)Method.Invoke(_target, Arguments)!;
-            }
-            else
-            {
-                // 반환 타입이 void가 아님
-                ReturnValue = await (dynamic)Method.Invoke(_target, Arguments)!;
-            }
+            // 반환 타입이 void가 아님
+            ReturnValue = await (dynamic)Method.Invoke(_target, Arguments)!;
         }
     }
 }
\ No newline at end of file
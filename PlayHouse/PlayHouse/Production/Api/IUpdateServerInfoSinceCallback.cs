@@ -0,0 +1,10 @@
+﻿using PlayHouse.Production.Shared;
+
+namespace PlayHouse.Production.Api;
+
+// when implemented, each heartbeat reads only the servers updated after sinceTimestamp instead of the full list
+// the full list is still read periodically through IUpdateServerInfoCallback to find servers that left
+public interface IUpdateServerInfoSinceCallback
+{
+    Task<List<IServerInfo>> UpdateServerInfoSinceAsync(IServerInfo serverInfo, long sinceTimestamp);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+﻿using PlayHouse.Production.Shared;
+
+namespace PlayHouse.Production.Play;
+
+// an actor's packet received since the last frame, disposed when the frame ends
+public readonly struct StageInput(IActor actor, IPacket packet)
+{
+    public IActor Actor { get; } = actor;
+    public IPacket Packet { get; } = packet;
+}
+
+/// <summary>
+///     Stage driven by a fixed-rate game loop.
+///     Actor packets arrive at once through OnInputs every frame instead of OnDispatch, followed by OnTick.
+///     Packets sent to clients during a frame are gathered and sent per session server when the frame ends.
+/// </summary>
+public interface IGameLoopStage : IStage
+{
+    // frames per second
+    public int TickRate { get; }
+
+    public Task OnInputs(IReadOnlyList<StageInput> inputs);
+
+    // deltaTime : actual time from the start of the previous frame to the start of this one
+    public Task OnTick(TimeSpan deltaTime);
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+﻿namespace PlayHouse.Production.Play;
+
+// a stage that can move to another play server, moved with IStageSender.MigrateStage or PlayServer.DrainAsync
+// on the target OnRestore is called instead of OnCreate and OnPostCreate
+public interface IMigratableStage : IStage
+{
+    Task<byte[]> OnSnapshot();
+
+    // actors are the actors recreated on the target
+    // timers are canceled on the source since callbacks cannot move, register them again here from the remaining time and count
+    Task OnRestore(byte[] snapshot, IReadOnlyList<IActor> actors, IReadOnlyList<MigratedTimer> timers);
+}
+
+// actors that do not implement it are created fresh on the target through OnCreate
+public interface IMigratableActor : IActor
+{
+    Task<byte[]> OnSnapshot();
+    Task OnRestore(byte[] snapshot);
+}
+
+public class MigratedTimer(long timerId, TimeSpan remainingDelay, TimeSpan period, int remainingCount)
+{
+    // the id used on the source, registering again on the target gives a new id
+    public long TimerId { get; } = timerId;
+    public TimeSpan RemainingDelay { get; } = remainingDelay;
+    public TimeSpan Period { get; } = period;
+
+    // remaining count of a count timer, 0 for a repeat timer
+    public int RemainingCount { get; } = remainingCount;
+
+    public bool IsRepeat => RemainingCount == 0;
+}
\ No newline at end of file
@@ -1,6 +1,26 @@
 ﻿namespace PlayHouse.Production.Play;
 
+public enum StageSchedulerMode
+{
+    ThreadPool, // stages run with Task.Run whenever a message arrives
+    Dedicated // stages run on dedicated worker threads, pinned to one worker, an idle worker takes over a backlog
+}
+
 public class PlayOption
 {
     public PlayProducer PlayProducer { get; } = new();
+
+    public StageSchedulerMode SchedulerMode { get; set; } = StageSchedulerMode.ThreadPool;
+    public int SchedulerWorkerCount { get; set; } = Environment.ProcessorCount;
+
+    // max messages a stage handles in one turn before yielding its worker, 0 means no limit
+    public int SchedulerBatchQuantum { get; set; } = 0;
+
+    // gives every stage a SynchronizationContext that sends handler await continuations back through the stage mailbox
+    // other packets can be handled while a request is awaited (they interleave only at await points)
+    public bool UseStageContext { get; set; }
+
+    // how long packets to a stage that moved away are forwarded to the target, until session and api servers learn the new endpoint
+    // also how long the target waits for the source's commit, must be longer than RequestTimeoutSec
+    public int MigrationForwardSec { get; set; } = 30;
 }
\ No newline at end of file
@@ -4,7 +4,36 @@ public class SessionOption
 {
     public int ClientIdleTimeoutMSec = 30000; //5000  0인경우 idle확인 안함
 
+    // disconnects any session, authenticated or not, that receives nothing (heartbeat included) for this long, 0 disables the check
+    public int HeartBeatTimeoutMSec { get; set; } = 0;
+
     public List<string> Urls { get; set; } = new();
     public int SessionPort { get; set; } = 0;
     public bool UseWebSocket { get; set; } = false;
+
+    // exchanges websocket binary messages (browser clients), false reads a raw tcp stream without a handshake
+    // with send batching on, the frames gathered per flush go out as one binary message
+    public bool WebSocketBinaryMode { get; set; } = false;
+
+    // UDP session network, opens SessionPort over udp
+    // request/reply go reliable-ordered, pushes listed in UdpUnreliableMsgIds go unreliable-sequenced
+    public bool UseUdp { get; set; } = false;
+    public List<string> UdpUnreliableMsgIds { get; set; } = new();
+    public int UdpTimeoutMSec { get; set; } = 10000; // disconnects when nothing is received for this long
+    public int UdpMaxConnectsPerSourceSec { get; set; } = 20; // sessions one ip can create per second
+
+    // tcp, websocket session send batching, 0 sends every frame right away
+    // frames are sent at once when SendFlushBytes have gathered or SendFlushMicros have passed
+    // sub-millisecond delays are kept by spinning the flush thread for the last millisecond
+    public int SendFlushBytes { get; set; } = 0;
+    public int SendFlushMicros { get; set; } = 500;
+
+    // packets a session may send per second, 0 means no limit
+    // requests beyond it get TOO_MANY_REQUESTS, with the Disconnect MailboxOverflowPolicy the session is disconnected
+    public int MaxPacketsPerSecond { get; set; } = 0;
+    public int PacketBurst { get; set; } = 0; // 0 means the same as MaxPacketsPerSecond
+
+    // compresses bodies to clients of this size or more, 0 disables compression
+    // applies only to sessions whose client asked with @Compression@, compressed requests are accepted whatever this is
+    public int CompressThreshold { get; set; } = 0;
 }
\ No newline at end of file
@@ -9,6 +9,15 @@ public enum ServerState
     DISABLE
 }
 
+// how ISystemPanel.GetServerInfoBy(serviceId) picks one of the servers of a serviceId
+public enum ServerSelectStrategy
+{
+    RoundRobin,
+    LeastActor, // the server with the fewest actors
+    PowerOfTwoChoices, // the one with fewer actors of two random servers, avoids piling onto one server between updates
+    WeightedLoad // the lower the load a server reports, the more likely it is picked
+}
+
 public interface IServerInfo
 {
     string GetBindEndpoint();
@@ -17,4 +26,5 @@ public interface IServerInfo
     ServerState GetState();
     long GetLastUpdate();
     int GetActorCount();
+    int GetLoad();
 }
\ No newline at end of file
@@ -7,6 +7,8 @@ internal interface IServerInfoCenter
     IList<XServerInfo> Update(IList<XServerInfo> serverList);
     XServerInfo FindServer(string endpoint);
     XServerInfo FindRoundRobinServer(ushort serviceId);
+    XServerInfo FindServerBy(ushort serviceId);
+    XServerInfo FindServerBy(ushort serviceId, ServerSelectStrategy strategy);
     IList<XServerInfo> GetServerList();
     XServerInfo FindServerByAccountId(ushort serviceId, long accountId);
     ServiceType FindServerType(ushort serviceId);
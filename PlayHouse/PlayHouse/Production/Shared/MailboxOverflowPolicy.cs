@@ -0,0 +1,10 @@
+﻿namespace PlayHouse.Production.Shared;
+
+// what happens when an actor mailbox goes over PlayhouseOption.MailboxCapacity
+// with any policy a dropped request is answered with SERVER_BUSY, system packets are never limited
+public enum MailboxOverflowPolicy
+{
+    DropOldest, // drops the oldest packet and queues the new one
+    Reject, // drops the new packet
+    Disconnect // disconnects sessions, same as Reject for stage and api actors
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
-﻿using PlayHouse.Communicator.Message;
+﻿using Google.Protobuf.Reflection;
+using PlayHouse.Communicator.Message;
 
 namespace PlayHouse.Production.Shared;
 
@@ -17,4 +18,29 @@ public class PlayhouseOption
     public ushort AddressServerServiceId { get; set; }
 
     public Func<string, IPayload, ushort, IPacket>? PacketProducer { get; set; }
+
+    // reuses RoutePacket and RouteHeader from a pool, debug mode detects use of returned packets (no reuse)
+    public bool UsePacketPool { get; set; }
+    public bool DebugPacketPool { get; set; }
+
+    // sends registered msgIds as their MsgIdRegistry numeric id, unregistered msgIds go as strings
+    // receivers accept both forms whatever the mode, contents protos are registered through MsgIdDescriptors
+    public bool UseNumericMsgId { get; set; }
+    public List<FileDescriptor> MsgIdDescriptors { get; set; } = [];
+
+    // how GetServerInfoBy(serviceId) and api requests before authentication pick their target server
+    public ServerSelectStrategy ServerSelectStrategy { get; set; } = ServerSelectStrategy.RoundRobin;
+
+    // packets one stage, api or session actor mailbox can hold, 0 means unbounded
+    public int MailboxCapacity { get; set; }
+    public MailboxOverflowPolicy MailboxOverflowPolicy { get; set; } = MailboxOverflowPolicy.DropOldest;
+
+    // packets that can wait to be sent to the backbone, beyond it they are dropped, 0 means unbounded
+    public int SendQueueCapacity { get; set; }
+
+    // servers started in the same process pass packets without the socket or serialization, both sides must enable it
+    public bool UseLocalTransport { get; set; }
+
+    // compresses backbone bodies of this size or more, 0 disables it, receivers decompress whatever this is
+    public int CompressThreshold { get; set; }
 }
\ No newline at end of file
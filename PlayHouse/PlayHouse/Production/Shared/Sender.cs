@@ -1,4 +1,5 @@
-﻿using PlayHouse.Service.Shared;
+﻿using PlayHouse.Production.Play;
+using PlayHouse.Service.Shared;
 
 namespace PlayHouse.Production.Shared;
 
@@ -8,6 +9,7 @@ public interface ISystemPanel
 {
     IServerInfo GetServerInfo();
     IServerInfo GetServerInfoBy(ushort serviceId);
+    IServerInfo GetServerInfoBy(ushort serviceId, ServerSelectStrategy strategy);
     IServerInfo GetServerInfoBy(ushort serviceId, long accountId);
     IServerInfo GetServerInfoByEndpoint(string endpoint);
     IList<IServerInfo> GetServers();
@@ -16,6 +18,16 @@ public interface ISystemPanel
     Task ShutdownASync();
     ServerState GetServerState();
     long GenerateUUID();
+
+    // reserves a block of ids when creating many stages or entities at once, at most UniqueIdGenerator.MaxBlockSize
+    // the default implementation issues one at a time so existing implementations keep working
+    void GenerateUUIDs(Span<long> destination)
+    {
+        for (var i = 0; i < destination.Length; i++)
+        {
+            destination[i] = GenerateUUID();
+        }
+    }
 }
 
 public interface ISender
@@ -93,6 +105,14 @@ public interface IStageSender : ISender
     void CloseStage();
 
     void AsyncBlock(AsyncPreCallback preCallback, AsyncPostCallback? postCallback = null);
+
+    // only IMigratableStage stages move, without a targetEndpoint a play server with low load is picked
+    // starts on the stage thread after the current handler returns
+    void MigrateStage(string? targetEndpoint = null);
+
+    // the payload is serialized once and sent as one packet per session server
+    void Broadcast(IEnumerable<IActor> actors, IPacket packet);
+    void BroadcastAll(IPacket packet);
 }
 
 public interface IApiBackendSender : IApiCommonSender
@@ -1,5 +1,4 @@
-﻿using System.Collections.Concurrent;
-using PlayHouse.Communicator;
+﻿using PlayHouse.Communicator;
 using PlayHouse.Communicator.Message;
 using Playhouse.Protocol;
 using PlayHouse.Service.Api.Reflection;
@@ -15,10 +14,17 @@ internal class ApiActor(
     ApiReflection apiReflection,
     ApiReflectionCallback apiReflectionCallback)
 {
-    private readonly AtomicBoolean _isUsing = new(false);
     private readonly LOG<ApiActor> _log = new();
 
-    private readonly ConcurrentQueue<RoutePacket> _msgQueue = new();
+    private readonly Mailbox _mailbox = new(serviceId, clientCommunicator);
+    private int _isUsing;
+    private long _lastPostedMs = Environment.TickCount64;
+
+    private const int Evicting = -2;
+    private const int Evicted = -1;
+
+    // 0 or more is the number of threads in Post, Evicting while checking whether it can be evicted, Evicted once removed from the registry
+    private int _state;
 
     public async Task DispatchAsync(RoutePacket routePacket)
     {
@@ -55,13 +61,21 @@ internal class ApiActor(
             }
             else
             {
-                if (routeHeader.IsBackend)
+                var start = PlayMetrics.StartTimestamp(PlayMetrics.HandlerDuration);
+                try
                 {
-                    await apiReflection.CallBackendMethodAsync(routePacket.ToContentsPacket(), apiSender);
+                    if (routeHeader.IsBackend)
+                    {
+                        await apiReflection.CallBackendMethodAsync(routeHeader.Header.MsgNum, routePacket.ToContentsPacket(), apiSender);
+                    }
+                    else
+                    {
+                        await apiReflection.CallMethodAsync(routeHeader.Header.MsgNum, routePacket.ToContentsPacket(), apiSender);
+                    }
                 }
-                else
+                finally
                 {
-                    await apiReflection.CallMethodAsync(routePacket.ToContentsPacket(), apiSender);
+                    PlayMetrics.RecordHandler(start, "api", routeHeader.MsgId);
                 }
             }
         }
@@ -102,23 +116,97 @@ internal class ApiActor(
         }
     }
 
+    internal int QueueCount => _mailbox.Count;
+    internal bool IsEvicted => Volatile.Read(ref _state) == Evicted;
+
+    // false for an evicted actor, the packet stays untouched so the caller sends it to a new actor
+    public bool TryPost(RoutePacket packet)
+    {
+        var spin = new SpinWait();
+        while (true)
+        {
+            var state = Volatile.Read(ref _state);
+            if (state == Evicted)
+            {
+                return false;
+            }
+
+            if (state == Evicting)
+            {
+                // the check finishes quickly
+                spin.SpinOnce();
+                continue;
+            }
+
+            if (Interlocked.CompareExchange(ref _state, state + 1, state) == state)
+            {
+                break;
+            }
+        }
+
+        try
+        {
+            Volatile.Write(ref _lastPostedMs, Environment.TickCount64);
+            Post(packet);
+            return true;
+        }
+        finally
+        {
+            Interlocked.Decrement(ref _state);
+        }
+    }
+
+    // marks it evicted only when idle, with an empty mailbox and no packet in progress
+    public bool TryEvict(long nowMs, int idleTimeoutMs)
+    {
+        if (nowMs - Volatile.Read(ref _lastPostedMs) < idleTimeoutMs || !IsDrained())
+        {
+            return false;
+        }
+
+        if (Interlocked.CompareExchange(ref _state, Evicting, 0) != 0)
+        {
+            return false;
+        }
+
+        // backs out if a Post that finished before the gate closed left a packet
+        var drained = IsDrained();
+        Volatile.Write(ref _state, drained ? Evicted : 0);
+        return drained;
+    }
+
+    private bool IsDrained()
+    {
+        return _mailbox.IsEmpty && Volatile.Read(ref _isUsing) == 0;
+    }
+
     public void Post(RoutePacket packet)
     {
-        _msgQueue.Enqueue(packet);
+        PlayMetrics.OnPosted(packet);
+        if (!_mailbox.Post(packet))
+        {
+            return;
+        }
 
-        if (_isUsing.CompareAndSet(false, true))
+        if (Interlocked.CompareExchange(ref _isUsing, 1, 0) == 0)
         {
             Task.Run(async () =>
             {
-                while (_msgQueue.TryDequeue(out var routePacket))
+                do
                 {
-                    using (routePacket)
+                    while (_mailbox.TryDequeue(out var routePacket))
                     {
-                        await DispatchAsync(routePacket);
+                        PlayMetrics.OnDequeued(routePacket, "api");
+                        using (routePacket)
+                        {
+                            await DispatchAsync(routePacket);
+                        }
                     }
-                }
 
-                _isUsing.Set(false);
+                    Volatile.Write(ref _isUsing, 0);
+
+                    // looks once more so a packet that arrived while leaving is not stranded in the mailbox
+                } while (!_mailbox.IsEmpty && Interlocked.CompareExchange(ref _isUsing, 1, 0) == 0);
             });
         }
     }
@@ -0,0 +1,80 @@
+﻿using System.Collections.Concurrent;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Utils;
+
+namespace PlayHouse.Service.Api;
+
+/// <summary>
+///     ApiActor per accountId, the packets of one account are always handled in order on the same actor.
+///     Only actors with no packets for idleTimeoutMs, an empty mailbox and nothing in progress are evicted.
+///     A packet that reaches an actor being evicted is sent again to a new actor, an account never has two actors.
+/// </summary>
+internal class ApiActorRegistry : IDisposable
+{
+    private readonly ConcurrentDictionary<long, ApiActor> _actors = new();
+    private readonly Func<long, ApiActor> _factory;
+    private readonly int _idleTimeoutMs;
+    private readonly LOG<ApiActorRegistry> _log = new();
+    private readonly Timer? _timer;
+
+    // an idleTimeoutMs of 0 disables eviction
+    public ApiActorRegistry(Func<long, ApiActor> factory, int idleTimeoutMs)
+    {
+        _factory = factory;
+        _idleTimeoutMs = idleTimeoutMs;
+        if (idleTimeoutMs > 0)
+        {
+            var period = Math.Clamp(idleTimeoutMs / 4, 100, 10000);
+            _timer = new Timer(_ => Evict(Environment.TickCount64), null, period, period);
+        }
+    }
+
+    public int Count => _actors.Count;
+
+    public long QueueCount => _actors.Values.Sum(e => (long)e.QueueCount);
+
+    public void Dispose()
+    {
+        _timer?.Dispose();
+    }
+
+    public ApiActor? Find(long accountId)
+    {
+        return _actors.GetValueOrDefault(accountId);
+    }
+
+    public void Post(long accountId, RoutePacket routePacket)
+    {
+        while (true)
+        {
+            var actor = _actors.GetOrAdd(accountId, _factory);
+            if (actor.TryPost(routePacket))
+            {
+                return;
+            }
+
+            // an actor that was just evicted, its entry is removed and a new one created
+            _actors.TryRemove(new KeyValuePair<long, ApiActor>(accountId, actor));
+        }
+    }
+
+    internal int Evict(long nowMs)
+    {
+        var evicted = 0;
+        foreach (var (accountId, actor) in _actors)
+        {
+            if (actor.TryEvict(nowMs, _idleTimeoutMs) &&
+                _actors.TryRemove(new KeyValuePair<long, ApiActor>(accountId, actor)))
+            {
+                evicted++;
+            }
+        }
+
+        if (evicted > 0)
+        {
+            _log.Debug(() => $"idle api actors are evicted - [count:{evicted},remain:{_actors.Count}]");
+        }
+
+        return evicted;
+    }
+}
\ No newline at end of file
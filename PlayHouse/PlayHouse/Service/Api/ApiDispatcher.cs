@@ -1,9 +1,8 @@
-﻿using System.Collections.Specialized;
-using System.Runtime.Caching;
-using Microsoft.Extensions.DependencyInjection;
+﻿using Microsoft.Extensions.DependencyInjection;
 using PlayHouse.Communicator;
 using PlayHouse.Communicator.Message;
 using PlayHouse.Production.Api;
+using PlayHouse.Production.Shared;
 using Playhouse.Protocol;
 using PlayHouse.Service.Api.Reflection;
 using PlayHouse.Service.Shared;
@@ -13,14 +12,21 @@ namespace PlayHouse.Service.Api;
 
 internal class ApiDispatcher
 {
+    private const long FullReadPeriodMs = 10 * 1000;
+    private const long SinceSlackMs = 500; // clock skew between servers
+
     private readonly ApiReflection _apiReflection;
     private readonly ApiReflectionCallback _apiReflectionCallback;
-    private readonly MemoryCache _cache;
+    private readonly ApiActorRegistry _actors;
     private readonly IClientCommunicator _clientCommunicator;
     private readonly LOG<ApiService> _log = new();
-    private readonly CacheItemPolicy _policy;
+    private readonly MembershipBook _membershipBook;
+    private readonly IDisposable _mailboxMetric;
     private readonly RequestCache _requestCache;
     private readonly ushort _serviceId;
+    private readonly ApiWorkerPool _unauthenticated;
+    private long _lastFullReadAt;
+    private long _lastReadAt;
 
     public ApiDispatcher(
         ushort serviceId,
@@ -35,19 +41,27 @@ internal class ApiDispatcher
         _clientCommunicator = clientCommunicator;
         _apiReflection = new ApiReflection(serviceProvider, apiOption.AspectifyManager);
         _apiReflectionCallback = new ApiReflectionCallback(serviceProvider);
+        _membershipBook = new MembershipBook(apiOption.FailurePhiThreshold, apiOption.FailureAcceptablePauseMs);
 
 
         var controllerTester = serviceProvider.GetService<ControllerTester>();
         controllerTester?.Init(_apiReflection, _apiReflectionCallback);
-        
 
-        _policy = new CacheItemPolicy { SlidingExpiration = TimeSpan.FromMinutes(5) };
-        var cacheSettings = new NameValueCollection
-        {
-            { "CacheMemoryLimitMegabytes", "10" },
-            { "PhysicalMemoryLimitPercentage", "1" }
-        };
-        _cache = new MemoryCache("ApiService", cacheSettings);
+        _actors = new ApiActorRegistry(_ => new ApiActor(
+            _serviceId,
+            _requestCache,
+            _clientCommunicator,
+            _apiReflection,
+            _apiReflectionCallback
+        ), apiOption.ActorIdleTimeoutSec * 1000);
+
+        _unauthenticated = new ApiWorkerPool(
+            new Mailbox(serviceId, clientCommunicator, apiOption.UnauthenticatedQueueCapacity,
+                MailboxOverflowPolicy.Reject),
+            Math.Max(1, apiOption.UnauthenticatedConcurrency),
+            DispatchAsync);
+
+        _mailboxMetric = PlayMetrics.ObserveMailbox("api", () => _actors.QueueCount + _unauthenticated.QueueCount);
     }
 
     public void Start()
@@ -56,12 +70,14 @@ internal class ApiDispatcher
 
     public void Stop()
     {
+        _actors.Dispose();
+        _mailboxMetric.Dispose();
     }
 
 
     internal int GetAccountCount()
     {
-        return _cache.Count();
+        return _actors.Count;
     }
 
     internal void OnPost(RoutePacket routePacket)
@@ -72,26 +88,11 @@ internal class ApiDispatcher
 
             if (routeHeader.AccountId != 0)
             {
-                var apiActor = (ApiActor?)_cache.Get($"{routeHeader.AccountId}");
-                if (apiActor == null)
-                {
-                    apiActor = new ApiActor
-                    (
-                        _serviceId,
-                        _requestCache,
-                        _clientCommunicator,
-                        _apiReflection,
-                        _apiReflectionCallback
-                    );
-
-                    _cache.Add(new CacheItem(routeHeader.AccountId.ToString(), apiActor), _policy);
-                }
-
-                apiActor.Post(RoutePacket.MoveOf(routePacket));
+                _actors.Post(routeHeader.AccountId, RoutePacket.MoveOf(routePacket));
             }
             else
             {
-                Task.Run(async () => { await DispatchAsync(RoutePacket.MoveOf(routePacket)); });
+                _unauthenticated.Post(RoutePacket.MoveOf(routePacket));
             }
         }
     }
@@ -107,22 +108,50 @@ internal class ApiDispatcher
             var updateServerInfoReq = UpdateServerInfoReq.Parser.ParseFrom(routePacket.Span);
 
             _clientCommunicator.Connect(updateServerInfoReq.ServerInfo.Endpoint);
-            var serverInfoList =
-                await _apiReflectionCallback.UpdateServerInfoAsync(XServerInfo.Of(updateServerInfoReq.ServerInfo));
-            UpdateServerInfoRes updateServerInfoRes = new();
-            updateServerInfoRes.ServerInfos.AddRange(serverInfoList.Select(e => XServerInfo.Of(e).ToMsg()));
+            var (serverInfoList, fullList) = await ReadServerInfoAsync(XServerInfo.Of(updateServerInfoReq.ServerInfo));
+            var updateServerInfoRes = _membershipBook.Apply(serverInfoList, updateServerInfoReq.Epoch,
+                updateServerInfoReq.Version, fullList);
             apiSender.Reply(XPacket.Of(updateServerInfoRes));
 
             return;
         }
 
-        if (routePacket.IsBackend())
+        var start = PlayMetrics.StartTimestamp(PlayMetrics.HandlerDuration);
+        try
         {
-            await _apiReflection.CallBackendMethodAsync(routePacket.ToContentsPacket(), apiSender);
+            if (routePacket.IsBackend())
+            {
+                await _apiReflection.CallBackendMethodAsync(routePacket.Header.MsgNum, routePacket.ToContentsPacket(), apiSender);
+            }
+            else
+            {
+                await _apiReflection.CallMethodAsync(routePacket.Header.MsgNum, routePacket.ToContentsPacket(), apiSender);
+            }
         }
-        else
+        finally
         {
-            await _apiReflection.CallMethodAsync(routePacket.ToContentsPacket(), apiSender);
+            PlayMetrics.RecordHandler(start, "api", routeHeader.MsgId);
         }
     }
+    // each heartbeat reads only servers updated since the last read instead of the whole store
+    // the full list is read once every FullReadPeriodMs to find servers that left
+    private async Task<(List<IServerInfo>, bool)> ReadServerInfoAsync(IServerInfo serverInfo)
+    {
+        if (!_apiReflectionCallback.CanUpdateServerInfoSince)
+        {
+            return (await _apiReflectionCallback.UpdateServerInfoAsync(serverInfo), true);
+        }
+
+        var now = DateTimeOffset.UtcNow.ToUnixTimeMilliseconds();
+        var lastFullReadAt = Interlocked.Read(ref _lastFullReadAt);
+        if (now - lastFullReadAt >= FullReadPeriodMs &&
+            Interlocked.CompareExchange(ref _lastFullReadAt, now, lastFullReadAt) == lastFullReadAt)
+        {
+            Interlocked.Exchange(ref _lastReadAt, now);
+            return (await _apiReflectionCallback.UpdateServerInfoAsync(serverInfo), true);
+        }
+
+        var since = Interlocked.Exchange(ref _lastReadAt, now) - SinceSlackMs;
+        return (await _apiReflectionCallback.UpdateServerInfoSinceAsync(serverInfo, since), false);
+    }
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 ﻿using CommonLib;
 using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
 using PlayHouse.Communicator.PlaySocket;
 using PlayHouse.Production.Api;
 using PlayHouse.Production.Shared;
+using PlayHouse.Service.Shared;
 
 namespace PlayHouse.Service.Api;
 
@@ -26,6 +28,7 @@ public class ApiServer : IServer
             .SetShowQps(_commonOption.ShowQps)
             .SetNodeId(_commonOption.NodeId)
             .SetPacketProducer(_commonOption.PacketProducer)
+            .SetUseLocalTransport(_commonOption.UseLocalTransport)
             .SetAddressServerEndpoints(_commonOption.AddressServerEndpoints)
             .SetAddressServerServiceId(_commonOption.AddressServerServiceId)
             .Build();
@@ -35,12 +38,18 @@ public class ApiServer : IServer
 
 
         PooledBuffer.Init(_commonOption.MaxBufferPoolSize);
+        PlaySocketFactory.InitBufferPool(_commonOption.MaxBufferPoolSize);
+        PacketPool.Init(_commonOption.UsePacketPool, _commonOption.DebugPacketPool);
+        MsgIdRegistry.Init(_commonOption.UseNumericMsgId, _commonOption.MsgIdDescriptors);
+        Mailbox.Init(_commonOption.MailboxCapacity, _commonOption.MailboxOverflowPolicy);
 
         var requestCache = new RequestCache(_commonOption.RequestTimeoutSec);
-        var serverInfoCenter = new XServerInfoCenter();
+        var serverInfoCenter = new XServerInfoCenter(_commonOption.ServerSelectStrategy);
 
         var communicateClient =
-            new XClientCommunicator(PlaySocketFactory.CreatePlaySocket(new SocketConfig(), bindEndpoint));
+            new XClientCommunicator(PlaySocketFactory.CreatePlaySocket(
+                    new SocketConfig { CompressThreshold = _commonOption.CompressThreshold }, bindEndpoint),
+                _commonOption.SendQueueCapacity, _commonOption.UseLocalTransport);
 
         var service = new ApiService(serviceId, _apiOption, requestCache, communicateClient,
             communicatorOption.ServiceProvider);
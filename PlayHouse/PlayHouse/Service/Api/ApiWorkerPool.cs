@@ -0,0 +1,77 @@
+﻿using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Service.Shared;
+using PlayHouse.Utils;
+
+namespace PlayHouse.Service.Api;
+
+/// <summary>
+///     Unauthenticated (accountId 0) api requests, they need no ordering so several workers share them.
+///     Running handlers are limited by concurrency and waiting packets by the mailbox capacity.
+///     The mailbox answers overflowing requests with SERVER_BUSY.
+/// </summary>
+internal class ApiWorkerPool(Mailbox mailbox, int concurrency, Func<RoutePacket, Task> dispatch)
+{
+    private readonly LOG<ApiWorkerPool> _log = new();
+    private int _workers;
+
+    public int QueueCount => mailbox.Count;
+    public int WorkerCount => Volatile.Read(ref _workers);
+
+    public void Post(RoutePacket routePacket)
+    {
+        PlayMetrics.OnPosted(routePacket);
+        if (!mailbox.Post(routePacket))
+        {
+            return;
+        }
+
+        if (TryAddWorker())
+        {
+            Task.Run(RunAsync);
+        }
+    }
+
+    private bool TryAddWorker()
+    {
+        while (true)
+        {
+            var workers = Volatile.Read(ref _workers);
+            if (workers >= concurrency)
+            {
+                return false;
+            }
+
+            if (Interlocked.CompareExchange(ref _workers, workers + 1, workers) == workers)
+            {
+                return true;
+            }
+        }
+    }
+
+    private async Task RunAsync()
+    {
+        do
+        {
+            while (mailbox.TryDequeue(out var routePacket))
+            {
+                PlayMetrics.OnDequeued(routePacket, "api");
+                using (routePacket)
+                {
+                    try
+                    {
+                        await dispatch(routePacket);
+                    }
+                    catch (Exception e)
+                    {
+                        _log.Error(() => $"api dispatch error - [packetInfo:{routePacket.RouteHeader}] - {e}");
+                    }
+                }
+            }
+
+            Interlocked.Decrement(ref _workers);
+
+            // a packet that arrived while leaving is picked up here when no other worker is running
+        } while (!mailbox.IsEmpty && TryAddWorker());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+﻿using PlayHouse.Communicator;
+using PlayHouse.Production.Shared;
+using Playhouse.Protocol;
+
+namespace PlayHouse.Service.Api;
+
+// cluster membership as seen by an api server acting as address server
+// every meaningful change bumps the version, a requester only gets the changes after the version it has
+// a different epoch (another address server, restart) or an already trimmed version gets the full list
+// small changes of actor count or load bump the version once every loadRefreshMs
+internal class MembershipBook(double phiThreshold, long acceptablePauseMs, long loadRefreshMs = 5000)
+{
+    private const long TombstoneKeepMs = 10 * 60 * 1000;
+
+    private readonly long _epoch = Random.Shared.NextInt64(1, long.MaxValue);
+    private readonly Dictionary<string, Entry> _entries = new();
+    private readonly object _lock = new();
+    private long _horizon;
+    private long _version;
+
+    // when fullList is false the list holds only recently updated servers from the store, so missing servers are not removed
+    public UpdateServerInfoRes Apply(IEnumerable<IServerInfo> serverInfos, long knownEpoch, long knownVersion,
+        bool fullList = true)
+    {
+        var now = DateTimeOffset.UtcNow.ToUnixTimeMilliseconds();
+
+        lock (_lock)
+        {
+            var seen = new HashSet<string>();
+            foreach (var serverInfo in serverInfos)
+            {
+                var info = XServerInfo.Of(serverInfo).ToMsg();
+                seen.Add(info.Endpoint);
+                Observe(info, now);
+            }
+
+            foreach (var (endpoint, entry) in _entries)
+            {
+                if (seen.Contains(endpoint) || entry.Removed)
+                {
+                    continue;
+                }
+
+                if (fullList)
+                {
+                    entry.Removed = true;
+                    entry.RemovedAt = now;
+                    entry.Info.ServerState = nameof(ServerState.DISABLE);
+                    entry.Version = ++_version;
+                }
+                else if (!entry.Detector.IsAvailable(now, phiThreshold) &&
+                         entry.Published.ServerState != nameof(ServerState.DISABLE))
+                {
+                    // its heartbeat stopped while it was missing from the list
+                    var info = entry.Info.Clone();
+                    info.ServerState = nameof(ServerState.DISABLE);
+                    Publish(entry, info, now);
+                }
+            }
+
+            Prune(now);
+
+            var res = new UpdateServerInfoRes { Epoch = _epoch, Version = _version };
+            res.Delta = knownEpoch == _epoch && knownVersion >= _horizon && knownVersion <= _version;
+            foreach (var entry in _entries.Values)
+            {
+                if (res.Delta ? entry.Version > knownVersion : !entry.Removed)
+                {
+                    res.ServerInfos.Add(entry.Info.Clone());
+                }
+            }
+
+            return res;
+        }
+    }
+
+    private void Observe(ServerInfoMsg info, long now)
+    {
+        if (!_entries.TryGetValue(info.Endpoint, out var entry))
+        {
+            entry = new Entry(info, new PhiAccrualDetector(ConstOption.AddressResolverPeriodMs, acceptablePauseMs));
+            entry.Detector.Heartbeat(now);
+            entry.PublishedAt = now;
+            entry.Version = ++_version;
+            _entries[info.Endpoint] = entry;
+            return;
+        }
+
+        // an updated timestamp in the store means a heartbeat of that server arrived
+        if (info.Timestamp > entry.LastTimestamp)
+        {
+            entry.Detector.Heartbeat(now);
+            entry.LastTimestamp = info.Timestamp;
+        }
+
+        if (!entry.Detector.IsAvailable(now, phiThreshold))
+        {
+            info.ServerState = nameof(ServerState.DISABLE);
+        }
+
+        if (entry.Removed || IsChanged(entry.Published, info) ||
+            (IsDrifted(entry.Published, info) && now - entry.PublishedAt >= loadRefreshMs))
+        {
+            entry.Removed = false;
+            Publish(entry, info, now);
+        }
+
+        entry.Info = info;
+    }
+
+    private void Publish(Entry entry, ServerInfoMsg info, long now)
+    {
+        entry.Info = info;
+        entry.Published = info;
+        entry.PublishedAt = now;
+        entry.Version = ++_version;
+    }
+
+    private static bool IsChanged(ServerInfoMsg before, ServerInfoMsg after)
+    {
+        return before.ServerState != after.ServerState ||
+               before.ServiceId != after.ServiceId ||
+               before.ServiceType != after.ServiceType ||
+               Math.Abs(before.ActorCount - after.ActorCount) > Math.Max(10, before.ActorCount / 10) ||
+               Math.Abs(before.Load - after.Load) >= 10;
+    }
+
+    private static bool IsDrifted(ServerInfoMsg before, ServerInfoMsg after)
+    {
+        return before.ActorCount != after.ActorCount || before.Load != after.Load;
+    }
+
+    private void Prune(long now)
+    {
+        foreach (var (endpoint, entry) in _entries.ToList())
+        {
+            if (entry.Removed && now - entry.RemovedAt > TombstoneKeepMs)
+            {
+                _horizon = Math.Max(_horizon, entry.Version);
+                _entries.Remove(endpoint);
+            }
+        }
+    }
+
+    private class Entry(ServerInfoMsg info, PhiAccrualDetector detector)
+    {
+        public ServerInfoMsg Info { get; set; } = info;
+        public ServerInfoMsg Published { get; set; } = info; // the info as of the last version bump
+        public long PublishedAt { get; set; }
+        public PhiAccrualDetector Detector { get; } = detector;
+        public long LastTimestamp { get; set; } = info.Timestamp;
+        public long Version { get; set; }
+        public bool Removed { get; set; }
+        public long RemovedAt { get; set; }
+    }
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
-﻿using PlayHouse.Production.Api;
+﻿using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Api;
 using PlayHouse.Production.Api.Aspectify;
 using PlayHouse.Production.Shared;
 using PlayHouse.Service.Shared;
@@ -9,12 +10,12 @@ namespace PlayHouse.Service.Api.Reflection;
 internal class ApiHandleReflectionInvoker
 {
     private readonly Dictionary<string, string> _backendMessageIndexChecker = new();
-    private readonly Dictionary<string, ReflectionMethod> _backendMethods = new();
+    private readonly Dictionary<int, ReflectionMethod> _backendMethods = new();
     private readonly IEnumerable<AspectifyAttribute> _backendTargetFilters;
     private readonly Dictionary<string, ReflectionInstance> _instances = new();
 
     private readonly Dictionary<string, string> _messageIndexChecker = new();
-    private readonly Dictionary<string, ReflectionMethod> _methods = new();
+    private readonly Dictionary<int, ReflectionMethod> _methods = new();
     private readonly IEnumerable<AspectifyAttribute> _targetFilters;
 
     public ApiHandleReflectionInvoker(
@@ -49,8 +50,11 @@ internal class ApiHandleReflectionInvoker
                         $"registered msgId is duplicated - [msgId:{key}, methods: {_messageIndexChecker[key]}, {value.Method.Name}]");
                 }
 
-                _methods[key] =
-                    new ReflectionMethod(key, className, value.Method, _targetFilters, systemInstance.Filters);
+                _methods[MsgIdRegistry.Register(key)] =
+                    new ReflectionMethod(key, className, value.Method, _targetFilters, systemInstance.Filters)
+                    {
+                        Instance = systemInstance
+                    };
                 _messageIndexChecker[key] = value.Method.Name;
             }
         });
@@ -71,42 +75,33 @@ internal class ApiHandleReflectionInvoker
                             $"registered msgId is duplicated - [msgId:{key}, methods: {_messageIndexChecker[key]}, {value.Method.Name}]");
                     }
 
-                    _backendMethods[key] = new ReflectionMethod(key, className, value.Method, _backendTargetFilters,
-                        systemInstance.Filters);
+                    _backendMethods[MsgIdRegistry.Register(key)] = new ReflectionMethod(key, className, value.Method,
+                        _backendTargetFilters, systemInstance.Filters)
+                    {
+                        Instance = systemInstance
+                    };
                     _backendMessageIndexChecker[key] = value.Method.Name;
                 }
             });
     }
 
-    public async Task InvokeMethods(string msgId, IPacket packet, IApiSender apiSender)
+    public async Task InvokeMethods(int msgNum, IPacket packet, IApiSender apiSender)
     {
-        if (_methods.TryGetValue(msgId, out var method) == false)
-        {
-            throw new ServiceException.NotRegisterMethod($"not registered message msgId:{msgId}");
-        }
-
-        if (_instances.TryGetValue(method.ClassName, out var instance) == false)
+        if (_methods.TryGetValue(msgNum, out var method) == false)
         {
-            throw new ServiceException.NotRegisterInstance(
-                $"{method.ClassName}: reflection instance is not registered");
+            throw new ServiceException.NotRegisterMethod($"not registered message msgId:{packet.MsgId}");
         }
 
-        await instance.Invoke(method, packet, apiSender);
+        await method.Instance!.Invoke(method, packet, apiSender);
     }
 
-    public async Task InvokeBackendMethods(string msgId, IPacket packet, IApiBackendSender apiSender)
+    public async Task InvokeBackendMethods(int msgNum, IPacket packet, IApiBackendSender apiSender)
     {
-        if (_backendMethods.TryGetValue(msgId, out var method) == false)
-        {
-            throw new ServiceException.NotRegisterMethod($"not registered message msgId:{msgId}");
-        }
-
-        if (_instances.TryGetValue(method.ClassName, out var instance) == false)
+        if (_backendMethods.TryGetValue(msgNum, out var method) == false)
         {
-            throw new ServiceException.NotRegisterInstance(
-                $"{method.ClassName}: reflection instance is not registered");
+            throw new ServiceException.NotRegisterMethod($"not registered message msgId:{packet.MsgId}");
         }
 
-        await instance.Invoke(method, packet, apiSender);
+        await method.Instance!.Invoke(method, packet, apiSender);
     }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
-﻿using PlayHouse.Production.Api.Aspectify;
+﻿using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Api.Aspectify;
 using PlayHouse.Production.Shared;
 using PlayHouse.Service.Api.Reflection;
 
@@ -11,11 +12,22 @@ internal class ApiReflection(IServiceProvider serviceProvider, ApiControllAspect
 
     public async Task CallMethodAsync(IPacket packet, IApiSender apiSender)
     {
-        await _apiReflectionInvoker.InvokeMethods(packet.MsgId, packet, apiSender);
+        await CallMethodAsync(MsgIdRegistry.IdOf(packet.MsgId), packet, apiSender);
     }
 
     public async Task CallBackendMethodAsync(IPacket packet, IApiBackendSender apiBackendSender)
     {
-        await _apiReflectionInvoker.InvokeBackendMethods(packet.MsgId, packet, apiBackendSender);
+        await CallBackendMethodAsync(MsgIdRegistry.IdOf(packet.MsgId), packet, apiBackendSender);
+    }
+
+    // msgNum : MsgIdRegistry id of packet.MsgId, already cached in the route header
+    public async Task CallMethodAsync(int msgNum, IPacket packet, IApiSender apiSender)
+    {
+        await _apiReflectionInvoker.InvokeMethods(msgNum, packet, apiSender);
+    }
+
+    public async Task CallBackendMethodAsync(int msgNum, IPacket packet, IApiBackendSender apiBackendSender)
+    {
+        await _apiReflectionInvoker.InvokeBackendMethods(msgNum, packet, apiBackendSender);
     }
 }
\ No newline at end of file
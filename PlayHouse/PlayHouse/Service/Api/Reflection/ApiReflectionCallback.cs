@@ -8,7 +8,7 @@ namespace PlayHouse.Service.Api.Reflection;
 internal class ApiReflectionCallback(IServiceProvider serviceProvider)
 {
     private readonly CallbackReflectionInvoker _invoker = new(serviceProvider,
-        new[] { typeof(IDisconnectCallback), typeof(IUpdateServerInfoCallback) });
+        new[] { typeof(IDisconnectCallback), typeof(IUpdateServerInfoCallback), typeof(IUpdateServerInfoSinceCallback) });
 
     private readonly LOG<ApiReflectionCallback> _log = new();
 
@@ -22,4 +22,12 @@ internal class ApiReflectionCallback(IServiceProvider serviceProvider)
         return (List<IServerInfo>)(await _invoker.InvokeMethodsWithReturn("UpdateServerInfoAsync",
             [serverInfo]))!;
     }
+
+    public bool CanUpdateServerInfoSince => _invoker.HasMethod("UpdateServerInfoSinceAsync");
+
+    public async Task<List<IServerInfo>> UpdateServerInfoSinceAsync(IServerInfo serverInfo, long sinceTimestamp)
+    {
+        return (List<IServerInfo>)(await _invoker.InvokeMethodsWithReturn("UpdateServerInfoSinceAsync",
+            [serverInfo, sinceTimestamp]))!;
+    }
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-﻿using System.Collections.Concurrent;
+﻿using Google.Protobuf;
 using PlayHouse.Communicator;
 using PlayHouse.Communicator.Message;
 using PlayHouse.Production.Play;
@@ -12,15 +12,33 @@ namespace PlayHouse.Service.Play.Base;
 
 internal class BaseStage
 {
+    private static readonly int MigrateStageCommitNum = MsgIdRegistry.IdOf(MigrateStageCommit.Descriptor.Name);
+
+    // actors that joined the stage, only touched on the stage thread so no lock
+    private readonly Dictionary<long, BaseActor> _actors = new();
     private readonly PlayDispatcher _dispatcher;
+    private readonly Func<Task> _drain;
+    private readonly StageSynchronizationContext? _context;
     private readonly AtomicBoolean _isUsing = new(false);
     private readonly LOG<BaseStage> _log = new();
     private readonly BaseStageCmdHandler _msgHandler = new();
-    private readonly ConcurrentQueue<RoutePacket> _msgQueue = new();
+    private readonly Mailbox _mailbox;
+    private readonly IStageScheduler _scheduler;
     private readonly IServerInfoCenter _serverInfoCenter;
     private readonly ISessionUpdater _sessionUpdater;
     private readonly long _stageId;
 
+    private volatile bool _destroyed;
+    private StageGameLoop? _gameLoop;
+
+    // packets received during a migration, forwarded to the target or handled here again when it ends
+    private List<RoutePacket>? _held;
+
+    // the endpoint after moving to another server, later packets are forwarded there
+    private volatile string? _movedTo;
+
+    // restored on the target, waiting for the source's commit
+    private bool _prepared;
     private IStage? _stage;
 
     public BaseStage(long stageId,
@@ -29,10 +47,26 @@ internal class BaseStage
         RequestCache reqCache,
         IServerInfoCenter serverInfoCenter,
         ISessionUpdater sessionUpdater,
-        XStageSender stageSender)
+        XStageSender stageSender,
+        IStageScheduler? scheduler = null,
+        bool useStageContext = false)
     {
         _stageId = stageId;
         _dispatcher = dispatcher;
+        _scheduler = scheduler ?? new ThreadPoolStageScheduler();
+        if (useStageContext)
+        {
+            // the next packet is handled while a handler awaits, its continuation comes back through the mailbox
+            _context = new StageSynchronizationContext(this);
+            stageSender.UseFlowingHeader();
+            _drain = DrainInContext;
+        }
+        else
+        {
+            _drain = Drain;
+        }
+
+        _mailbox = new Mailbox(stageSender.ServiceId, clientCommunicator);
         _serverInfoCenter = serverInfoCenter;
         StageSender = stageSender;
         _sessionUpdater = sessionUpdater;
@@ -44,6 +78,10 @@ internal class BaseStage
         _msgHandler.Register(StageTimer.Descriptor.Name, new StageTimerCmd());
         _msgHandler.Register(DisconnectNoticeMsg.Descriptor.Name, new DisconnectNoticeCmd());
         _msgHandler.Register(AsyncBlock.Descriptor.Name, new AsyncBlockCmd());
+        _msgHandler.Register(GameLoopTickPacket.MsgName, new GameLoopTickCmd());
+        _msgHandler.Register(MigrateStageReq.Descriptor.Name, new MigrateStageCmd(dispatcher));
+        _msgHandler.Register(StageMigrationPacket.MsgName, new StartMigrationCmd());
+        _msgHandler.Register(MigrateStageCommit.Descriptor.Name, new MigrateStageCommitCmd());
     }
 
     public XStageSender StageSender { get; }
@@ -52,8 +90,30 @@ internal class BaseStage
 
     public long StageId => StageSender.StageId;
 
+    internal bool IsMoved => _movedTo != null;
+
     private async Task Dispatch(RoutePacket routePacket)
     {
+        if (routePacket is StageContinuationPacket continuation)
+        {
+            continuation.Run();
+            return;
+        }
+
+        if (_movedTo != null && routePacket is not StageMigrationPacket)
+        {
+            Forward(routePacket);
+            return;
+        }
+
+        if (_held != null && routePacket is not StageMigrationPacket &&
+            routePacket.Header.MsgNum != MigrateStageCommitNum)
+        {
+            // packets received while the migration awaits in a stage context
+            _held.Add(RoutePacket.MoveOf(routePacket));
+            return;
+        }
+
         StageSender.SetCurrentPacketHeader(routePacket.RouteHeader);
         try
         {
@@ -64,10 +124,23 @@ internal class BaseStage
             else
             {
                 var accountId = routePacket.AccountId;
-                var baseUser = _dispatcher.FindUser(accountId);
-                if (baseUser != null)
+                var baseUser = FindActor(accountId);
+                if (baseUser != null && _gameLoop != null)
                 {
-                    await _stage!.OnDispatch(baseUser.Actor, CPacket.Of(routePacket.MsgId, routePacket.Payload));
+                    // a game loop stage gets them at once on the next frame
+                    _gameLoop.AddInput(baseUser.Actor, CPacket.Of(routePacket.MsgId, routePacket.MovePayload()));
+                }
+                else if (baseUser != null)
+                {
+                    var start = PlayMetrics.StartTimestamp(PlayMetrics.HandlerDuration);
+                    try
+                    {
+                        await _stage!.OnDispatch(baseUser.Actor, CPacket.Of(routePacket.MsgId, routePacket.Payload));
+                    }
+                    finally
+                    {
+                        PlayMetrics.RecordHandler(start, "stage", routePacket.MsgId);
+                    }
                 }
             }
         }
@@ -82,31 +155,136 @@ internal class BaseStage
         }
     }
 
+    internal int QueueCount => _mailbox.Count;
+
     public void Post(RoutePacket routePacket)
     {
-        _msgQueue.Enqueue(routePacket);
+        PlayMetrics.OnPosted(routePacket);
+        if (!_mailbox.Post(routePacket))
+        {
+            return;
+        }
+
         if (_isUsing.CompareAndSet(false, true))
         {
-            Task.Run(async () =>
+            _scheduler.Schedule(_stageId, _drain);
+        }
+    }
+
+    private async Task Drain()
+    {
+        var quantum = _scheduler.BatchQuantum;
+        var processed = 0;
+
+        while (true)
+        {
+            while (_mailbox.TryDequeue(out var item))
             {
-                while (_msgQueue.TryDequeue(out var item))
+                PlayMetrics.OnDequeued(item, "stage");
+                try
                 {
-                    try
+                    using (item)
+                    {
+                        await Dispatch(item);
+                    }
+                }
+                catch (Exception e)
+                {
+                    StageSender.Reply((ushort)BaseErrorCode.UncheckedContentsError);
+                    _log.Error(() => e.ToString());
+                }
+
+                if (quantum > 0 && ++processed >= quantum && !_mailbox.IsEmpty)
+                {
+                    // yield the worker to other stages, _isUsing stays set so the order is kept
+                    _scheduler.Schedule(_stageId, _drain);
+                    return;
+                }
+            }
+
+            _isUsing.Set(false);
+
+            // a message posted between the last TryDequeue and Set(false) would be left behind otherwise
+            if (_mailbox.IsEmpty || !_isUsing.CompareAndSet(false, true))
+            {
+                return;
+            }
+        }
+    }
+
+    private Task DrainInContext()
+    {
+        var quantum = _scheduler.BatchQuantum;
+        var processed = 0;
+        var previous = SynchronizationContext.Current;
+        SynchronizationContext.SetSynchronizationContext(_context);
+
+        try
+        {
+            while (true)
+            {
+                while (_mailbox.TryDequeue(out var item))
+                {
+                    PlayMetrics.OnDequeued(item, "stage");
+                    if (item is StageContinuationPacket continuation)
+                    {
+                        RunContinuation(continuation);
+                    }
+                    else
                     {
-                        using (item)
-                        {
-                            await Dispatch(item);
-                        }
+                        // only runs up to the first await here, the rest runs as a continuation through the mailbox
+                        _ = DispatchAndDispose(item);
                     }
-                    catch (Exception e)
+
+                    if (quantum > 0 && ++processed >= quantum && !_mailbox.IsEmpty)
                     {
-                        StageSender.Reply((ushort)BaseErrorCode.UncheckedContentsError);
-                        _log.Error(() => e.ToString());
+                        _scheduler.Schedule(_stageId, _drain);
+                        return Task.CompletedTask;
                     }
                 }
 
                 _isUsing.Set(false);
-            });
+
+                if (_mailbox.IsEmpty || !_isUsing.CompareAndSet(false, true))
+                {
+                    return Task.CompletedTask;
+                }
+            }
+        }
+        finally
+        {
+            SynchronizationContext.SetSynchronizationContext(previous);
+        }
+    }
+
+    private void RunContinuation(StageContinuationPacket continuation)
+    {
+        using (continuation)
+        {
+            try
+            {
+                continuation.Run();
+            }
+            catch (Exception e)
+            {
+                _log.Error(() => e.ToString());
+            }
+        }
+    }
+
+    private async Task DispatchAndDispose(RoutePacket item)
+    {
+        try
+        {
+            using (item)
+            {
+                await Dispatch(item);
+            }
+        }
+        catch (Exception e)
+        {
+            StageSender.Reply((ushort)BaseErrorCode.UncheckedContentsError);
+            _log.Error(() => e.ToString());
         }
     }
 
@@ -123,7 +301,7 @@ internal class BaseStage
     public async Task<(ushort errorCode, IPacket reply)> Join(long accountId, string sessionEndpoint, long sid,
         string apiEndpoint, IPacket packet)
     {
-        var baseUser = _dispatcher.FindUser(accountId);
+        var baseUser = FindActor(accountId);
 
         if (baseUser == null)
         {
@@ -131,7 +309,7 @@ internal class BaseStage
             var user = _dispatcher.CreateContentUser(StageSender.StageType, userSender);
             baseUser = new BaseActor(user, userSender);
             await baseUser.Actor.OnCreate();
-            _dispatcher.AddUser(baseUser);
+            AddActor(baseUser);
         }
         else
         {
@@ -142,10 +320,12 @@ internal class BaseStage
 
         if (errorCode != (ushort)BaseErrorCode.Success)
         {
-            _dispatcher.RemoveUser(accountId);
+            RemoveActor(accountId);
+            StageSender.RemoveMember(accountId);
         }
         else
         {
+            StageSender.AddMember(accountId, baseUser.Actor);
             await _sessionUpdater.UpdateStageInfo(sessionEndpoint, sid);
         }
 
@@ -163,9 +343,30 @@ internal class BaseStage
         StageSender.Reply(packet);
     }
 
+    internal BaseActor? FindActor(long accountId)
+    {
+        return _actors.GetValueOrDefault(accountId);
+    }
+
+    internal void AddActor(BaseActor baseActor)
+    {
+        var accountId = baseActor.ActorSender.AccountId();
+        _actors[accountId] = baseActor;
+        _dispatcher.AddActorStage(accountId, _stageId);
+    }
+
+    private void RemoveActor(long accountId)
+    {
+        if (_actors.Remove(accountId))
+        {
+            _dispatcher.RemoveActorStage(accountId, _stageId);
+        }
+    }
+
     public void LeaveStage(long accountId, string sessionEndpoint, long sid)
     {
-        _dispatcher.RemoveUser(accountId);
+        RemoveActor(accountId);
+        StageSender.RemoveMember(accountId);
         var request = new LeaveStageMsg();
         request.StageId = _stageId;
         StageSender.SendToBaseSession(sessionEndpoint, sid, RoutePacket.Of(request));
@@ -191,13 +392,315 @@ internal class BaseStage
         {
             _log.Error(() => e.ToString());
         }
+
+        StartGameLoop();
+    }
+
+    private void StartGameLoop()
+    {
+        if (_stage is not IGameLoopStage loopStage || _gameLoop != null)
+        {
+            return;
+        }
+
+        _gameLoop = new StageGameLoop(this, loopStage, StageSender);
+        GameLoopTicker.Shared.Add(_gameLoop);
+    }
+
+    internal Task RunFrame()
+    {
+        return _gameLoop?.RunFrame() ?? Task.CompletedTask;
+    }
+
+    // called by the dispatcher when the stage goes away, the actor table is cleaned up on the stage thread
+    internal void OnDestroy()
+    {
+        _destroyed = true;
+        _gameLoop?.Stop();
+        Post(StageContinuationPacket.Of(_stageId, _ =>
+        {
+            _gameLoop?.Release();
+            ReleaseActors();
+        }, null));
+    }
+
+    private void ReleaseActors()
+    {
+        foreach (var accountId in _actors.Keys)
+        {
+            _dispatcher.RemoveActorStage(accountId, _stageId);
+        }
+
+        _actors.Clear();
+    }
+
+    // hands the state to the target with the mailbox held, on success sends the commit and from then on only forwards packets to the target
+    // on failure (timeout included) the target may already be prepared, so an abort is sent and the held packets are handled as usual
+    internal async Task<ushort> MigrateTo(string? targetEndpoint)
+    {
+        if (_destroyed || !IsCreated)
+        {
+            return (ushort)BaseErrorCode.StageIsNotExist;
+        }
+
+        if (_movedTo != null || _held != null)
+        {
+            return (ushort)BaseErrorCode.StageIsMigrating;
+        }
+
+        if (_stage is not IMigratableStage migratable)
+        {
+            return (ushort)BaseErrorCode.StageIsNotMigratable;
+        }
+
+        var target = targetEndpoint ?? _dispatcher.SelectMigrationTarget();
+        if (target == null)
+        {
+            return (ushort)BaseErrorCode.MigrationTargetIsNotExist;
+        }
+
+        _held = new List<RoutePacket>();
+        _gameLoop?.Release();
+        _gameLoop = null;
+
+        ushort errorCode;
+        try
+        {
+            var request = await Snapshot(migratable);
+            errorCode = await StageSender.RequestToBaseStageForCode(target, _stageId, RoutePacket.Of(request));
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => e.ToString());
+            errorCode = (ushort)BaseErrorCode.SystemError;
+        }
+
+        if (errorCode != (ushort)BaseErrorCode.Success)
+        {
+            _log.Warn(() => $"stage migration is failed - [stageId:{_stageId}, target:{target}, errorCode:{errorCode}]");
+            SendCommit(target, false);
+            await Resume();
+            return errorCode;
+        }
+
+        // sent first on the same socket so it arrives before the forwarded packets
+        SendCommit(target, true);
+        _movedTo = target;
+        StageSender.CancelAllTimers();
+        foreach (var accountId in _actors.Keys)
+        {
+            StageSender.RemoveMember(accountId);
+        }
+
+        ReleaseActors();
+        _dispatcher.OnStageMoved(this);
+
+        var held = _held;
+        _held = null;
+        foreach (var packet in held)
+        {
+            using (packet)
+            {
+                Forward(packet);
+            }
+        }
+
+        _log.Info(() => $"stage is migrated - [stageId:{_stageId}, target:{target}]");
+        return errorCode;
+    }
+
+    private void SendCommit(string target, bool commit)
+    {
+        StageSender.SendToBaseStage(target, _stageId, 0, RoutePacket.Of(new MigrateStageCommit { Commit = commit }));
+    }
+
+    private async Task<MigrateStageReq> Snapshot(IMigratableStage migratable)
+    {
+        var request = new MigrateStageReq
+        {
+            StageType = StageSender.StageType,
+            Snapshot = ByteString.CopyFrom(await migratable.OnSnapshot())
+        };
+
+        // in a stage context a continuation can change the actor table during an await
+        foreach (var baseActor in _actors.Values.ToList())
+        {
+            var actorSender = baseActor.ActorSender;
+            var actorMsg = new MigrateActorMsg
+            {
+                AccountId = actorSender.AccountId(),
+                SessionEndpoint = actorSender.SessionEndpoint(),
+                Sid = actorSender.Sid(),
+                ApiEndpoint = actorSender.ApiEndpoint()
+            };
+
+            if (baseActor.Actor is IMigratableActor migratableActor)
+            {
+                actorMsg.Snapshot = ByteString.CopyFrom(await migratableActor.OnSnapshot());
+            }
+
+            request.Actors.Add(actorMsg);
+        }
+
+        request.Timers.AddRange(StageSender.SnapshotTimers());
+        return request;
+    }
+
+    private async Task Resume()
+    {
+        var held = _held!;
+        _held = null;
+        StartGameLoop();
+
+        foreach (var packet in held)
+        {
+            await DispatchAndDispose(packet);
+        }
+    }
+
+    private void Forward(RoutePacket routePacket)
+    {
+        // packets holding a callback cannot go to another server, timers are registered again on the target
+        if (routePacket is AsyncBlockPacket or GameLoopTickPacket ||
+            routePacket.TimerCallback != null || routePacket.StageTimers != null)
+        {
+            _log.Debug(() => $"local packet is dropped after migration - [stageId:{_stageId}, msgId:{routePacket.MsgId}]");
+            return;
+        }
+
+        StageSender.Forward(_movedTo!, routePacket);
+    }
+
+    // rebuilds a stage that moved in from another server from its snapshot
+    internal async Task<ushort> Restore(MigrateStageReq request)
+    {
+        var stageType = request.StageType;
+        try
+        {
+            _stage = _dispatcher.CreateContentRoom(stageType, StageSender);
+            if (_stage is not IMigratableStage migratable)
+            {
+                return (ushort)BaseErrorCode.StageIsNotMigratable;
+            }
+
+            StageSender.SetStageType(stageType);
+
+            var actors = new List<IActor>(request.Actors.Count);
+            foreach (var actorMsg in request.Actors)
+            {
+                var userSender = new XActorSender(actorMsg.AccountId, actorMsg.SessionEndpoint, actorMsg.Sid,
+                    actorMsg.ApiEndpoint, this, _serverInfoCenter);
+                var user = _dispatcher.CreateContentUser(stageType, userSender);
+                if (user is IMigratableActor migratableActor)
+                {
+                    await migratableActor.OnRestore(actorMsg.Snapshot.ToByteArray());
+                }
+                else
+                {
+                    await user.OnCreate();
+                }
+
+                AddActor(new BaseActor(user, userSender));
+                StageSender.AddMember(actorMsg.AccountId, user);
+                actors.Add(user);
+            }
+
+            var timers = request.Timers.Select(e => new MigratedTimer(
+                e.TimerId,
+                TimeSpan.FromMilliseconds(e.RemainingDelay),
+                TimeSpan.FromMilliseconds(e.Period),
+                e.Type == TimerMsg.Types.Type.Count ? e.Count : 0)).ToList();
+
+            await migratable.OnRestore(request.Snapshot.ToByteArray(), actors, timers);
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => e.ToString());
+            StageSender.CancelAllTimers();
+            ReleaseActors();
+            return (ushort)BaseErrorCode.SystemError;
+        }
+
+        IsCreated = true;
+        return (ushort)BaseErrorCode.Success;
+    }
+
+    // holds the restored stage until the commit, dropped when the source does not answer in time
+    internal void Prepare()
+    {
+        _prepared = true;
+        _held = new List<RoutePacket>();
+
+        _ = Task.Delay(TimeSpan.FromSeconds(_dispatcher.MigrationForwardSec)).ContinueWith(_ =>
+            Post(RoutePacket.StageOf(_stageId, 0, RoutePacket.Of(new MigrateStageCommit { Commit = false }), true,
+                true)));
+    }
+
+    internal async Task OnMigrationCommit(bool commit)
+    {
+        if (!_prepared)
+        {
+            return;
+        }
+
+        _prepared = false;
+        var held = _held!;
+        _held = null;
+
+        if (!commit)
+        {
+            _log.Warn(() => $"prepared stage is aborted - [stageId:{_stageId}]");
+            foreach (var packet in held)
+            {
+                packet.Dispose();
+            }
+
+            _destroyed = true;
+            StageSender.CancelAllTimers();
+            foreach (var accountId in _actors.Keys)
+            {
+                StageSender.RemoveMember(accountId);
+            }
+
+            ReleaseActors();
+            _dispatcher.RemoveRoom(_stageId, this);
+            return;
+        }
+
+        StartGameLoop();
+        foreach (var packet in held)
+        {
+            await DispatchAndDispose(packet);
+        }
+
+        await UpdateSessions();
+        _log.Info(() => $"migrated stage is committed - [stageId:{_stageId}]");
+    }
+
+    // points the sessions of restored actors at this server
+    internal Task UpdateSessions()
+    {
+        return Task.WhenAll(_actors.Values.Select(UpdateSession).ToList());
+    }
+
+    private async Task UpdateSession(BaseActor baseActor)
+    {
+        var actorSender = baseActor.ActorSender;
+        try
+        {
+            await _sessionUpdater.UpdateStageInfo(actorSender.SessionEndpoint(), actorSender.Sid());
+        }
+        catch (Exception e)
+        {
+            _log.Warn(() => $"session is not updated after migration - [accountId:{actorSender.AccountId()}] - {e.Message}");
+        }
     }
 
     public async Task OnPostJoinRoom(long accountId)
     {
         try
         {
-            var baseUser = _dispatcher.FindUser(accountId);
+            var baseUser = FindActor(accountId);
 
             if (baseUser != null)
             {
@@ -216,7 +719,7 @@ internal class BaseStage
 
     public async Task OnDisconnect(long accountId)
     {
-        var baseUser = _dispatcher.FindUser(accountId);
+        var baseUser = FindActor(accountId);
 
         if (baseUser != null)
         {
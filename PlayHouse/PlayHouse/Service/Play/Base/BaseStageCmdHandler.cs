@@ -6,11 +6,11 @@ namespace PlayHouse.Service.Play.Base;
 internal class BaseStageCmdHandler
 {
     private readonly LOG<BaseStageCmdHandler> _log = new();
-    private readonly Dictionary<string, IBaseStageCmd> _maps = new();
+    private readonly Dictionary<int, IBaseStageCmd> _maps = new();
 
     public void Register(string msgId, IBaseStageCmd baseStageCmd)
     {
-        if (!_maps.TryAdd(msgId, baseStageCmd))
+        if (!_maps.TryAdd(MsgIdRegistry.Register(msgId), baseStageCmd))
         {
             throw new InvalidOperationException($"Already exist command - [msgId:{msgId}]");
         }
@@ -21,7 +21,7 @@ internal class BaseStageCmdHandler
         var msgId = request.MsgId;
         if (request.IsBase())
         {
-            if (_maps.TryGetValue(msgId, out var cmd))
+            if (_maps.TryGetValue(request.Header.MsgNum, out var cmd))
             {
                 await cmd.Execute(baseStage, request);
             }
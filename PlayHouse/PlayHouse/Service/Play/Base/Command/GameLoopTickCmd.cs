@@ -0,0 +1,11 @@
+﻿using PlayHouse.Communicator.Message;
+
+namespace PlayHouse.Service.Play.Base.Command;
+
+internal class GameLoopTickCmd : IBaseStageCmd
+{
+    public async Task Execute(BaseStage baseStage, RoutePacket routePacket)
+    {
+        await baseStage.RunFrame();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+﻿using PlayHouse.Communicator.Message;
+using Playhouse.Protocol;
+using PlayHouse.Service.Shared;
+
+namespace PlayHouse.Service.Play.Base.Command;
+
+// restores a stage moving in from another play server
+internal class MigrateStageCmd(PlayDispatcher dispatcher) : IBaseStageCmd
+{
+    public async Task Execute(BaseStage baseStage, RoutePacket routePacket)
+    {
+        var request = MigrateStageReq.Parser.ParseFrom(routePacket.Span);
+        var stageId = routePacket.StageId;
+
+        if (!dispatcher.IsValidType(request.StageType))
+        {
+            dispatcher.RemoveRoom(stageId, baseStage);
+            baseStage.Reply((ushort)BaseErrorCode.StageTypeIsInvalid);
+            return;
+        }
+
+        var errorCode = await baseStage.Restore(request);
+        if (errorCode != (ushort)BaseErrorCode.Success)
+        {
+            dispatcher.RemoveRoom(stageId, baseStage);
+            baseStage.Reply(errorCode);
+            return;
+        }
+
+        // until the source sends the commit, sessions are not switched and no packets are handled
+        baseStage.Prepare();
+        baseStage.Reply(CPacket.Of(new MigrateStageRes()));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+﻿using PlayHouse.Communicator.Message;
+using Playhouse.Protocol;
+
+namespace PlayHouse.Service.Play.Base.Command;
+
+// the source committed or aborted the migration
+internal class MigrateStageCommitCmd : IBaseStageCmd
+{
+    public async Task Execute(BaseStage baseStage, RoutePacket routePacket)
+    {
+        var commit = MigrateStageCommit.Parser.ParseFrom(routePacket.Span);
+        await baseStage.OnMigrationCommit(commit.Commit);
+    }
+}
\ No newline at end of file
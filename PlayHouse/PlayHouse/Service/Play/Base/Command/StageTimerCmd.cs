@@ -1,4 +1,5 @@
 ﻿using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Shared;
 using PlayHouse.Utils;
 
 namespace PlayHouse.Service.Play.Base.Command;
@@ -9,11 +10,25 @@ internal class StageTimerCmd : IBaseStageCmd
 
     public async Task Execute(BaseStage baseStage, RoutePacket routePacket)
     {
-        var timerCallback = routePacket.TimerCallback;
-        var timerId = routePacket.TimerId;
+        if (routePacket.StageTimers != null)
+        {
+            foreach (var fire in routePacket.StageTimers)
+            {
+                await Fire(baseStage, fire.TimerId, fire.TimerCallback);
+            }
+
+            return;
+        }
+
+        await Fire(baseStage, routePacket.TimerId, routePacket.TimerCallback!);
+    }
+
+    private async Task Fire(BaseStage baseStage, long timerId, TimerCallbackTask timerCallback)
+    {
         if (baseStage.HasTimer(timerId))
         {
-            var task = timerCallback!.Invoke();
+            baseStage.StageSender.OnTimerFired(timerId);
+            var task = timerCallback.Invoke();
             await task.ConfigureAwait(false);
         }
         else
@@ -0,0 +1,13 @@
+﻿using PlayHouse.Communicator.Message;
+
+namespace PlayHouse.Service.Play.Base.Command;
+
+internal class StartMigrationCmd : IBaseStageCmd
+{
+    public async Task Execute(BaseStage baseStage, RoutePacket routePacket)
+    {
+        var packet = (StageMigrationPacket)routePacket;
+        var errorCode = await baseStage.MigrateTo(packet.TargetEndpoint);
+        packet.Completion.TrySetResult(errorCode);
+    }
+}
\ No newline at end of file
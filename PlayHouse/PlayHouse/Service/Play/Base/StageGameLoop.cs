@@ -0,0 +1,248 @@
+﻿using System.Diagnostics;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Play;
+using PlayHouse.Production.Shared;
+using PlayHouse.Utils;
+
+namespace PlayHouse.Service.Play.Base;
+
+// fixed-rate loop of one stage, each frame enters the stage mailbox as a tick packet and is ordered like any other packet
+internal class StageGameLoop
+{
+    private readonly BaseStage _baseStage;
+    private readonly LOG<StageGameLoop> _log = new();
+    private readonly IGameLoopStage _stage;
+    private readonly XStageSender _stageSender;
+    private List<StageInput> _batch = new();
+    private int _framePending;
+    private List<StageInput> _inputs = new();
+    private long _lastFrameAt;
+    private volatile bool _stopped;
+
+    public StageGameLoop(BaseStage baseStage, IGameLoopStage stage, XStageSender stageSender)
+    {
+        _baseStage = baseStage;
+        _stage = stage;
+        _stageSender = stageSender;
+        Period = Stopwatch.Frequency / Math.Clamp(stage.TickRate, 1, 1000);
+        Deadline = Stopwatch.GetTimestamp() + Period;
+    }
+
+    // in Stopwatch ticks
+    public long Period { get; }
+
+    // changed only on the ticker thread
+    public long Deadline { get; set; }
+
+    public bool IsStopped => _stopped;
+    public string StageType => _stageSender.StageType;
+
+    public void Stop()
+    {
+        _stopped = true;
+    }
+
+    // called on the stage thread, releases inputs that were waiting for the next frame
+    public void Release()
+    {
+        _stopped = true;
+        foreach (var input in _inputs)
+        {
+            input.Packet.Dispose();
+        }
+
+        _inputs.Clear();
+    }
+
+    // called on the stage thread
+    public void AddInput(IActor actor, IPacket packet)
+    {
+        if (_stopped)
+        {
+            packet.Dispose();
+            return;
+        }
+
+        _inputs.Add(new StageInput(actor, packet));
+    }
+
+    // called on the ticker thread, false while the previous frame is still running
+    public bool TryPostFrame()
+    {
+        if (Interlocked.CompareExchange(ref _framePending, 1, 0) != 0)
+        {
+            return false;
+        }
+
+        _baseStage.Post(GameLoopTickPacket.Of(_baseStage.StageId));
+        return true;
+    }
+
+    // called on the stage thread
+    public async Task RunFrame()
+    {
+        var now = Stopwatch.GetTimestamp();
+        var deltaTime = _lastFrameAt == 0
+            ? TimeSpan.FromSeconds((double)Period / Stopwatch.Frequency)
+            : Stopwatch.GetElapsedTime(_lastFrameAt, now);
+        _lastFrameAt = now;
+
+        var start = PlayMetrics.StartTimestamp(PlayMetrics.FrameDuration);
+
+        // inputs arriving during a frame go to the next frame
+        (_inputs, _batch) = (_batch, _inputs);
+
+        _stageSender.BeginFrame();
+        try
+        {
+            if (!_stopped)
+            {
+                if (_batch.Count > 0)
+                {
+                    await _stage.OnInputs(_batch);
+                }
+
+                await _stage.OnTick(deltaTime);
+            }
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => e.ToString());
+        }
+        finally
+        {
+            foreach (var input in _batch)
+            {
+                input.Packet.Dispose();
+            }
+
+            _batch.Clear();
+            _stageSender.EndFrame();
+            PlayMetrics.RecordElapsed(PlayMetrics.FrameDuration, start,
+                new KeyValuePair<string, object?>("stage_type", StageType));
+            Volatile.Write(ref _framePending, 0);
+        }
+    }
+}
+
+/// <summary>
+///     Drives the deadlines of every game loop from one thread.
+///     A deadline is the previous deadline + period so run time does not push the schedule back,
+///     and when the schedule falls a period or more behind the missed frames are skipped rather than run back to back
+///     (counted as overruns). Sleeps until the deadline rounded up to a millisecond, it can wake late by the OS timer
+///     resolution, but deadlines are absolute so the lateness does not accumulate.
+/// </summary>
+internal class GameLoopTicker
+{
+    private static readonly Lazy<GameLoopTicker> SharedTicker = new(() => new GameLoopTicker());
+
+    private readonly PriorityQueue<StageGameLoop, long> _loops = new();
+    private readonly AutoResetEvent _signal = new(false);
+
+    private GameLoopTicker()
+    {
+        var thread = new Thread(Run)
+        {
+            Name = "GameLoopTicker",
+            IsBackground = true
+        };
+        thread.Start();
+    }
+
+    public static GameLoopTicker Shared => SharedTicker.Value;
+
+    public void Add(StageGameLoop loop)
+    {
+        lock (_loops)
+        {
+            _loops.Enqueue(loop, loop.Deadline);
+        }
+
+        _signal.Set();
+    }
+
+    private void Run()
+    {
+        while (true)
+        {
+            StageGameLoop? due = null;
+            long wait = -1;
+
+            lock (_loops)
+            {
+                if (_loops.TryPeek(out var loop, out var deadline))
+                {
+                    wait = deadline - Stopwatch.GetTimestamp();
+                    if (wait <= 0)
+                    {
+                        due = _loops.Dequeue();
+                    }
+                }
+            }
+
+            if (due != null)
+            {
+                Fire(due);
+            }
+            else if (wait < 0)
+            {
+                _signal.WaitOne();
+            }
+            else
+            {
+                // rounding down would spin on WaitOne(0) within the last millisecond
+                _signal.WaitOne((int)Math.Ceiling(wait * 1000.0 / Stopwatch.Frequency));
+            }
+        }
+    }
+
+    private void Fire(StageGameLoop loop)
+    {
+        if (loop.IsStopped)
+        {
+            return;
+        }
+
+        var tag = new KeyValuePair<string, object?>("stage_type", loop.StageType);
+        if (!loop.TryPostFrame())
+        {
+            PlayMetrics.FrameOverruns.Add(1, tag);
+        }
+
+        var now = Stopwatch.GetTimestamp();
+        var next = loop.Deadline + loop.Period;
+        if (next <= now)
+        {
+            var missed = (now - next) / loop.Period + 1;
+            next += missed * loop.Period;
+            PlayMetrics.FrameOverruns.Add(missed, tag);
+        }
+
+        loop.Deadline = next;
+
+        lock (_loops)
+        {
+            _loops.Enqueue(loop, next);
+        }
+    }
+}
+
+internal class GameLoopTickPacket : RoutePacket
+{
+    public const string MsgName = "@Stage@GameLoop@";
+
+    private GameLoopTickPacket(RouteHeader routeHeader) : base(routeHeader, new EmptyPayload())
+    {
+    }
+
+    // a base packet, so it is never dropped by a full mailbox
+    public static GameLoopTickPacket Of(long stageId)
+    {
+        var routeHeader = RouteHeader.Create(MsgName);
+        var packet = new GameLoopTickPacket(routeHeader);
+        packet.RouteHeader.StageId = stageId;
+        packet.RouteHeader.IsBase = true;
+        return packet;
+    }
+}
\ No newline at end of file
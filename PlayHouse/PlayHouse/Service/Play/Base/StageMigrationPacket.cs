@@ -0,0 +1,30 @@
+﻿using PlayHouse.Communicator.Message;
+
+namespace PlayHouse.Service.Play.Base;
+
+// goes through the stage mailbox to start the migration on the stage thread, the resulting errorCode comes back through Completion
+internal class StageMigrationPacket : RoutePacket
+{
+    public const string MsgName = "@Stage@Migrate@";
+
+    private StageMigrationPacket(string? targetEndpoint, TaskCompletionSource<ushort> completion,
+        RouteHeader routeHeader) : base(routeHeader, new EmptyPayload())
+    {
+        TargetEndpoint = targetEndpoint;
+        Completion = completion;
+    }
+
+    public string? TargetEndpoint { get; }
+    public TaskCompletionSource<ushort> Completion { get; }
+
+    // a base packet, so it is never dropped by a full mailbox
+    public static StageMigrationPacket Of(long stageId, string? targetEndpoint)
+    {
+        var routeHeader = RouteHeader.Create(MsgName);
+        var packet = new StageMigrationPacket(targetEndpoint,
+            new TaskCompletionSource<ushort>(TaskCreationOptions.RunContinuationsAsynchronously), routeHeader);
+        packet.RouteHeader.StageId = stageId;
+        packet.RouteHeader.IsBase = true;
+        return packet;
+    }
+}
\ No newline at end of file
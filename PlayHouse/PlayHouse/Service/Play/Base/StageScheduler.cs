@@ -0,0 +1,273 @@
+﻿using System.Collections.Concurrent;
+using PlayHouse.Production.Play;
+using PlayHouse.Utils;
+
+namespace PlayHouse.Service.Play.Base;
+
+internal interface IStageScheduler
+{
+    int BatchQuantum { get; }
+
+    // drain is invoked once per schedule, it reschedules itself when it yields after BatchQuantum messages
+    void Schedule(long stageId, Func<Task> drain);
+    void Start();
+    void Stop();
+}
+
+internal static class StageSchedulerFactory
+{
+    public static IStageScheduler Create(PlayOption playOption)
+    {
+        return playOption.SchedulerMode switch
+        {
+            StageSchedulerMode.Dedicated => new WorkerStageScheduler(playOption.SchedulerWorkerCount,
+                playOption.SchedulerBatchQuantum),
+            _ => new ThreadPoolStageScheduler(playOption.SchedulerBatchQuantum)
+        };
+    }
+}
+
+internal class ThreadPoolStageScheduler(int batchQuantum = 0) : IStageScheduler
+{
+    public int BatchQuantum { get; } = batchQuantum;
+
+    public void Schedule(long stageId, Func<Task> drain)
+    {
+        Task.Run(drain);
+    }
+
+    public void Start()
+    {
+    }
+
+    public void Stop()
+    {
+    }
+}
+
+/// <summary>
+///     Fixed set of worker threads, each with its own run queue.
+///     A stage is always scheduled on the worker picked by its stageId. Workers block until they are signaled, no
+///     polling. A worker that runs dry tries to steal once before it blocks, and Schedule wakes an idle peer only
+///     when the home worker is busy and its queue is backed up, so stages stay on their home worker otherwise.
+///     Each worker installs a SynchronizationContext, so continuations after an await resume on the same worker.
+///     Continuations are never stolen. After Stop, queued and new work is handed to the ThreadPool so no stage is left
+///     with _isUsing set.
+/// </summary>
+internal class WorkerStageScheduler : IStageScheduler
+{
+    // queued drains on a busy worker before an idle peer is woken to steal
+    private const int StealBacklog = 2;
+
+    private readonly LOG<WorkerStageScheduler> _log = new();
+    private readonly Worker[] _workers;
+    private volatile bool _running;
+
+    public WorkerStageScheduler(int workerCount, int batchQuantum)
+    {
+        BatchQuantum = batchQuantum;
+        _workers = new Worker[Math.Max(1, workerCount)];
+        for (var i = 0; i < _workers.Length; i++)
+        {
+            _workers[i] = new Worker(i);
+        }
+    }
+
+    public int BatchQuantum { get; }
+
+    public void Schedule(long stageId, Func<Task> drain)
+    {
+        var worker = _workers[(int)((ulong)(stageId ^ (stageId >> 32)) % (ulong)_workers.Length)];
+        worker.Queue.Enqueue(drain);
+        worker.Signal.Set();
+        if (!_running)
+        {
+            Release(worker);
+            return;
+        }
+
+        if (Volatile.Read(ref worker.Idle) == 0 && worker.Queue.Count >= StealBacklog)
+        {
+            WakeIdlePeer(worker);
+        }
+    }
+
+    public void Start()
+    {
+        _running = true;
+        foreach (var worker in _workers)
+        {
+            worker.Context = new WorkerSynchronizationContext(this, worker);
+            worker.Thread = new Thread(() => Run(worker))
+            {
+                Name = $"StageWorker-{worker.Index}",
+                IsBackground = true
+            };
+            worker.Thread.Start();
+        }
+    }
+
+    public void Stop()
+    {
+        _running = false;
+        foreach (var worker in _workers)
+        {
+            worker.Signal.Set();
+        }
+    }
+
+    private void Run(Worker self)
+    {
+        SynchronizationContext.SetSynchronizationContext(self.Context);
+
+        while (_running)
+        {
+            // finish drains that are already running first
+            if (self.Continuations.TryDequeue(out var continuation))
+            {
+                Execute(continuation.Callback, continuation.State);
+                continue;
+            }
+
+            if (self.Queue.TryDequeue(out var drain) || TrySteal(self, out drain))
+            {
+                Execute(drain!);
+                continue;
+            }
+
+            // Reset and publish Idle before the last check, a Schedule that races with it either sees Idle or is
+            // seen here
+            self.Signal.Reset();
+            Interlocked.Exchange(ref self.Idle, 1);
+            if (_running && self.Queue.IsEmpty && self.Continuations.IsEmpty && !HasBacklog(self))
+            {
+                self.Signal.Wait();
+            }
+
+            Volatile.Write(ref self.Idle, 0);
+        }
+
+        Release(self);
+    }
+
+    // after Stop the remaining work runs on the ThreadPool
+    private void Release(Worker worker)
+    {
+        while (worker.Continuations.TryDequeue(out var continuation))
+        {
+            var (callback, state) = continuation;
+            ThreadPool.QueueUserWorkItem(_ => Execute(callback, state));
+        }
+
+        while (worker.Queue.TryDequeue(out var drain))
+        {
+            Task.Run(() => Execute(drain));
+        }
+    }
+
+    private void Post(Worker worker, SendOrPostCallback callback, object? state)
+    {
+        worker.Continuations.Enqueue((callback, state));
+        worker.Signal.Set();
+        if (!_running)
+        {
+            Release(worker);
+        }
+    }
+
+    private void WakeIdlePeer(Worker home)
+    {
+        for (var i = 1; i < _workers.Length; i++)
+        {
+            var peer = _workers[(home.Index + i) % _workers.Length];
+
+            // clearing Idle claims the peer, so one backlog does not wake every idle worker
+            if (Interlocked.CompareExchange(ref peer.Idle, 0, 1) == 1)
+            {
+                peer.Signal.Set();
+                return;
+            }
+        }
+    }
+
+    private bool HasBacklog(Worker self)
+    {
+        for (var i = 1; i < _workers.Length; i++)
+        {
+            var peer = _workers[(self.Index + i) % _workers.Length];
+            if (Volatile.Read(ref peer.Idle) == 0 && peer.Queue.Count >= StealBacklog)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    private bool TrySteal(Worker self, out Func<Task>? drain)
+    {
+        for (var i = 1; i < _workers.Length; i++)
+        {
+            // an idle victim has been signaled and runs its own queue, only busy workers are stolen from
+            var victim = _workers[(self.Index + i) % _workers.Length];
+            if (Volatile.Read(ref victim.Idle) == 0 && victim.Queue.TryDequeue(out drain))
+            {
+                return true;
+            }
+        }
+
+        drain = null;
+        return false;
+    }
+
+    private void Execute(Func<Task> drain)
+    {
+        try
+        {
+            _ = drain();
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => e.ToString());
+        }
+    }
+
+    private void Execute(SendOrPostCallback callback, object? state)
+    {
+        try
+        {
+            callback(state);
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => e.ToString());
+        }
+    }
+
+    private class Worker(int index)
+    {
+        // 1 while the worker is blocked on Signal
+        public int Idle;
+
+        public int Index { get; } = index;
+        public ConcurrentQueue<Func<Task>> Queue { get; } = new();
+        public ConcurrentQueue<(SendOrPostCallback Callback, object? State)> Continuations { get; } = new();
+        public ManualResetEventSlim Signal { get; } = new(false);
+        public WorkerSynchronizationContext? Context { get; set; }
+        public Thread? Thread { get; set; }
+    }
+
+    // sends continuations after an await back to the worker
+    private class WorkerSynchronizationContext(WorkerStageScheduler scheduler, Worker worker) : SynchronizationContext
+    {
+        public override void Post(SendOrPostCallback d, object? state)
+        {
+            scheduler.Post(worker, d, state);
+        }
+
+        public override SynchronizationContext CreateCopy()
+        {
+            return this;
+        }
+    }
+}
\ No newline at end of file
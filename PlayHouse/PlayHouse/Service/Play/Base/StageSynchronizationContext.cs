@@ -0,0 +1,54 @@
+﻿using PlayHouse.Communicator.Message;
+
+namespace PlayHouse.Service.Play.Base;
+
+// sends the await continuations of handlers started on a stage back to the stage mailbox
+// continuations also run only through the mailbox, so stage state is still touched by one thread at a time
+internal class StageSynchronizationContext(BaseStage baseStage) : SynchronizationContext
+{
+    public override void Post(SendOrPostCallback d, object? state)
+    {
+        baseStage.Post(StageContinuationPacket.Of(baseStage.StageId, d, state));
+    }
+
+    // waiting synchronously would stall the stage, so Send also just posts to the mailbox
+    public override void Send(SendOrPostCallback d, object? state)
+    {
+        Post(d, state);
+    }
+
+    public override SynchronizationContext CreateCopy()
+    {
+        return this;
+    }
+}
+
+internal class StageContinuationPacket : RoutePacket
+{
+    private const string MsgName = "@Stage@Continuation@";
+
+    private StageContinuationPacket(SendOrPostCallback callback, object? state, RouteHeader routeHeader) : base(
+        routeHeader, new EmptyPayload())
+    {
+        Callback = callback;
+        State = state;
+    }
+
+    public SendOrPostCallback Callback { get; }
+    public object? State { get; }
+
+    // a base packet, so it is never dropped by a full mailbox
+    public static StageContinuationPacket Of(long stageId, SendOrPostCallback callback, object? state)
+    {
+        var routeHeader = RouteHeader.Create(MsgName);
+        var packet = new StageContinuationPacket(callback, state, routeHeader);
+        packet.RouteHeader.StageId = stageId;
+        packet.RouteHeader.IsBase = true;
+        return packet;
+    }
+
+    public void Run()
+    {
+        Callback(State);
+    }
+}
\ No newline at end of file
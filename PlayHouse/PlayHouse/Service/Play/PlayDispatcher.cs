@@ -17,13 +17,29 @@ internal interface IPlayDispatcher
 
 internal class PlayDispatcher : IPlayDispatcher
 {
+    // base packets are compared by the MsgIdRegistry id cached in the header
+    private static readonly int CreateStageReqNum = MsgIdRegistry.IdOf(CreateStageReq.Descriptor.Name);
+    private static readonly int CreateJoinStageReqNum = MsgIdRegistry.IdOf(CreateJoinStageReq.Descriptor.Name);
+    private static readonly int TimerMsgNum = MsgIdRegistry.IdOf(TimerMsg.Descriptor.Name);
+    private static readonly int DestroyStageNum = MsgIdRegistry.IdOf(DestroyStage.Descriptor.Name);
+    private static readonly int StageTimerNum = MsgIdRegistry.IdOf(StageTimer.Descriptor.Name);
+    private static readonly int JoinStageReqNum = MsgIdRegistry.IdOf(JoinStageReq.Descriptor.Name);
+    private static readonly int DisconnectNoticeMsgNum = MsgIdRegistry.IdOf(DisconnectNoticeMsg.Descriptor.Name);
+    private static readonly int AsyncBlockNum = MsgIdRegistry.IdOf(AsyncBlock.Descriptor.Name);
+    private static readonly int MigrateStageReqNum = MsgIdRegistry.IdOf(MigrateStageReq.Descriptor.Name);
+    private static readonly int MigrateStageCommitNum = MsgIdRegistry.IdOf(MigrateStageCommit.Descriptor.Name);
+    private static readonly int StageMigrationNum = MsgIdRegistry.IdOf(StageMigrationPacket.MsgName);
+
     private readonly ConcurrentDictionary<long, BaseStage> _baseRooms = new();
-    private readonly ConcurrentDictionary<long, BaseActor> _baseUsers = new();
+    // stages an account is an actor in, used to fan a disconnect out to them (a new array on every change)
+    private readonly ConcurrentDictionary<long, long[]> _actorStages = new();
     private readonly IClientCommunicator _clientCommunicator;
     private readonly LOG<PlayDispatcher> _log = new();
+    private readonly IDisposable _mailboxMetric;
     private readonly PlayOption _playOption;
     private readonly string _publicEndpoint;
     private readonly RequestCache _requestCache;
+    private readonly IStageScheduler _scheduler;
     private readonly XSender _sender;
     private readonly IServerInfoCenter _serverInfoCenter;
     private readonly ushort _serviceId;
@@ -46,6 +62,9 @@ internal class PlayDispatcher : IPlayDispatcher
         _timerManager = new TimerManager(this);
         _sender = new XSender(serviceId, clientCommunicator, requestCache);
         _playOption = playOption;
+        _scheduler = StageSchedulerFactory.Create(playOption);
+
+        _mailboxMetric = PlayMetrics.ObserveMailbox("stage", () => _baseRooms.Values.Sum(e => (long)e.QueueCount));
     }
 
     public void OnPost(RoutePacket routePacket)
@@ -56,22 +75,16 @@ internal class PlayDispatcher : IPlayDispatcher
             var isBase = routePacket.IsBase();
             var stageId = routePacket.RouteHeader.StageId;
 
-            var roomPacket = routePacket;
-            if (routePacket.Payload is not EmptyPayload)
-            {
-                roomPacket = RoutePacket.MoveOf(routePacket);
-            }
-
             if (isBase)
             {
-                DoBaseRoomPacket(msgId, roomPacket, stageId);
+                DoBaseRoomPacket(msgId, routePacket, stageId);
             }
             else
             {
                 _baseRooms.TryGetValue(stageId, out var baseStage);
                 if (baseStage != null)
                 {
-                    baseStage.Post(RoutePacket.MoveOf(roomPacket));
+                    baseStage.Post(RoutePacket.MoveOf(routePacket));
                 }
                 else
                 {
@@ -83,10 +96,14 @@ internal class PlayDispatcher : IPlayDispatcher
 
     public void Start()
     {
+        _scheduler.Start();
     }
 
     public void Stop()
     {
+        _scheduler.Stop();
+        _timerManager.Stop();
+        _mailboxMetric.Dispose();
     }
 
     public void RemoveRoom(long stageId)
@@ -94,9 +111,87 @@ internal class PlayDispatcher : IPlayDispatcher
         _baseRooms.Remove(stageId, out _);
     }
 
-    public void RemoveUser(long accountId)
+    // a stage newly created with the same id is not removed
+    public void RemoveRoom(long stageId, BaseStage baseStage)
+    {
+        _baseRooms.TryRemove(new KeyValuePair<long, BaseStage>(stageId, baseStage));
+    }
+
+    public Task<ushort> MigrateStage(long stageId, string? targetEndpoint = null)
+    {
+        if (!_baseRooms.TryGetValue(stageId, out var baseStage) || baseStage.IsMoved)
+        {
+            return Task.FromResult((ushort)BaseErrorCode.StageIsNotExist);
+        }
+
+        var packet = StageMigrationPacket.Of(stageId, targetEndpoint);
+        var completion = packet.Completion.Task;
+        baseStage.Post(packet);
+        return completion;
+    }
+
+    // used to drain, returns the number of stages moved
+    public async Task<int> MigrateAll()
+    {
+        var stageIds = _baseRooms.Where(e => !e.Value.IsMoved).Select(e => e.Key).ToList();
+        var results = await Task.WhenAll(stageIds.Select(stageId => MigrateStage(stageId)));
+        return results.Count(e => e == (ushort)BaseErrorCode.Success);
+    }
+
+    // picks by load among the running play servers other than this one
+    internal string? SelectMigrationTarget()
+    {
+        var candidates = _serverInfoCenter.GetServerList()
+            .Where(e => e.GetServiceId() == _serviceId &&
+                        e.GetState() == ServerState.RUNNING &&
+                        e.IsValid() &&
+                        e.GetBindEndpoint() != _publicEndpoint)
+            .ToArray();
+
+        return candidates.Length == 0 ? null : ServerSelector.WeightedLoad(candidates).GetBindEndpoint();
+    }
+
+    internal int MigrationForwardSec => _playOption.MigrationForwardSec;
+
+    // forwards packets to a stage that moved away until session and api servers learn the new endpoint
+    internal void OnStageMoved(BaseStage baseStage)
     {
-        _baseUsers.Remove(accountId, out _);
+        _ = Task.Delay(TimeSpan.FromSeconds(_playOption.MigrationForwardSec))
+            .ContinueWith(_ => RemoveRoom(baseStage.StageId, baseStage));
+    }
+
+    public void AddActorStage(long accountId, long stageId)
+    {
+        _actorStages.AddOrUpdate(accountId, _ => [stageId],
+            (_, stageIds) => stageIds.Contains(stageId) ? stageIds : [..stageIds, stageId]);
+    }
+
+    public void RemoveActorStage(long accountId, long stageId)
+    {
+        while (_actorStages.TryGetValue(accountId, out var stageIds))
+        {
+            if (!stageIds.Contains(stageId))
+            {
+                return;
+            }
+
+            if (stageIds.Length == 1)
+            {
+                if (_actorStages.TryRemove(new KeyValuePair<long, long[]>(accountId, stageIds)))
+                {
+                    return;
+                }
+            }
+            else if (_actorStages.TryUpdate(accountId, stageIds.Where(id => id != stageId).ToArray(), stageIds))
+            {
+                return;
+            }
+        }
+    }
+
+    public long[] StagesOf(long accountId)
+    {
+        return _actorStages.GetValueOrDefault(accountId) ?? [];
     }
 
     private string Endpoint()
@@ -110,21 +205,11 @@ internal class PlayDispatcher : IPlayDispatcher
         var stageSender = new XStageSender(_serviceId, stageId, this, _clientCommunicator, _requestCache);
         var sessionUpdater = new XSessionUpdater(Endpoint(), stageSender);
         var baseStage = new BaseStage(stageId, this, _clientCommunicator, _requestCache, _serverInfoCenter,
-            sessionUpdater, stageSender);
+            sessionUpdater, stageSender, _scheduler, _playOption.UseStageContext);
         _baseRooms[stageId] = baseStage;
         return baseStage;
     }
 
-    public BaseActor? FindUser(long accountId)
-    {
-        return _baseUsers.GetValueOrDefault(accountId);
-    }
-
-    public void AddUser(BaseActor baseActor)
-    {
-        _baseUsers[baseActor.ActorSender.AccountId()] = baseActor;
-    }
-
     public BaseStage? FindRoom(long stageId)
     {
         return _baseRooms[stageId];
@@ -155,7 +240,8 @@ internal class PlayDispatcher : IPlayDispatcher
 
     private void DoBaseRoomPacket(string msgId, RoutePacket routePacket, long stageId)
     {
-        if (msgId == CreateStageReq.Descriptor.Name)
+        var msgNum = routePacket.Header.MsgNum;
+        if (msgNum == CreateStageReqNum)
         {
             var newStageId = routePacket.StageId;
             if (_baseRooms.ContainsKey(newStageId))
@@ -167,7 +253,7 @@ internal class PlayDispatcher : IPlayDispatcher
                 MakeBaseRoom(newStageId).Post(RoutePacket.MoveOf(routePacket));
             }
         }
-        else if (msgId == CreateJoinStageReq.Descriptor.Name)
+        else if (msgNum == CreateJoinStageReqNum)
         {
             _baseRooms.TryGetValue(stageId, out var room);
             if (room != null)
@@ -179,30 +265,69 @@ internal class PlayDispatcher : IPlayDispatcher
                 MakeBaseRoom(stageId).Post(RoutePacket.MoveOf(routePacket));
             }
         }
-        else if (msgId == TimerMsg.Descriptor.Name)
+        else if (msgNum == TimerMsgNum)
         {
             var timerId = routePacket.TimerId;
             var protoPayload = (routePacket.Payload as ProtoPayload)!;
             TimerProcess(stageId, timerId, (protoPayload.GetProto() as TimerMsg)!, routePacket.TimerCallback!);
         }
-        else if (msgId == DestroyStage.Descriptor.Name)
+        else if (msgNum == MigrateStageReqNum)
         {
-            _baseRooms.Remove(stageId, out _);
+            // when a stage that moved away comes back, it replaces the forwarding stage
+            if (_baseRooms.TryGetValue(stageId, out var existing) && !existing.IsMoved)
+            {
+                _sender.SetCurrentPacketHeader(routePacket.RouteHeader);
+                _sender.Reply((ushort)BaseErrorCode.AlreadyExistStage);
+                _sender.ClearCurrentPacketHeader();
+            }
+            else
+            {
+                MakeBaseRoom(stageId).Post(RoutePacket.MoveOf(routePacket));
+            }
+        }
+        else if (msgNum == MigrateStageCommitNum)
+        {
+            // an abort can also reach a target that failed to prepare, without a stage there is nothing to do
+            if (_baseRooms.TryGetValue(stageId, out var prepared))
+            {
+                prepared.Post(RoutePacket.MoveOf(routePacket));
+            }
+        }
+        else if (msgNum == DestroyStageNum)
+        {
+            if (_baseRooms.Remove(stageId, out var destroyed))
+            {
+                destroyed.OnDestroy();
+            }
+        }
+        else if (msgNum == DisconnectNoticeMsgNum && stageId == 0)
+        {
+            // a disconnect without a stage goes to every stage the account is in
+            var accountId = routePacket.AccountId;
+            foreach (var actorStageId in StagesOf(accountId))
+            {
+                if (_baseRooms.TryGetValue(actorStageId, out var actorStage))
+                {
+                    actorStage.Post(RoutePacket.StageOf(actorStageId, accountId,
+                        RoutePacket.Of(new DisconnectNoticeMsg()), true, true));
+                }
+            }
         }
         else
         {
             if (!_baseRooms.TryGetValue(stageId, out var room))
             {
-                if (msgId == StageTimer.Descriptor.Name) return;
+                if (msgNum == StageTimerNum) return;
                 _log.Error(() => $"Room is not exist : {stageId},{msgId}");
                 _sender.Reply((ushort)BaseErrorCode.StageIsNotExist);
                 return;
             }
 
-            if (msgId == JoinStageReq.Descriptor.Name ||
-                msgId == StageTimer.Descriptor.Name ||
-                msgId == DisconnectNoticeMsg.Descriptor.Name ||
-                msgId == AsyncBlock.Descriptor.Name)
+            if (msgNum == JoinStageReqNum ||
+                msgNum == StageTimerNum ||
+                msgNum == DisconnectNoticeMsgNum ||
+                msgNum == AsyncBlockNum ||
+                msgNum == StageMigrationNum)
             {
                 room!.Post(RoutePacket.MoveOf(routePacket));
             }
@@ -255,6 +380,6 @@ internal class PlayDispatcher : IPlayDispatcher
 
     internal int GetActorCount()
     {
-        return _baseUsers.Count;
+        return _actorStages.Count;
     }
 }
\ No newline at end of file
@@ -1,14 +1,17 @@
 ﻿using CommonLib;
 using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
 using PlayHouse.Communicator.PlaySocket;
 using PlayHouse.Production.Play;
 using PlayHouse.Production.Shared;
+using PlayHouse.Service.Shared;
 
 namespace PlayHouse.Service.Play;
 
 public class PlayServer : IServer
 {
     private readonly Communicator.Communicator _communicator;
+    private readonly PlayService _playService;
 
     public PlayServer(PlayhouseOption commonOption, PlayOption playOption)
     {
@@ -21,6 +24,7 @@ public class PlayServer : IServer
             .SetShowQps(commonOption1.ShowQps)
             .SetNodeId(commonOption1.NodeId)
             .SetPacketProducer(commonOption1.PacketProducer)
+            .SetUseLocalTransport(commonOption1.UseLocalTransport)
             .SetAddressServerEndpoints(commonOption1.AddressServerEndpoints)
             .SetAddressServerServiceId(commonOption1.AddressServerServiceId)
             .Build();
@@ -29,14 +33,21 @@ public class PlayServer : IServer
         var serviceId = commonOption1.ServiceId;
 
         PooledBuffer.Init(commonOption1.MaxBufferPoolSize);
+        PlaySocketFactory.InitBufferPool(commonOption1.MaxBufferPoolSize);
+        PacketPool.Init(commonOption1.UsePacketPool, commonOption1.DebugPacketPool);
+        MsgIdRegistry.Init(commonOption1.UseNumericMsgId, commonOption1.MsgIdDescriptors);
+        Mailbox.Init(commonOption1.MailboxCapacity, commonOption1.MailboxOverflowPolicy);
 
         var communicateClient =
-            new XClientCommunicator(PlaySocketFactory.CreatePlaySocket(new SocketConfig(), bindEndpoint));
+            new XClientCommunicator(PlaySocketFactory.CreatePlaySocket(
+                    new SocketConfig { CompressThreshold = commonOption1.CompressThreshold }, bindEndpoint),
+                commonOption1.SendQueueCapacity, commonOption1.UseLocalTransport);
 
         var requestCache = new RequestCache(commonOption1.RequestTimeoutSec);
-        var serverInfoCenter = new XServerInfoCenter();
+        var serverInfoCenter = new XServerInfoCenter(commonOption1.ServerSelectStrategy);
         var playService = new PlayService(serviceId, bindEndpoint, playOption, communicateClient, requestCache,
             serverInfoCenter);
+        _playService = playService;
 
         _communicator = new Communicator.Communicator(
             communicatorOption,
@@ -52,6 +63,13 @@ public class PlayServer : IServer
         _communicator.Start();
     }
 
+    // moves IMigratableStage stages to other play servers before a deploy, returns the number of stages moved
+    // stages that cannot move stay here until they end
+    public Task<int> DrainAsync()
+    {
+        return _playService.DrainAsync();
+    }
+
     public async Task StopAsync()
     {
         await _communicator!.StopAsync();
@@ -57,6 +57,13 @@ internal class PlayService(
         _state.Set(ServerState.RUNNING);
     }
 
+    // pauses so no new stages arrive, then moves every migratable stage to other play servers
+    public Task<int> DrainAsync()
+    {
+        OnPause();
+        return _playDispatcher.MigrateAll();
+    }
+
     public int GetActorCount()
     {
         return _playDispatcher.GetActorCount();
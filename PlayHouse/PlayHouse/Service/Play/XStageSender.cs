@@ -1,7 +1,9 @@
 ﻿using PlayHouse.Communicator;
 using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Play;
 using PlayHouse.Production.Shared;
 using Playhouse.Protocol;
+using PlayHouse.Service.Play.Base;
 using PlayHouse.Service.Shared;
 
 namespace PlayHouse.Service.Play;
@@ -14,7 +16,11 @@ internal class XStageSender(
     RequestCache reqCache)
     : XSender(serviceId, clientCommunicator, reqCache), IStageSender
 {
-    private readonly HashSet<long> _timerIds = new();
+    private readonly List<FrameSend> _frameSends = new();
+    private readonly Dictionary<long, IActor> _members = new();
+    // records each timer's next fire time so a migration can hand over the remaining time and count
+    private readonly Dictionary<long, TimerSchedule> _timerIds = new();
+    private bool _inFrame;
 
     public long StageId { get; } = stageId;
 
@@ -32,7 +38,7 @@ internal class XStageSender(
             period
         );
         dispatcher.OnPost(packet);
-        _timerIds.Add(timerId);
+        _timerIds[timerId] = new TimerSchedule(TimerMsg.Types.Type.Repeat, initialDelay, period, 0);
         return timerId;
     }
 
@@ -49,7 +55,7 @@ internal class XStageSender(
             count
         );
         dispatcher.OnPost(packet);
-        _timerIds.Add(timerId);
+        _timerIds[timerId] = new TimerSchedule(TimerMsg.Types.Type.Count, initialDelay, period, count);
         return timerId;
     }
 
@@ -69,20 +75,8 @@ internal class XStageSender(
 
     public void CloseStage()
     {
-        foreach (var timerId in _timerIds)
-        {
-            var packet = RoutePacket.AddTimerOf(
-                TimerMsg.Types.Type.Cancel,
-                StageId,
-                timerId,
-                () => Task.CompletedTask,
-                TimeSpan.Zero,
-                TimeSpan.Zero
-            );
-            dispatcher.OnPost(packet);
-        }
-
-        _timerIds.Clear();
+        CancelAllTimers();
+        _members.Clear();
 
         var packet2 = RoutePacket.StageOf(StageId, 0, RoutePacket.Of(DestroyStage.Descriptor.Name, new EmptyPayload()),
             true, false);
@@ -93,10 +87,75 @@ internal class XStageSender(
     {
         PacketContext.AsyncCore.Add(SendTarget.Client, 0, packet);
 
+        if (_inFrame)
+        {
+            _frameSends.Add(new FrameSend(sessionEndpoint, sid, packet));
+            return;
+        }
+
         var routePacket = RoutePacket.ClientOf(ServiceId, sid, packet, StageId);
         ClientCommunicator.Send(sessionEndpoint, routePacket);
     }
 
+    public void Broadcast(IEnumerable<IActor> actors, IPacket packet)
+    {
+        PacketContext.AsyncCore.Add(SendTarget.Client, 0, packet);
+
+        var sidsByEndpoint = new Dictionary<string, List<long>>();
+        foreach (var actor in actors)
+        {
+            var actorSender = actor.ActorSender;
+            var sessionEndpoint = actorSender.SessionEndpoint();
+            if (!sidsByEndpoint.TryGetValue(sessionEndpoint, out var sids))
+            {
+                sids = new List<long>();
+                sidsByEndpoint.Add(sessionEndpoint, sids);
+            }
+
+            sids.Add(actorSender.Sid());
+        }
+
+        if (sidsByEndpoint.Count == 0)
+        {
+            return;
+        }
+
+        if (_inFrame)
+        {
+            foreach (var (sessionEndpoint, sids) in sidsByEndpoint)
+            {
+                foreach (var sid in sids)
+                {
+                    _frameSends.Add(new FrameSend(sessionEndpoint, sid, packet));
+                }
+            }
+
+            return;
+        }
+
+        var data = packet.Payload.Data;
+        foreach (var (sessionEndpoint, sids) in sidsByEndpoint)
+        {
+            var routePacket = RoutePacket.ClientOf(ServiceId, sids.ToArray(), packet, new MemoryPayload(data), StageId);
+            ClientCommunicator.Send(sessionEndpoint, routePacket);
+        }
+    }
+
+    public void BroadcastAll(IPacket packet)
+    {
+        Broadcast(_members.Values, packet);
+    }
+
+    internal void AddMember(long accountId, IActor actor)
+    {
+        _members[accountId] = actor;
+    }
+
+    internal void RemoveMember(long accountId)
+    {
+        _members.Remove(accountId);
+    }
+
     public void AsyncBlock(AsyncPreCallback preCallback, AsyncPostCallback? postCallback = null)
     {
         Task.Run(async () =>
@@ -111,6 +170,136 @@ internal class XStageSender(
     }
 
 
+    // gathers packets to clients during a game loop frame
+    internal void BeginFrame()
+    {
+        _inFrame = true;
+    }
+
+    // sends the gathered packets in order, consecutive copies of a packet to one session server are merged into one
+    internal void EndFrame()
+    {
+        _inFrame = false;
+
+        var count = _frameSends.Count;
+        var i = 0;
+        while (i < count)
+        {
+            var first = _frameSends[i];
+            var end = i + 1;
+            while (end < count && ReferenceEquals(_frameSends[end].Packet, first.Packet) &&
+                   _frameSends[end].SessionEndpoint == first.SessionEndpoint)
+            {
+                end++;
+            }
+
+            RoutePacket routePacket;
+            if (end - i == 1)
+            {
+                routePacket = RoutePacket.ClientOf(ServiceId, first.Sid, first.Packet, StageId);
+            }
+            else
+            {
+                var sids = new long[end - i];
+                for (var j = 0; j < sids.Length; j++)
+                {
+                    sids[j] = _frameSends[i + j].Sid;
+                }
+
+                routePacket = RoutePacket.ClientOf(ServiceId, sids, first.Packet,
+                    new MemoryPayload(first.Packet.Payload.Data), StageId);
+            }
+
+            ClientCommunicator.Send(first.SessionEndpoint, routePacket);
+            i = end;
+        }
+
+        _frameSends.Clear();
+    }
+
+    public void MigrateStage(string? targetEndpoint = null)
+    {
+        dispatcher.OnPost(StageMigrationPacket.Of(StageId, targetEndpoint));
+    }
+
+    internal void CancelAllTimers()
+    {
+        foreach (var timerId in _timerIds.Keys)
+        {
+            var packet = RoutePacket.AddTimerOf(
+                TimerMsg.Types.Type.Cancel,
+                StageId,
+                timerId,
+                () => Task.CompletedTask,
+                TimeSpan.Zero,
+                TimeSpan.Zero
+            );
+            dispatcher.OnPost(packet);
+        }
+
+        _timerIds.Clear();
+    }
+
+    // called on the stage thread before the timer callback runs
+    internal void OnTimerFired(long timerId)
+    {
+        if (!_timerIds.TryGetValue(timerId, out var schedule))
+        {
+            return;
+        }
+
+        if (schedule.Fire())
+        {
+            _timerIds.Remove(timerId);
+        }
+    }
+
+    internal IEnumerable<MigrateTimerMsg> SnapshotTimers()
+    {
+        var now = Environment.TickCount64;
+        foreach (var (timerId, schedule) in _timerIds)
+        {
+            if (schedule.Type == TimerMsg.Types.Type.Count && schedule.Remaining <= 0)
+            {
+                continue;
+            }
+
+            yield return new MigrateTimerMsg
+            {
+                TimerId = timerId,
+                Type = schedule.Type,
+                RemainingDelay = Math.Max(0, schedule.NextFireMs - now),
+                Period = schedule.PeriodMs,
+                Count = schedule.Remaining
+            };
+        }
+    }
+
+    // forwards packets for a stage that moved away to the target, requests are relayed and the reply goes back to the original requester
+    internal void Forward(string playEndpoint, RoutePacket routePacket)
+    {
+        var header = routePacket.RouteHeader;
+        var msgSeq = header.Header.MsgSeq;
+        // requests are sent as backend requests so the reply comes back to this server's request cache
+        var forward = RoutePacket.StageOf(StageId, header.AccountId, routePacket, header.IsBase,
+            header.IsBackend || msgSeq != 0);
+        forward.RouteHeader.Sid = header.Sid;
+
+        if (msgSeq == 0)
+        {
+            ClientCommunicator.Send(playEndpoint, forward);
+            return;
+        }
+
+        var source = RouteHeader.Of(new Header(msgId: header.MsgId, msgSeq: msgSeq));
+        source.Sid = header.Sid;
+        source.IsBase = header.IsBase;
+        source.IsBackend = header.IsBackend;
+        source.AccountId = header.AccountId;
+        source.From = header.From;
+        RelayRequest(playEndpoint, forward, source);
+    }
+
     private long MakeTimerId()
     {
         return TimerIdMaker.MakeId();
@@ -118,11 +307,33 @@ internal class XStageSender(
 
     public bool HasTimer(long timerId)
     {
-        return _timerIds.Contains(timerId);
+        return _timerIds.ContainsKey(timerId);
     }
 
     public void SetStageType(string stageType)
     {
         StageType = stageType;
     }
+
+    private class TimerSchedule(TimerMsg.Types.Type type, TimeSpan initialDelay, TimeSpan period, int count)
+    {
+        public TimerMsg.Types.Type Type { get; } = type;
+        public long PeriodMs { get; } = (long)period.TotalMilliseconds;
+        public long NextFireMs { get; private set; } = Environment.TickCount64 + (long)initialDelay.TotalMilliseconds;
+        public int Remaining { get; private set; } = count;
+
+        // true on the last fire
+        public bool Fire()
+        {
+            NextFireMs += PeriodMs;
+            return Type == TimerMsg.Types.Type.Count && --Remaining <= 0;
+        }
+    }
+
+    private readonly struct FrameSend(string sessionEndpoint, long sid, IPacket packet)
+    {
+        public string SessionEndpoint { get; } = sessionEndpoint;
+        public long Sid { get; } = sid;
+        public IPacket Packet { get; } = packet;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+﻿using System.Buffers;
+using System.Buffers.Binary;
+using System.IO.Compression;
+
+namespace PlayHouse.Service.Session.Network;
+
+/// <summary>
+///     Large body compression, BCL only like PacketFrame and linked into ClientConnector as well.
+///     compressed body : rawSize(4) + brotli bytes
+///     Client frames flag it with the top bit of bodySize, the backbone with HeaderMsg.compressed.
+/// </summary>
+internal static class FrameCompression
+{
+    public const int RawSizeFieldSize = 4;
+
+    // speed first, large protos shrink enough at quality 1
+    private const int Quality = 1;
+    private const int Window = 22;
+
+    public static int MaxCompressedSize(int rawSize)
+    {
+        return RawSizeFieldSize + BrotliEncoder.GetMaxCompressedLength(rawSize);
+    }
+
+    // writes the compressed body to destination and returns its size, 0 when it is not smaller than the original
+    public static int Compress(ReadOnlySpan<byte> body, Span<byte> destination)
+    {
+        BinaryPrimitives.WriteInt32BigEndian(destination, body.Length);
+        if (!BrotliEncoder.TryCompress(body, destination[RawSizeFieldSize..], out var written, Quality, Window))
+        {
+            return 0;
+        }
+
+        var size = RawSizeFieldSize + written;
+        return size < body.Length ? size : 0;
+    }
+
+    public static int RawSizeOf(ReadOnlySpan<byte> compressed)
+    {
+        return BinaryPrimitives.ReadInt32BigEndian(compressed);
+    }
+
+    // destination is RawSizeOf bytes
+    public static void Decompress(ReadOnlySpan<byte> compressed, Span<byte> destination)
+    {
+        if (!BrotliDecoder.TryDecompress(compressed[RawSizeFieldSize..], destination, out var written) ||
+            written != destination.Length)
+        {
+            throw new InvalidDataException($"compressed body is broken : [rawSize:{destination.Length}]");
+        }
+    }
+
+    // turns a header + body frame into one with only the body compressed, the buffer is rented from ArrayPool
+    // null when below threshold, already compressed or not shrinking
+    public static byte[]? CompressFrame(ReadOnlySpan<byte> frame, int threshold, out int frameSize)
+    {
+        frameSize = 0;
+        if (frame.Length <= PacketFrame.MsgIdSizeOffset || PacketFrame.IsCompressed(frame))
+        {
+            return null;
+        }
+
+        var bodySize = PacketFrame.BodySizeOf(frame);
+        if (bodySize < threshold)
+        {
+            return null;
+        }
+
+        var headerSize = frame.Length - bodySize;
+        var rented = ArrayPool<byte>.Shared.Rent(headerSize + MaxCompressedSize(bodySize));
+        var size = Compress(frame[headerSize..], rented.AsSpan(headerSize));
+        if (size == 0)
+        {
+            ArrayPool<byte>.Shared.Return(rented);
+            return null;
+        }
+
+        frame[..headerSize].CopyTo(rented);
+        PacketFrame.WriteBodySize(rented, size, true);
+        frameSize = headerSize + size;
+        return rented;
+    }
+}
\ No newline at end of file
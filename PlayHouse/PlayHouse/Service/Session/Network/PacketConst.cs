@@ -9,4 +9,5 @@ internal static class PacketConst
     public static readonly string HeartBeat = "@Heart@Beat@";
     public static readonly string Debug = "@Debug@";
     public static readonly string Timeout = "@Timeout@";
+    public static readonly string Compression = "@Compression@";
 }
\ No newline at end of file
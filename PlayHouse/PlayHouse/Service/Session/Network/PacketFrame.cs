@@ -0,0 +1,167 @@
+﻿using System.Buffers.Binary;
+using System.Text;
+using PlayHouse.Utils;
+
+namespace PlayHouse.Service.Session.Network;
+
+/// <summary>
+///     Client frame layout, uses only the BCL (and the linked Fnv1a helper).
+///     ClientConnector links and compiles this file as is, so server and client read and write with the same code.
+///     client -> server : bodySize(4) serviceId(2) msgIdSize(1) msgId(n) msgSeq(2) stageId(8) body
+///     server -> client : errorCode(2) after stageId
+///     a msgIdSize of 0 means a 4byte numeric id (FNV-1a hash of the msgId) instead of the msgId
+///     when the top bit of bodySize is set the body is compressed with FrameCompression
+/// </summary>
+internal static class PacketFrame
+{
+    public const int MsgIdSizeOffset = 6;
+    public const int NumericMsgIdSize = 4;
+    public const int MaxMsgIdSize = byte.MaxValue;
+    public const int CompressedFlag = int.MinValue;
+
+    // header size without the msgId
+    public const int RequestHeaderSize = 4 + 2 + 1 + 2 + 8;
+    public const int ReplyHeaderSize = RequestHeaderSize + 2;
+
+    public static int BodySizeOf(ReadOnlySpan<byte> data)
+    {
+        return BinaryPrimitives.ReadInt32BigEndian(data) & ~CompressedFlag;
+    }
+
+    public static bool IsCompressed(ReadOnlySpan<byte> data)
+    {
+        return (data[0] & 0x80) != 0;
+    }
+
+    public static void WriteBodySize(Span<byte> destination, int bodySize, bool compressed)
+    {
+        BinaryPrimitives.WriteInt32BigEndian(destination, compressed ? bodySize | CompressedFlag : bodySize);
+    }
+
+    // frame size including the body, -1 until the msgId size has arrived
+    public static int FrameSizeOf(ReadOnlySpan<byte> data, bool hasErrorCode)
+    {
+        if (data.Length <= MsgIdSizeOffset)
+        {
+            return -1;
+        }
+
+        var sizeOfMsgId = data[MsgIdSizeOffset];
+        var msgIdFieldSize = sizeOfMsgId == 0 ? NumericMsgIdSize : sizeOfMsgId;
+        return (hasErrorCode ? ReplyHeaderSize : RequestHeaderSize) + msgIdFieldSize + BodySizeOf(data);
+    }
+
+    public static int HeaderSizeOf(int msgIdSize, bool hasErrorCode)
+    {
+        return (hasErrorCode ? ReplyHeaderSize : RequestHeaderSize) + (msgIdSize == 0 ? NumericMsgIdSize : msgIdSize);
+    }
+
+    // reads the header from a span holding the whole frame, the msgId is passed on as raw utf-8 or as a numeric id
+    public static FrameHeader ReadHeader(ReadOnlySpan<byte> frame, bool hasErrorCode)
+    {
+        var header = new FrameHeader
+        {
+            BodySize = BodySizeOf(frame),
+            Compressed = IsCompressed(frame),
+            ServiceId = BinaryPrimitives.ReadUInt16BigEndian(frame[4..])
+        };
+
+        int sizeOfMsgId = frame[MsgIdSizeOffset];
+        var offset = MsgIdSizeOffset + 1;
+        if (sizeOfMsgId == 0)
+        {
+            header.MsgNum = BinaryPrimitives.ReadInt32BigEndian(frame[offset..]);
+            offset += NumericMsgIdSize;
+        }
+        else
+        {
+            header.MsgIdOffset = offset;
+            header.MsgIdSize = sizeOfMsgId;
+            offset += sizeOfMsgId;
+        }
+
+        header.MsgSeq = BinaryPrimitives.ReadUInt16BigEndian(frame[offset..]);
+        offset += 2;
+        header.StageId = BinaryPrimitives.ReadInt64BigEndian(frame[offset..]);
+        offset += 8;
+
+        if (hasErrorCode)
+        {
+            header.ErrorCode = BinaryPrimitives.ReadUInt16BigEndian(frame[offset..]);
+            offset += 2;
+        }
+
+        header.BodyOffset = offset;
+        return header;
+    }
+
+    // writes the msgId as utf-8, or numeric when msgNum is not 0, returns the written header size
+    public static int WriteHeader(Span<byte> destination, int bodySize, ushort serviceId, string msgId, int msgNum,
+        ushort msgSeq, long stageId, ushort? errorCode)
+    {
+        BinaryPrimitives.WriteInt32BigEndian(destination, bodySize);
+        BinaryPrimitives.WriteUInt16BigEndian(destination[4..], serviceId);
+        var offset = MsgIdSizeOffset + 1;
+
+        if (msgNum != 0)
+        {
+            destination[MsgIdSizeOffset] = 0;
+            BinaryPrimitives.WriteInt32BigEndian(destination[offset..], msgNum);
+            offset += NumericMsgIdSize;
+        }
+        else
+        {
+            var msgIdSize = Encoding.UTF8.GetBytes(msgId, destination[offset..]);
+            if (msgIdSize > MaxMsgIdSize)
+            {
+                throw new ArgumentException($"MsgId size is over : {msgIdSize}");
+            }
+
+            destination[MsgIdSizeOffset] = (byte)msgIdSize;
+            offset += msgIdSize;
+        }
+
+        BinaryPrimitives.WriteUInt16BigEndian(destination[offset..], msgSeq);
+        offset += 2;
+        BinaryPrimitives.WriteInt64BigEndian(destination[offset..], stageId);
+        offset += 8;
+
+        if (errorCode.HasValue)
+        {
+            BinaryPrimitives.WriteUInt16BigEndian(destination[offset..], errorCode.Value);
+            offset += 2;
+        }
+
+        return offset;
+    }
+
+    // FNV-1a 32 over utf-8, 0 means no msgId
+    public static int HashOf(string msgId)
+    {
+        return msgId.Length == 0 ? 0 : NonZero(Fnv1a.Hash32(msgId));
+    }
+
+    public static int HashOf(ReadOnlySpan<byte> utf8)
+    {
+        return utf8.Length == 0 ? 0 : NonZero(Fnv1a.Hash32(utf8));
+    }
+
+    private static int NonZero(int hash)
+    {
+        return hash == 0 ? 1 : hash;
+    }
+}
+
+internal struct FrameHeader
+{
+    public int BodySize;
+    public bool Compressed;
+    public ushort ServiceId;
+    public int MsgNum; // only for a numeric msgId
+    public int MsgIdOffset;
+    public int MsgIdSize;
+    public ushort MsgSeq;
+    public long StageId;
+    public ushort ErrorCode;
+    public int BodyOffset;
+}
\ No newline at end of file
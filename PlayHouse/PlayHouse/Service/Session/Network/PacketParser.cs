@@ -1,5 +1,5 @@
-﻿using CommonLib;
-using NetMQ;
+﻿using System.Buffers;
+using CommonLib;
 using PlayHouse.Communicator.Message;
 using PlayHouse.Utils;
 
@@ -9,21 +9,36 @@ namespace PlayHouse.Service.Session.Network;
  *  4byte  body size
  *  2byte  serviceId
  *  1byte  msgId size
- *  n byte msgId string
+ *  n byte msgId string (size 0 means a 4byte numeric msgId, MsgIdRegistry)
  *  2byte  msgSeq
  *  8byte  stageId
  *  From Header Size = 2+3+2+1+2+8+2+N = 17 + n
  * */
 internal sealed class PacketParser
 {
+    private const int InitialCarrySize = 1024 * 4;
+
     private readonly LOG<PacketParser> _log = new();
+    private readonly byte[] _msgIdBuffer = new byte[PacketConst.MsgIdLimit];
+
+    // only partially received frames are gathered here, complete frames are parsed straight from the received buffer
+    private byte[]? _carry;
+    private int _carryCount;
 
     public List<ClientPacket> Parse(RingBuffer buffer)
     {
         var packets = new List<ClientPacket>();
+        Parse(buffer, packets.Add);
+        return packets;
+    }
+
+    public void Parse(RingBuffer buffer, Action<ClientPacket> onPacket)
+    {
         while (buffer.Count >= PacketConst.MinPacketSize)
         {
             int bodySize = buffer.PeekInt32(buffer.ReaderIndex);
+            var compressed = (bodySize & PacketFrame.CompressedFlag) != 0;
+            bodySize &= ~PacketFrame.CompressedFlag;
 
             if (bodySize > PacketConst.MaxPacketSize)
             {
@@ -41,17 +56,218 @@ internal sealed class PacketParser
 
             var serviceId = buffer.ReadInt16();
             var sizeOfMsgId = buffer.ReadByte();
-            var msgId = buffer.ReadString(sizeOfMsgId);
+            string msgId;
+            var msgNum = 0;
+            if (sizeOfMsgId == 0)
+            {
+                msgNum = buffer.ReadInt32();
+                msgId = MsgIdRegistry.NameOf(msgNum);
+            }
+            else
+            {
+                buffer.Read(_msgIdBuffer, 0, sizeOfMsgId);
+                msgId = MsgIdRegistry.Intern(_msgIdBuffer.AsSpan(0, sizeOfMsgId));
+            }
 
             var msgSeq = buffer.ReadInt16();
             var stageId = buffer.ReadInt64();
-            var body = new NetMQFrame(bodySize);
 
-            buffer.Read(body.Buffer, 0, bodySize);
+            IPayload payload = new EmptyPayload();
+            if (compressed)
+            {
+                var rented = ArrayPool<byte>.Shared.Rent(bodySize);
+                try
+                {
+                    buffer.Read(rented, 0, bodySize);
+                    payload = Decompress(rented.AsSpan(0, bodySize));
+                }
+                finally
+                {
+                    ArrayPool<byte>.Shared.Return(rented);
+                }
+            }
+            else if (bodySize > 0)
+            {
+                var body = new MsgPayload(bodySize);
+                var segment = body.Segment;
+                buffer.Read(segment.Array!, segment.Offset, segment.Count);
+                payload = body;
+            }
+
+            onPacket(new ClientPacket(HeaderOf(serviceId, msgId, msgNum, msgSeq, stageId), payload));
+        }
+    }
 
-            var clientPacket = new ClientPacket(new Header(serviceId, msgId, msgSeq, 0, stageId), new FramePayload(body));
-            packets.Add(clientPacket);
+    // parses straight over the received bytes, only an incomplete frame at the end is copied aside
+    public void Parse(ReadOnlySpan<byte> received, Action<ClientPacket> onPacket)
+    {
+        if (_carryCount > 0)
+        {
+            if (!CompleteCarry(ref received, onPacket))
+            {
+                return;
+            }
         }
-        return packets;
+
+        while (received.Length > 0)
+        {
+            var frameSize = FrameSizeOf(received);
+            if (frameSize < 0 || received.Length < frameSize)
+            {
+                Carry(received);
+                return;
+            }
+
+            onPacket(ParseFrame(received[..frameSize]));
+            received = received[frameSize..];
+        }
+    }
+
+    public void Clear()
+    {
+        if (_carry != null)
+        {
+            ArrayPool<byte>.Shared.Return(_carry);
+            _carry = null;
+        }
+
+        _carryCount = 0;
+    }
+
+    // fills the carried frame from the received bytes, true when it was completed and dispatched
+    private bool CompleteCarry(ref ReadOnlySpan<byte> received, Action<ClientPacket> onPacket)
+    {
+        var frameSize = FrameSizeOf(_carry.AsSpan(0, _carryCount));
+        if (frameSize < 0)
+        {
+            // fill only enough to know the size first
+            var headNeed = Math.Min(PacketFrame.MsgIdSizeOffset + 1 - _carryCount, received.Length);
+            if (headNeed > 0)
+            {
+                Carry(received[..headNeed]);
+                received = received[headNeed..];
+            }
+
+            frameSize = FrameSizeOf(_carry.AsSpan(0, _carryCount));
+            if (frameSize < 0)
+            {
+                return false;
+            }
+        }
+
+        var need = Math.Min(frameSize - _carryCount, received.Length);
+        Carry(received[..need]);
+        received = received[need..];
+
+        if (_carryCount < frameSize)
+        {
+            return false;
+        }
+
+        var packet = ParseFrame(_carry.AsSpan(0, frameSize));
+        _carryCount = 0;
+        if (_carry!.Length > InitialCarrySize)
+        {
+            // a buffer grown for a large frame is returned right away
+            Clear();
+        }
+
+        onPacket(packet);
+        return true;
+    }
+
+    private void Carry(ReadOnlySpan<byte> data)
+    {
+        var required = _carryCount + data.Length;
+        if (_carry == null || _carry.Length < required)
+        {
+            var carry = ArrayPool<byte>.Shared.Rent(Math.Max(required, InitialCarrySize));
+            if (_carry != null)
+            {
+                _carry.AsSpan(0, _carryCount).CopyTo(carry);
+                ArrayPool<byte>.Shared.Return(_carry);
+            }
+
+            _carry = carry;
+        }
+
+        data.CopyTo(_carry.AsSpan(_carryCount));
+        _carryCount = required;
+    }
+
+    // whole frame size, -1 until the bytes up to the msgId size are there
+    private int FrameSizeOf(ReadOnlySpan<byte> data)
+    {
+        if (data.Length <= PacketFrame.MsgIdSizeOffset)
+        {
+            return -1;
+        }
+
+        var bodySize = PacketFrame.BodySizeOf(data);
+        if (bodySize < 0 || bodySize > PacketConst.MaxPacketSize)
+        {
+            _log.Error(() => $"Body size over : {bodySize}");
+            throw new Exception("BodySizeOver");
+        }
+
+        return PacketFrame.FrameSizeOf(data, false);
+    }
+
+    private static ClientPacket ParseFrame(ReadOnlySpan<byte> frame)
+    {
+        var header = PacketFrame.ReadHeader(frame, false);
+        var msgId = header.MsgIdSize == 0
+            ? MsgIdRegistry.NameOf(header.MsgNum)
+            : MsgIdRegistry.Intern(frame.Slice(header.MsgIdOffset, header.MsgIdSize));
+
+        IPayload payload = new EmptyPayload();
+        if (header.Compressed)
+        {
+            payload = Decompress(frame.Slice(header.BodyOffset, header.BodySize));
+        }
+        else if (header.BodySize > 0)
+        {
+            var body = new MsgPayload(header.BodySize);
+            frame.Slice(header.BodyOffset, header.BodySize).CopyTo(body.Segment);
+            payload = body;
+        }
+
+        return new ClientPacket(HeaderOf(header.ServiceId, msgId, header.MsgIdSize == 0 ? header.MsgNum : 0,
+            header.MsgSeq, header.StageId), payload);
+    }
+
+    // a numeric msgId is carried along even without a known name and used for dispatch and relay
+    private static Header HeaderOf(ushort serviceId, string msgId, int msgNum, ushort msgSeq, long stageId)
+    {
+        var header = new Header(serviceId, msgId, msgSeq, 0, stageId);
+        if (msgNum != 0)
+        {
+            header.SetMsgId(msgId, msgNum);
+        }
+
+        return header;
+    }
+
+    // the decompressed body also lives in a pool buffer
+    internal static MsgPayload Decompress(ReadOnlySpan<byte> compressed)
+    {
+        var rawSize = compressed.Length < FrameCompression.RawSizeFieldSize ? -1 : FrameCompression.RawSizeOf(compressed);
+        if (rawSize <= 0 || rawSize > PacketConst.MaxPacketSize)
+        {
+            throw new Exception($"invalid compressed body size : {rawSize}");
+        }
+
+        var body = new MsgPayload(rawSize);
+        try
+        {
+            FrameCompression.Decompress(compressed, body.Segment);
+        }
+        catch
+        {
+            body.Dispose();
+            throw;
+        }
+
+        return body;
     }
 }
\ No newline at end of file
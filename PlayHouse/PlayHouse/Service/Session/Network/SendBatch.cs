@@ -0,0 +1,184 @@
+﻿using System.Buffers;
+using System.Collections.Concurrent;
+using System.Diagnostics;
+using PlayHouse.Utils;
+
+namespace PlayHouse.Service.Session.Network;
+
+// sends batched frames at once, tcp appends them to the stream and websocket sends one binary message
+internal interface IBatchSender
+{
+    void SendFrames(ReadOnlySpan<byte> frames);
+}
+
+/// <summary>
+///     Per session send batch.
+///     Client frames are gathered in a pooled buffer and sent at once when flushBytes is reached or the flush delay
+///     has passed.
+/// </summary>
+internal class SendBatch(IBatchSender session, SendFlusher flusher, int flushBytes)
+{
+    private readonly object _lock = new();
+    private byte[]? _buffer = ArrayPool<byte>.Shared.Rent(flushBytes);
+    private int _count;
+    private bool _scheduled;
+
+    public void Write(ReadOnlySpan<byte> frame)
+    {
+        lock (_lock)
+        {
+            if (_buffer == null)
+            {
+                return;
+            }
+
+            if (_count + frame.Length > _buffer.Length)
+            {
+                FlushLocked();
+            }
+
+            if (frame.Length >= _buffer.Length)
+            {
+                // a frame too large to batch is sent right away
+                session.SendFrames(frame);
+                return;
+            }
+
+            frame.CopyTo(_buffer.AsSpan(_count));
+            _count += frame.Length;
+
+            if (_count >= flushBytes)
+            {
+                FlushLocked();
+            }
+            else if (!_scheduled)
+            {
+                _scheduled = true;
+                flusher.Schedule(this);
+            }
+        }
+    }
+
+    public void Flush()
+    {
+        lock (_lock)
+        {
+            _scheduled = false;
+            FlushLocked();
+        }
+    }
+
+    public void Close()
+    {
+        lock (_lock)
+        {
+            if (_buffer == null)
+            {
+                return;
+            }
+
+            ArrayPool<byte>.Shared.Return(_buffer);
+            _buffer = null;
+            _count = 0;
+        }
+    }
+
+    private void FlushLocked()
+    {
+        if (_count == 0 || _buffer == null)
+        {
+            return;
+        }
+
+        // NetCoreServer copies into its own send buffer, so the buffer can be reused right away
+        session.SendFrames(_buffer.AsSpan(0, _count));
+        _count = 0;
+    }
+}
+
+/// <summary>
+///     Thread that sends SendBatches whose flush delay has passed, every batch has the same delay so the first
+///     scheduled is the first due. Batches with at most a quarter of the delay left are sent together.
+///     Thread.Sleep has millisecond granularity (often coarser), so the thread only sleeps while more than
+///     SleepMarginMs is left and spins for the rest, which keeps sub-millisecond delays (the default 500us) on time.
+///     The price is one core spinning for at most SleepMarginMs while a batch is pending.
+/// </summary>
+internal class SendFlusher(int flushMicros)
+{
+    private readonly LOG<SendFlusher> _log = new();
+    private readonly ConcurrentQueue<(SendBatch Batch, long Timestamp)> _queue = new();
+    private const int SleepMarginMs = 1;
+
+    private readonly long _delayTicks = Stopwatch.Frequency * flushMicros / 1_000_000;
+    private readonly long _sleepMarginTicks = Stopwatch.Frequency * SleepMarginMs / 1000;
+    private readonly long _slackTicks = Stopwatch.Frequency * flushMicros / 1_000_000 / 4;
+    private readonly ManualResetEventSlim _signal = new(false);
+    private volatile bool _running;
+    private Thread? _thread;
+
+    public void Schedule(SendBatch batch)
+    {
+        _queue.Enqueue((batch, Stopwatch.GetTimestamp()));
+        _signal.Set();
+    }
+
+    public void Start()
+    {
+        _running = true;
+        _thread = new Thread(Run) { Name = "SessionSendFlusher", IsBackground = true };
+        _thread.Start();
+    }
+
+    public void Stop()
+    {
+        _running = false;
+        _signal.Set();
+    }
+
+    private void Run()
+    {
+        var spin = new SpinWait();
+        while (_running)
+        {
+            if (!_queue.TryPeek(out var item))
+            {
+                _signal.Wait(100);
+                _signal.Reset();
+                continue;
+            }
+
+            var remain = item.Timestamp + _delayTicks - Stopwatch.GetTimestamp();
+            if (remain > _slackTicks)
+            {
+                if (remain > _sleepMarginTicks)
+                {
+                    // wake up SleepMarginMs early, a late wake up is what misses the delay
+                    Thread.Sleep((int)((remain - _sleepMarginTicks) * 1000 / Stopwatch.Frequency));
+                }
+                else
+                {
+                    spin.SpinOnce(-1);
+                }
+
+                continue;
+            }
+
+            spin.Reset();
+
+            _queue.TryDequeue(out _);
+            try
+            {
+                item.Batch.Flush();
+            }
+            catch (Exception e)
+            {
+                _log.Error(() => $"session send flush error - {e.Message}");
+            }
+        }
+
+        while (_queue.TryDequeue(out var item))
+        {
+            item.Batch.Flush();
+        }
+    }
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 ﻿using PlayHouse.Production.Session;
 using PlayHouse.Service.Session.Network.tcp;
+using PlayHouse.Service.Session.Network.udp;
 using PlayHouse.Service.Session.Network.websocket;
 
 namespace PlayHouse.Service.Session.Network;
@@ -10,7 +11,11 @@ internal class SessionNetwork
 
     public SessionNetwork(SessionOption sessionOption, ISessionListener sessionListener)
     {
-        if (sessionOption.UseWebSocket)
+        if (sessionOption.UseUdp)
+        {
+            _sessionNetwork = new UdpSessionNetwork(sessionOption, sessionListener);
+        }
+        else if (sessionOption.UseWebSocket)
         {
             _sessionNetwork = new WsSessionNetwork(sessionOption, sessionListener);
         }
@@ -1,5 +1,4 @@
 ﻿using System.Net.Sockets;
-using CommonLib;
 using NetCoreServer;
 using PlayHouse.Communicator.Message;
 using PlayHouse.Production.Session;
@@ -7,26 +6,59 @@ using PlayHouse.Utils;
 
 namespace PlayHouse.Service.Session.Network.tcp;
 
-internal class XTcpSession(TcpServer server, ISessionListener sessionListener) : TcpSession(server), ISession
+internal class XTcpSession(TcpServer server, ISessionListener sessionListener, SendFlusher? sendFlusher = null,
+    int sendFlushBytes = 0) : TcpSession(server), ISession, IBatchSender
 {
-    private readonly RingBuffer _buffer = new(1024 * 4, PacketConst.MaxPacketSize);
+    private const int DisconnectFlushTimeoutMs = 3000;
+
     private readonly LOG<XTcpSession> _log = new();
     private readonly PacketParser _packetParser = new();
+    private volatile bool _disconnectOnEmpty;
+    private Action<ClientPacket>? _onPacket;
+    private SendBatch? _sendBatch;
 
-
+    // disconnects after the batched frames and the send buffer are sent, a client that stops reading is cut by timeout
     public void ClientDisconnect()
     {
-        base.Disconnect();
+        _sendBatch?.Flush();
+        _disconnectOnEmpty = true;
+        if (BytesPending + BytesSending == 0)
+        {
+            base.Disconnect();
+            return;
+        }
+
+        Task.Delay(DisconnectFlushTimeoutMs).ContinueWith(_ => base.Disconnect());
+    }
+
+    protected override void OnEmpty()
+    {
+        if (_disconnectOnEmpty)
+        {
+            base.Disconnect();
+        }
     }
 
     public void Send(ClientPacket packet)
     {
         using (packet)
         {
-            base.SendAsync(packet.Span);
+            if (_sendBatch != null)
+            {
+                _sendBatch.Write(packet.Span);
+            }
+            else
+            {
+                base.SendAsync(packet.Span);
+            }
         }
     }
 
+    public void SendFrames(ReadOnlySpan<byte> frames)
+    {
+        base.SendAsync(frames);
+    }
+
     private long GetSid()
     {
         return Socket.Handle.ToInt64();
@@ -37,6 +69,11 @@ internal class XTcpSession(TcpServer server, ISessionListener sessionListener) :
         try
         {
             _log.Debug(() => $"TCP session OnConnected - [Sid:{GetSid()}]");
+            if (sendFlusher != null)
+            {
+                _sendBatch = new SendBatch(this, sendFlusher, sendFlushBytes);
+            }
+
             sessionListener.OnConnect(GetSid(), this);
         }
         catch (Exception e)
@@ -51,6 +88,8 @@ internal class XTcpSession(TcpServer server, ISessionListener sessionListener) :
         {
             _log.Debug(() => $"TCP session OnDisConnected - [Sid:{GetSid()}]");
             sessionListener.OnDisconnect(GetSid());
+            _packetParser.Clear();
+            _sendBatch?.Close();
         }
         catch (Exception e)
         {
@@ -62,13 +101,7 @@ internal class XTcpSession(TcpServer server, ISessionListener sessionListener) :
     {
         try
         {
-            _buffer.Write(buffer, offset, size);
-            var packets = _packetParser.Parse(_buffer);
-            foreach (var packet in packets)
-            {
-                _log.Trace(() => $"OnReceive from:client - [packetInfo:{packet.Header}]");
-                sessionListener.OnReceive(GetSid(), packet);
-            }
+            _packetParser.Parse(buffer.AsSpan((int)offset, (int)size), _onPacket ??= OnPacket);
         }
         catch (Exception e)
         {
@@ -77,6 +110,12 @@ internal class XTcpSession(TcpServer server, ISessionListener sessionListener) :
         }
     }
 
+    private void OnPacket(ClientPacket packet)
+    {
+        _log.Trace(() => $"OnReceive from:client - [packetInfo:{packet.Header}]");
+        sessionListener.OnReceive(GetSid(), packet);
+    }
+
     protected override void OnError(SocketError error)
     {
         try
@@ -95,11 +134,19 @@ internal class TcpSessionServer : TcpServer
 {
     private readonly LOG<TcpSessionServer> _log = new();
 
+    private readonly SendFlusher? _sendFlusher;
+    private readonly int _sendFlushBytes;
     private readonly ISessionListener _sessionListener;
 
-    public TcpSessionServer(string address, int port, ISessionListener sessionListener) : base(address, port)
+    public TcpSessionServer(string address, int port, ISessionListener sessionListener, int sendFlushBytes = 0,
+        int sendFlushMicros = 0) : base(address, port)
     {
         _sessionListener = sessionListener;
+        _sendFlushBytes = sendFlushBytes;
+        if (sendFlushBytes > 0)
+        {
+            _sendFlusher = new SendFlusher(sendFlushMicros);
+        }
 
         OptionNoDelay = true;
         OptionReuseAddress = true;
@@ -112,20 +159,27 @@ internal class TcpSessionServer : TcpServer
 
     protected override TcpSession CreateSession()
     {
-        return new XTcpSession(this, _sessionListener);
+        return new XTcpSession(this, _sessionListener, _sendFlusher, _sendFlushBytes);
     }
 
     protected override void OnStarted()
     {
+        _sendFlusher?.Start();
         _log.Info(() => "Server Started");
     }
+
+    protected override void OnStopped()
+    {
+        _sendFlusher?.Stop();
+    }
 }
 
 internal class TcpSessionNetwork(SessionOption sessionOption, ISessionListener sessionListener)
     : ISessionNetwork
 {
     private readonly LOG<TcpSessionNetwork> _log = new();
-    private readonly TcpSessionServer _tcpSessionServer = new("0.0.0.0", sessionOption.SessionPort, sessionListener);
+    private readonly TcpSessionServer _tcpSessionServer = new("0.0.0.0", sessionOption.SessionPort, sessionListener,
+        sessionOption.SendFlushBytes, sessionOption.SendFlushMicros);
 
     public void Start()
     {
@@ -0,0 +1,217 @@
+﻿using System.Buffers;
+
+namespace PlayHouse.Service.Session.Network.udp;
+
+internal delegate void DatagramSender(ReadOnlySpan<byte> datagram);
+
+/// <summary>
+///     Sending side of the reliable-ordered channel.
+///     Cuts frame bytes into MaxSegmentSize segments with a seq each and resends them every RTO until acked.
+///     Not thread safe, the session calls it under its lock.
+/// </summary>
+internal class ReliableSender(ulong token, DatagramSender send, int windowSize = 256, int maxRetries = 10)
+{
+    private const int MinRtoMs = 30;
+    private const int MaxRtoMs = 2000;
+    private const int InitialRtoMs = 200;
+
+    private readonly Dictionary<uint, Segment> _inFlight = new();
+    private readonly Queue<Segment> _waiting = new();
+    private uint _nextSeq;
+    private double _rto = InitialRtoMs;
+    private double _rttVar;
+    private double _srtt = -1;
+
+    public int InFlightCount => _inFlight.Count;
+    public int WaitingCount => _waiting.Count;
+    public double RtoMs => _rto;
+
+    public void Write(ReadOnlySpan<byte> frames, long nowMs)
+    {
+        while (frames.Length > 0)
+        {
+            var size = Math.Min(frames.Length, UdpDatagram.MaxSegmentSize);
+            var buffer = ArrayPool<byte>.Shared.Rent(UdpDatagram.Mtu);
+            var length = UdpDatagram.WriteData(buffer, token, UdpChannel.ReliableOrdered, _nextSeq, frames[..size]);
+            _waiting.Enqueue(new Segment(_nextSeq++, buffer, length));
+            frames = frames[size..];
+        }
+
+        Flush(nowMs);
+    }
+
+    public void OnAck(uint nextExpected, uint ackBits, long nowMs)
+    {
+        if (_inFlight.Count > 0)
+        {
+            // everything before nextExpected has been received
+            foreach (var seq in _inFlight.Keys.Where(seq => UdpDatagram.IsNewer(nextExpected, seq)).ToList())
+            {
+                Acked(seq, nowMs);
+            }
+
+            for (var i = 0; ackBits != 0 && i < 32; i++, ackBits >>= 1)
+            {
+                if ((ackBits & 1) != 0)
+                {
+                    Acked(nextExpected + 1 + (uint)i, nowMs);
+                }
+            }
+        }
+
+        Flush(nowMs);
+    }
+
+    // resends segments whose RTO passed, false past maxRetries (the connection is considered lost)
+    public bool Tick(long nowMs)
+    {
+        foreach (var segment in _inFlight.Values)
+        {
+            if (nowMs - segment.SentAt < segment.Timeout)
+            {
+                continue;
+            }
+
+            if (segment.Retries >= maxRetries)
+            {
+                return false;
+            }
+
+            segment.Retries++;
+            segment.Timeout = Math.Min((int)_rto << Math.Min(segment.Retries, 5), MaxRtoMs * 4);
+            segment.SentAt = nowMs;
+            send(segment.Datagram);
+        }
+
+        return true;
+    }
+
+    public void Clear()
+    {
+        foreach (var segment in _inFlight.Values.Concat(_waiting))
+        {
+            ArrayPool<byte>.Shared.Return(segment.Buffer);
+        }
+
+        _inFlight.Clear();
+        _waiting.Clear();
+    }
+
+    private void Flush(long nowMs)
+    {
+        while (_inFlight.Count < windowSize && _waiting.TryDequeue(out var segment))
+        {
+            segment.SentAt = nowMs;
+            segment.Timeout = (int)_rto;
+            _inFlight[segment.Seq] = segment;
+            send(segment.Datagram);
+        }
+    }
+
+    private void Acked(uint seq, long nowMs)
+    {
+        if (!_inFlight.Remove(seq, out var segment))
+        {
+            return;
+        }
+
+        // a resent segment's ack cannot be matched to one send, so it is not used for rtt
+        if (segment.Retries == 0)
+        {
+            UpdateRto(nowMs - segment.SentAt);
+        }
+
+        ArrayPool<byte>.Shared.Return(segment.Buffer);
+    }
+
+    private void UpdateRto(double rtt)
+    {
+        if (_srtt < 0)
+        {
+            _srtt = rtt;
+            _rttVar = rtt / 2;
+        }
+        else
+        {
+            _rttVar = 0.75 * _rttVar + 0.25 * Math.Abs(_srtt - rtt);
+            _srtt = 0.875 * _srtt + 0.125 * rtt;
+        }
+
+        _rto = Math.Clamp(_srtt + 4 * _rttVar, MinRtoMs, MaxRtoMs);
+    }
+
+    private class Segment(uint seq, byte[] buffer, int length)
+    {
+        public uint Seq { get; } = seq;
+        public byte[] Buffer { get; } = buffer;
+        public ReadOnlySpan<byte> Datagram => Buffer.AsSpan(0, length);
+        public long SentAt { get; set; }
+        public int Timeout { get; set; }
+        public int Retries { get; set; }
+    }
+}
+
+/// <summary>
+///     Receiving side of the reliable-ordered channel.
+///     In-order segments are passed on right away, early segments are held within the window until the gap fills.
+/// </summary>
+internal class ReliableReceiver(int windowSize = 256)
+{
+    private readonly Dictionary<uint, byte[]> _outOfOrder = new();
+    private uint _next;
+
+    public uint NextExpected => _next;
+
+    public void OnData(uint seq, ReadOnlySpan<byte> payload, DatagramSender deliver)
+    {
+        if (seq == _next)
+        {
+            deliver(payload);
+            _next++;
+            while (_outOfOrder.Remove(_next, out var pending))
+            {
+                deliver(pending);
+                _next++;
+            }
+
+            return;
+        }
+
+        // dropped when already received or outside the window, the ack tells the sender again
+        if (UdpDatagram.IsNewer(seq, _next) && seq - _next < windowSize)
+        {
+            _outOfOrder.TryAdd(seq, payload.ToArray());
+        }
+    }
+
+    // whether the seq is new, false when already received or outside the window
+    public bool IsNew(uint seq)
+    {
+        return seq == _next ||
+               (UdpDatagram.IsNewer(seq, _next) && seq - _next < windowSize && !_outOfOrder.ContainsKey(seq));
+    }
+
+    public uint AckBits()
+    {
+        uint bits = 0;
+        if (_outOfOrder.Count == 0)
+        {
+            return bits;
+        }
+
+        for (var i = 0; i < 32; i++)
+        {
+            if (_outOfOrder.ContainsKey(_next + 1 + (uint)i))
+            {
+                bits |= 1u << i;
+            }
+        }
+
+        return bits;
+    }
+
+    public void Clear()
+    {
+        _outOfOrder.Clear();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+﻿using System.Buffers.Binary;
+
+namespace PlayHouse.Service.Session.Network.udp;
+
+internal enum UdpPacketType : byte
+{
+    Connect = 1, // client -> server, 8byte client nonce (+ 8byte cookie)
+    Accept = 2, // server -> client, the issued connection token
+    Data = 3,
+    Ack = 4,
+    Disconnect = 5,
+    Challenge = 6 // server -> client, answer to a Connect without cookie, 8byte nonce + 8byte cookie
+}
+
+internal enum UdpChannel : byte
+{
+    ReliableOrdered = 0, // request/reply, resent and ordered, PacketParser joins it like a stream
+    UnreliableSequenced = 1 // state updates, never resent, older seqs are dropped, frames fit whole in one datagram
+}
+
+/*
+ *  1byte  type
+ *  8byte  connection token (0 for Connect)
+ *  Connect    : 8byte nonce, 8byte cookie (from the Challenge, empty at first)
+ *  Challenge  : 8byte nonce, 8byte cookie
+ *  Data       : 1byte channel, 4byte seq, n byte client frames (same framing as PacketParser)
+ *  Ack        : 4byte next expected seq, 4byte received bits of the 32 seqs after it
+ * */
+internal static class UdpDatagram
+{
+    public const int Mtu = 1200;
+    public const int HeaderSize = 1 + 8;
+    public const int ConnectSize = HeaderSize + 8;
+    public const int CookieConnectSize = ConnectSize + 8;
+    public const int ChallengeSize = ConnectSize + 8;
+    public const int DataHeaderSize = HeaderSize + 1 + 4;
+    public const int AckSize = HeaderSize + 4 + 4;
+    public const int MaxSegmentSize = Mtu - DataHeaderSize;
+
+    public static UdpPacketType TypeOf(ReadOnlySpan<byte> datagram)
+    {
+        return (UdpPacketType)datagram[0];
+    }
+
+    public static ulong TokenOf(ReadOnlySpan<byte> datagram)
+    {
+        return BinaryPrimitives.ReadUInt64BigEndian(datagram[1..]);
+    }
+
+    public static int WriteHeader(Span<byte> destination, UdpPacketType type, ulong token)
+    {
+        destination[0] = (byte)type;
+        BinaryPrimitives.WriteUInt64BigEndian(destination[1..], token);
+        return HeaderSize;
+    }
+
+    public static int WriteConnect(Span<byte> destination, ulong token, ulong nonce)
+    {
+        WriteHeader(destination, UdpPacketType.Connect, token);
+        BinaryPrimitives.WriteUInt64BigEndian(destination[HeaderSize..], nonce);
+        return ConnectSize;
+    }
+
+    public static int WriteConnect(Span<byte> destination, ulong token, ulong nonce, ulong cookie)
+    {
+        WriteConnect(destination, token, nonce);
+        BinaryPrimitives.WriteUInt64BigEndian(destination[ConnectSize..], cookie);
+        return CookieConnectSize;
+    }
+
+    public static int WriteChallenge(Span<byte> destination, ulong nonce, ulong cookie)
+    {
+        WriteConnect(destination, 0, nonce, cookie);
+        destination[0] = (byte)UdpPacketType.Challenge;
+        return ChallengeSize;
+    }
+
+    public static ulong NonceOf(ReadOnlySpan<byte> datagram)
+    {
+        return BinaryPrimitives.ReadUInt64BigEndian(datagram[HeaderSize..]);
+    }
+
+    public static ulong CookieOf(ReadOnlySpan<byte> datagram)
+    {
+        return BinaryPrimitives.ReadUInt64BigEndian(datagram[ConnectSize..]);
+    }
+
+    public static int WriteData(Span<byte> destination, ulong token, UdpChannel channel, uint seq,
+        ReadOnlySpan<byte> payload)
+    {
+        WriteHeader(destination, UdpPacketType.Data, token);
+        destination[HeaderSize] = (byte)channel;
+        BinaryPrimitives.WriteUInt32BigEndian(destination[(HeaderSize + 1)..], seq);
+        payload.CopyTo(destination[DataHeaderSize..]);
+        return DataHeaderSize + payload.Length;
+    }
+
+    public static UdpChannel ChannelOf(ReadOnlySpan<byte> datagram)
+    {
+        return (UdpChannel)datagram[HeaderSize];
+    }
+
+    public static uint SeqOf(ReadOnlySpan<byte> datagram)
+    {
+        return BinaryPrimitives.ReadUInt32BigEndian(datagram[(HeaderSize + 1)..]);
+    }
+
+    public static int WriteAck(Span<byte> destination, ulong token, uint nextExpected, uint ackBits)
+    {
+        WriteHeader(destination, UdpPacketType.Ack, token);
+        BinaryPrimitives.WriteUInt32BigEndian(destination[HeaderSize..], nextExpected);
+        BinaryPrimitives.WriteUInt32BigEndian(destination[(HeaderSize + 4)..], ackBits);
+        return AckSize;
+    }
+
+    public static (uint nextExpected, uint ackBits) AckOf(ReadOnlySpan<byte> datagram)
+    {
+        return (BinaryPrimitives.ReadUInt32BigEndian(datagram[HeaderSize..]),
+            BinaryPrimitives.ReadUInt32BigEndian(datagram[(HeaderSize + 4)..]));
+    }
+
+    // seqs can wrap around, so they are compared by difference
+    public static bool IsNewer(uint seq, uint than)
+    {
+        return (int)(seq - than) > 0;
+    }
+}
\ No newline at end of file
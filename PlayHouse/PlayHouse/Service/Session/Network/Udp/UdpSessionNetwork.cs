@@ -0,0 +1,527 @@
+﻿using System.Buffers.Binary;
+using System.Collections.Concurrent;
+using System.Net;
+using System.Net.Sockets;
+using System.Security.Cryptography;
+using CommonLib;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Session;
+
+namespace PlayHouse.Service.Session.Network.udp;
+
+internal class XUdpSession : ISession
+{
+    private readonly object _lock = new();
+    private readonly LOG<XUdpSession> _log = new();
+    private readonly PacketParser _reliableParser = new();
+    private readonly ReliableReceiver _receiver = new();
+    private readonly ReliableSender _sender;
+    private readonly UdpSessionServer _server;
+    private readonly ISessionListener _sessionListener;
+    private readonly HashSet<string> _unreliableMsgIds;
+    private readonly PacketParser _unreliableParser = new();
+    private bool _closed;
+    private bool _hasUnreliable;
+    private long _lastReceivedAt;
+    private uint _lastUnreliableSeq;
+    private Action<ClientPacket>? _onPacket;
+    private uint _unreliableSeq;
+
+    public XUdpSession(UdpSessionServer server, ISessionListener sessionListener, long sid, ulong token, ulong nonce,
+        EndPoint remote, HashSet<string> unreliableMsgIds)
+    {
+        _server = server;
+        _sessionListener = sessionListener;
+        _unreliableMsgIds = unreliableMsgIds;
+        Sid = sid;
+        Token = token;
+        Nonce = nonce;
+        Remote = remote;
+        _lastReceivedAt = Environment.TickCount64;
+        _sender = new ReliableSender(token, SendDatagram);
+    }
+
+    public long Sid { get; }
+    public ulong Token { get; }
+    public ulong Nonce { get; }
+
+    // when the address changes, moves to the address that sent data with a new seq (NAT rebinding)
+    public EndPoint Remote { get; private set; }
+
+    public void ClientDisconnect()
+    {
+        Span<byte> datagram = stackalloc byte[UdpDatagram.HeaderSize];
+        UdpDatagram.WriteHeader(datagram, UdpPacketType.Disconnect, Token);
+        SendDatagram(datagram);
+        Close();
+    }
+
+    public void Send(ClientPacket packet)
+    {
+        using (packet)
+        {
+            var frame = packet.Span;
+            lock (_lock)
+            {
+                if (_closed)
+                {
+                    return;
+                }
+
+                if (frame.Length <= UdpDatagram.MaxSegmentSize && IsUnreliable(packet.Header))
+                {
+                    SendUnreliable(frame);
+                }
+                else
+                {
+                    _sender.Write(frame, Environment.TickCount64);
+                }
+            }
+        }
+    }
+
+    public void SendAccept()
+    {
+        Span<byte> datagram = stackalloc byte[UdpDatagram.HeaderSize];
+        UdpDatagram.WriteHeader(datagram, UdpPacketType.Accept, Token);
+        SendDatagram(datagram);
+    }
+
+    // called only on the receive loop
+    public void OnDatagram(ReadOnlySpan<byte> datagram, EndPoint remote)
+    {
+        // moving on the token alone would let a captured old datagram replayed from another address take the session
+        // from another address only data with a seq not received yet is accepted, and the address moves
+        if (!remote.Equals(Remote))
+        {
+            if (!IsFreshData(datagram))
+            {
+                return;
+            }
+
+            _log.Debug(() => $"UDP session rebind - [Sid:{Sid},from:{Remote},to:{remote}]");
+            Remote = remote;
+        }
+
+        _lastReceivedAt = Environment.TickCount64;
+
+        switch (UdpDatagram.TypeOf(datagram))
+        {
+            case UdpPacketType.Connect:
+                // the client sends Connect again when the Accept is lost
+                SendAccept();
+                break;
+            case UdpPacketType.Data when datagram.Length >= UdpDatagram.DataHeaderSize:
+                OnData(datagram);
+                break;
+            case UdpPacketType.Ack when datagram.Length >= UdpDatagram.AckSize:
+                var (nextExpected, ackBits) = UdpDatagram.AckOf(datagram);
+                lock (_lock)
+                {
+                    _sender.OnAck(nextExpected, ackBits, _lastReceivedAt);
+                }
+
+                break;
+            case UdpPacketType.Disconnect:
+                Close();
+                break;
+        }
+    }
+
+    // resends and connection timeout checks, called from the timer
+    public void Tick(long nowMs, int timeoutMs)
+    {
+        bool alive;
+        lock (_lock)
+        {
+            alive = _closed || _sender.Tick(nowMs);
+        }
+
+        if (!alive)
+        {
+            _log.Debug(() => $"UDP session retransmit over - [Sid:{Sid}]");
+            Close();
+        }
+        else if (nowMs - _lastReceivedAt > timeoutMs)
+        {
+            _log.Debug(() => $"UDP session timeout - [Sid:{Sid}]");
+            Close();
+        }
+    }
+
+    public void Close()
+    {
+        lock (_lock)
+        {
+            if (_closed)
+            {
+                return;
+            }
+
+            _closed = true;
+            _sender.Clear();
+        }
+
+        _server.Remove(this);
+        try
+        {
+            _log.Debug(() => $"UDP session OnDisConnected - [Sid:{Sid}]");
+            _sessionListener.OnDisconnect(Sid);
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => e.ToString());
+        }
+    }
+
+    private bool IsFreshData(ReadOnlySpan<byte> datagram)
+    {
+        if (UdpDatagram.TypeOf(datagram) != UdpPacketType.Data || datagram.Length < UdpDatagram.DataHeaderSize)
+        {
+            return false;
+        }
+
+        var seq = UdpDatagram.SeqOf(datagram);
+        return UdpDatagram.ChannelOf(datagram) == UdpChannel.ReliableOrdered
+            ? _receiver.IsNew(seq)
+            : !_hasUnreliable || UdpDatagram.IsNewer(seq, _lastUnreliableSeq);
+    }
+
+    private void OnData(ReadOnlySpan<byte> datagram)
+    {
+        var seq = UdpDatagram.SeqOf(datagram);
+        var payload = datagram[UdpDatagram.DataHeaderSize..];
+        try
+        {
+            if (UdpDatagram.ChannelOf(datagram) == UdpChannel.ReliableOrdered)
+            {
+                _receiver.OnData(seq, payload, Deliver);
+
+                Span<byte> ack = stackalloc byte[UdpDatagram.AckSize];
+                UdpDatagram.WriteAck(ack, Token, _receiver.NextExpected, _receiver.AckBits());
+                SendDatagram(ack);
+                return;
+            }
+
+            if (_hasUnreliable && !UdpDatagram.IsNewer(seq, _lastUnreliableSeq))
+            {
+                return;
+            }
+
+            _hasUnreliable = true;
+            _lastUnreliableSeq = seq;
+
+            // a datagram must hold whole frames, a leftover piece is dropped
+            _unreliableParser.Parse(payload, _onPacket ??= OnPacket);
+            _unreliableParser.Clear();
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => e.ToString());
+            ClientDisconnect();
+        }
+    }
+
+    private void Deliver(ReadOnlySpan<byte> payload)
+    {
+        _reliableParser.Parse(payload, _onPacket ??= OnPacket);
+    }
+
+    private void OnPacket(ClientPacket packet)
+    {
+        if (_closed)
+        {
+            packet.Dispose();
+            return;
+        }
+
+        _log.Trace(() => $"OnReceive from:client - [packetInfo:{packet.Header}]");
+        _sessionListener.OnReceive(Sid, packet);
+    }
+
+    // replies are always reliable, only registered pushes go unreliable-sequenced
+    private bool IsUnreliable(Header header)
+    {
+        return header.MsgSeq == 0 && _unreliableMsgIds.Contains(header.MsgId);
+    }
+
+    private void SendUnreliable(ReadOnlySpan<byte> frame)
+    {
+        Span<byte> datagram = stackalloc byte[UdpDatagram.Mtu];
+        var length = UdpDatagram.WriteData(datagram, Token, UdpChannel.UnreliableSequenced, _unreliableSeq++, frame);
+        SendDatagram(datagram[..length]);
+    }
+
+    private void SendDatagram(ReadOnlySpan<byte> datagram)
+    {
+        _server.SendTo(datagram, Remote);
+    }
+}
+
+// Connect creates a session only after one cookie round trip (return routability)
+// a Connect with a spoofed address never gets the cookie so it cannot create a session, and no state is kept while handing out cookies
+internal class UdpSessionServer(int port, ISessionListener sessionListener, HashSet<string> unreliableMsgIds,
+    int timeoutMs, int maxConnectsPerSourceSec = 20)
+{
+    private const int TickIntervalMs = 10;
+    private const long CookieSlotMs = 10 * 1000;
+
+    private readonly CancellationTokenSource _cts = new();
+    private readonly LOG<UdpSessionServer> _log = new();
+    private readonly ConcurrentDictionary<ulong, XUdpSession> _byNonce = new();
+    private readonly Dictionary<IPAddress, int> _connectsBySource = new(); // used only on the receive loop
+    private readonly byte[] _cookieSecret = RandomNumberGenerator.GetBytes(32);
+    private readonly ConcurrentDictionary<ulong, XUdpSession> _sessions = new();
+    private long _connectWindowAt;
+    private long _lastSid;
+    private Socket? _socket;
+    private Timer? _timer;
+
+    public int Port => (_socket?.LocalEndPoint as IPEndPoint)?.Port ?? port;
+    public int SessionCount => _sessions.Count;
+
+    public void Start()
+    {
+        _socket = new Socket(AddressFamily.InterNetworkV6, SocketType.Dgram, ProtocolType.Udp);
+        _socket.DualMode = true;
+        _socket.ReceiveBufferSize = 1024 * 1024;
+        _socket.SendBufferSize = 1024 * 1024;
+        _socket.Bind(new IPEndPoint(IPAddress.IPv6Any, port));
+
+        _timer = new Timer(_ => OnTick(), null, TickIntervalMs, TickIntervalMs);
+        Task.Factory.StartNew(ReceiveLoop, TaskCreationOptions.LongRunning);
+        _log.Info(() => $"Server Started - [port:{Port}]");
+    }
+
+    public void Stop()
+    {
+        _cts.Cancel();
+        _timer?.Dispose();
+        foreach (var session in _sessions.Values)
+        {
+            session.ClientDisconnect();
+        }
+
+        _socket?.Close();
+    }
+
+    public void SendTo(ReadOnlySpan<byte> datagram, EndPoint remote)
+    {
+        try
+        {
+            _socket?.SendTo(datagram, SocketFlags.None, remote);
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => $"send error - [to:{remote}] - {e.Message}");
+        }
+    }
+
+    public void Remove(XUdpSession session)
+    {
+        _sessions.TryRemove(session.Token, out _);
+        _byNonce.TryRemove(session.Nonce, out _);
+    }
+
+    private void ReceiveLoop()
+    {
+        var buffer = new byte[64 * 1024];
+        EndPoint any = new IPEndPoint(IPAddress.IPv6Any, 0);
+
+        while (!_cts.IsCancellationRequested)
+        {
+            int size;
+            EndPoint remote = any;
+            try
+            {
+                size = _socket!.ReceiveFrom(buffer, SocketFlags.None, ref remote);
+            }
+            catch (SocketException e) when (e.SocketErrorCode == SocketError.ConnectionReset)
+            {
+                // icmp saying the peer is closed, cleaned up by the timeout
+                continue;
+            }
+            catch (Exception e) when (e is ObjectDisposedException or SocketException)
+            {
+                break;
+            }
+
+            try
+            {
+                OnDatagram(buffer.AsSpan(0, size), remote);
+            }
+            catch (Exception e)
+            {
+                _log.Error(() => e.ToString());
+            }
+        }
+    }
+
+    private void OnDatagram(ReadOnlySpan<byte> datagram, EndPoint remote)
+    {
+        if (datagram.Length < UdpDatagram.HeaderSize)
+        {
+            return;
+        }
+
+        var token = UdpDatagram.TokenOf(datagram);
+        if (token == 0)
+        {
+            if (UdpDatagram.TypeOf(datagram) == UdpPacketType.Connect && datagram.Length >= UdpDatagram.ConnectSize)
+            {
+                OnConnect(datagram, remote);
+            }
+
+            return;
+        }
+
+        // tokens that were never issued are ignored
+        if (_sessions.TryGetValue(token, out var session))
+        {
+            session.OnDatagram(datagram, remote);
+        }
+    }
+
+    private void OnConnect(ReadOnlySpan<byte> datagram, EndPoint remote)
+    {
+        var nonce = UdpDatagram.NonceOf(datagram);
+        var now = Environment.TickCount64;
+
+        if (datagram.Length < UdpDatagram.CookieConnectSize)
+        {
+            Span<byte> challenge = stackalloc byte[UdpDatagram.ChallengeSize];
+            UdpDatagram.WriteChallenge(challenge, nonce, CookieOf(remote, nonce, now / CookieSlotMs));
+            SendTo(challenge, remote);
+            return;
+        }
+
+        // cookies of the previous slot are accepted too, so a cookie received right at a slot change is not rejected
+        var cookie = UdpDatagram.CookieOf(datagram);
+        var slot = now / CookieSlotMs;
+        if (cookie != CookieOf(remote, nonce, slot) && cookie != CookieOf(remote, nonce, slot - 1))
+        {
+            return;
+        }
+
+        if (_byNonce.TryGetValue(nonce, out var session))
+        {
+            session.SendAccept();
+            return;
+        }
+
+        if (!AllowConnect(((IPEndPoint)remote).Address, now))
+        {
+            _log.Debug(() => $"UDP connect rate limited - [remote:{remote}]");
+            return;
+        }
+
+        var token = NewToken();
+        session = new XUdpSession(this, sessionListener, Interlocked.Increment(ref _lastSid), token, nonce, remote,
+            unreliableMsgIds);
+        _sessions[token] = session;
+        _byNonce[nonce] = session;
+
+        try
+        {
+            _log.Debug(() => $"UDP session OnConnected - [Sid:{session.Sid},remote:{remote}]");
+            sessionListener.OnConnect(session.Sid, session);
+        }
+        catch (Exception e)
+        {
+            _log.Error(() => e.ToString());
+        }
+
+        session.SendAccept();
+    }
+
+    private ulong CookieOf(EndPoint remote, ulong nonce, long slot)
+    {
+        var endpoint = (IPEndPoint)remote;
+        Span<byte> data = stackalloc byte[16 + 2 + 8 + 8];
+        endpoint.Address.MapToIPv6().TryWriteBytes(data, out _);
+        BinaryPrimitives.WriteUInt16BigEndian(data[16..], (ushort)endpoint.Port);
+        BinaryPrimitives.WriteUInt64BigEndian(data[18..], nonce);
+        BinaryPrimitives.WriteInt64BigEndian(data[26..], slot);
+
+        Span<byte> hash = stackalloc byte[32];
+        HMACSHA256.HashData(_cookieSecret, data, hash);
+        return BinaryPrimitives.ReadUInt64BigEndian(hash);
+    }
+
+    // limits the sessions one address can create per second
+    private bool AllowConnect(IPAddress source, long now)
+    {
+        if (now - _connectWindowAt >= 1000)
+        {
+            _connectWindowAt = now;
+            _connectsBySource.Clear();
+        }
+
+        _connectsBySource.TryGetValue(source, out var count);
+        if (count >= maxConnectsPerSourceSec)
+        {
+            return false;
+        }
+
+        _connectsBySource[source] = count + 1;
+        return true;
+    }
+
+    private ulong NewToken()
+    {
+        Span<byte> bytes = stackalloc byte[8];
+        ulong token;
+        do
+        {
+            RandomNumberGenerator.Fill(bytes);
+            token = BitConverter.ToUInt64(bytes);
+        } while (token == 0 || _sessions.ContainsKey(token));
+
+        return token;
+    }
+
+    private void OnTick()
+    {
+        var now = Environment.TickCount64;
+        foreach (var session in _sessions.Values)
+        {
+            try
+            {
+                session.Tick(now, timeoutMs);
+            }
+            catch (Exception e)
+            {
+                _log.Error(() => e.ToString());
+            }
+        }
+    }
+}
+
+internal class UdpSessionNetwork(SessionOption sessionOption, ISessionListener sessionListener) : ISessionNetwork
+{
+    private readonly LOG<UdpSessionNetwork> _log = new();
+
+    private readonly UdpSessionServer _udpSessionServer = new(sessionOption.SessionPort, sessionListener,
+        sessionOption.UdpUnreliableMsgIds.ToHashSet(), sessionOption.UdpTimeoutMSec,
+        sessionOption.UdpMaxConnectsPerSourceSec);
+
+    public void Start()
+    {
+        try
+        {
+            _udpSessionServer.Start();
+            _log.Info(() => "UdpSessionNetwork Start");
+        }
+        catch (Exception e)
+        {
+            _log.Fatal(() => $"Session Server Start Fail - {e.Message}");
+            Environment.Exit(0);
+        }
+    }
+
+    public void Stop()
+    {
+        _log.Info(() => "UdpSessionNetwork StopAsync");
+        _udpSessionServer.Stop();
+    }
+}
\ No newline at end of file
@@ -1,5 +1,4 @@
 ﻿using System.Net.Sockets;
-using CommonLib;
 using NetCoreServer;
 using PlayHouse.Communicator.Message;
 using PlayHouse.Production.Session;
@@ -7,35 +6,98 @@ using PlayHouse.Utils;
 
 namespace PlayHouse.Service.Session.Network.websocket;
 
-internal class XWsSession(WsSessionServer server, ISessionListener sessionListener) : WsSession(server), ISession
+// without binaryMode frames go over a raw tcp stream without a handshake (the old behavior)
+// with binaryMode frames go in websocket binary messages, one message can hold several frames
+internal class XWsSession(WsSessionServer server, ISessionListener sessionListener, bool binaryMode,
+    SendFlusher? sendFlusher = null, int sendFlushBytes = 0) : WsSession(server), ISession, IBatchSender
 {
-    private readonly RingBuffer _buffer = new(1024 * 4, PacketConst.MaxPacketSize);
+    private const int DisconnectFlushTimeoutMs = 3000;
+
     private readonly LOG<XWsSession> _log = new();
     private readonly PacketParser _packetParser = new();
+    private volatile bool _disconnectOnEmpty;
+    private Action<ClientPacket>? _onPacket;
+    private SendBatch? _sendBatch;
 
+    // disconnects after the batched frames and the send buffer are sent, a client that stops reading is cut by timeout
     public void ClientDisconnect()
     {
-        base.Disconnect();
+        _sendBatch?.Flush();
+        _disconnectOnEmpty = true;
+        if (BytesPending + BytesSending == 0)
+        {
+            base.Disconnect();
+            return;
+        }
+
+        Task.Delay(DisconnectFlushTimeoutMs).ContinueWith(_ => base.Disconnect());
+    }
+
+    protected override void OnEmpty()
+    {
+        if (_disconnectOnEmpty)
+        {
+            base.Disconnect();
+        }
     }
 
     public void Send(ClientPacket packet)
     {
         using (packet)
         {
-            base.Send(packet.Span);
+            if (_sendBatch != null)
+            {
+                _sendBatch.Write(packet.Span);
+            }
+            else
+            {
+                SendFrames(packet.Span);
+            }
+        }
+    }
+
+    // batched frames go out as one binary message
+    public void SendFrames(ReadOnlySpan<byte> frames)
+    {
+        if (binaryMode)
+        {
+            SendBinaryAsync(frames);
+        }
+        else
+        {
+            base.SendAsync(frames);
         }
     }
 
-    private int GetSid()
+    private long GetSid()
     {
-        return (int)Socket.Handle;
+        return Socket.Handle.ToInt64();
     }
 
     protected override void OnConnected()
+    {
+        if (!binaryMode)
+        {
+            OnSessionOpened();
+        }
+    }
+
+    // binary mode opens the session once the handshake is done
+    public override void OnWsConnected(HttpRequest request)
+    {
+        OnSessionOpened();
+    }
+
+    private void OnSessionOpened()
     {
         try
         {
             _log.Debug(() => $"WS session OnConnected - [Sid:{GetSid()}]");
+            if (sendFlusher != null)
+            {
+                _sendBatch = new SendBatch(this, sendFlusher, sendFlushBytes);
+            }
+
             sessionListener.OnConnect(GetSid(), this);
         }
         catch (Exception e)
@@ -46,10 +108,17 @@ internal class XWsSession(WsSessionServer server, ISessionListener sessionListen
 
     protected override void OnDisconnected()
     {
+        if (binaryMode)
+        {
+            base.OnDisconnected();
+        }
+
         try
         {
             _log.Debug(() => $"WS session OnDisConnected - [Sid:{GetSid()}]");
             sessionListener.OnDisconnect(GetSid());
+            _packetParser.Clear();
+            _sendBatch?.Close();
         }
         catch (Exception e)
         {
@@ -58,22 +127,42 @@ internal class XWsSession(WsSessionServer server, ISessionListener sessionListen
     }
 
     protected override void OnReceived(byte[] buffer, long offset, long size)
+    {
+        if (binaryMode)
+        {
+            // WsSession handles the handshake and websocket framing and hands messages to OnWsReceived
+            base.OnReceived(buffer, offset, size);
+            return;
+        }
+
+        Parse(buffer, offset, size);
+    }
+
+    // parses straight from the received message, only frames spanning message boundaries are gathered separately
+    public override void OnWsReceived(byte[] buffer, long offset, long size)
+    {
+        Parse(buffer, offset, size);
+    }
+
+    private void Parse(byte[] buffer, long offset, long size)
     {
         try
         {
-            _buffer.Write(buffer, (int)offset, (int)size);
-            var packets = _packetParser.Parse(_buffer);
-            foreach (var packet in packets)
-            {
-                sessionListener.OnReceive(GetSid(), packet);
-            }
+            _packetParser.Parse(buffer.AsSpan((int)offset, (int)size), _onPacket ??= OnPacket);
         }
         catch (Exception e)
         {
             _log.Error(() => e.ToString());
+            Disconnect();
         }
     }
 
+    private void OnPacket(ClientPacket packet)
+    {
+        _log.Trace(() => $"OnReceive from:client - [packetInfo:{packet.Header}]");
+        sessionListener.OnReceive(GetSid(), packet);
+    }
+
     protected override void OnError(SocketError error)
     {
         try
@@ -90,11 +179,23 @@ internal class XWsSession(WsSessionServer server, ISessionListener sessionListen
 
 internal class WsSessionServer : WsServer
 {
+    private readonly LOG<WsSessionServer> _log = new();
+
+    private readonly bool _binaryMode;
+    private readonly SendFlusher? _sendFlusher;
+    private readonly int _sendFlushBytes;
     private readonly ISessionListener _sessionListener;
 
-    public WsSessionServer(string address, int port, ISessionListener sessionListener) : base(address, port)
+    public WsSessionServer(string address, int port, ISessionListener sessionListener, bool binaryMode = false,
+        int sendFlushBytes = 0, int sendFlushMicros = 0) : base(address, port)
     {
         _sessionListener = sessionListener;
+        _binaryMode = binaryMode;
+        _sendFlushBytes = sendFlushBytes;
+        if (sendFlushBytes > 0)
+        {
+            _sendFlusher = new SendFlusher(sendFlushMicros);
+        }
 
         OptionNoDelay = true;
         OptionReuseAddress = true;
@@ -107,7 +208,18 @@ internal class WsSessionServer : WsServer
 
     protected override WsSession CreateSession()
     {
-        return new XWsSession(this, _sessionListener);
+        return new XWsSession(this, _sessionListener, _binaryMode, _sendFlusher, _sendFlushBytes);
+    }
+
+    protected override void OnStarted()
+    {
+        _sendFlusher?.Start();
+        _log.Info(() => "Server Started");
+    }
+
+    protected override void OnStopped()
+    {
+        _sendFlusher?.Stop();
     }
 }
 
@@ -115,7 +227,8 @@ internal class WsSessionNetwork(SessionOption sessionOption, ISessionListener se
     : ISessionNetwork
 {
     private readonly LOG<WsSessionNetwork> _log = new();
-    private readonly WsSessionServer _wsSessionServer = new("0.0.0.0", sessionOption.SessionPort, sessionListener);
+    private readonly WsSessionServer _wsSessionServer = new("0.0.0.0", sessionOption.SessionPort, sessionListener,
+        sessionOption.WebSocketBinaryMode, sessionOption.SendFlushBytes, sessionOption.SendFlushMicros);
 
     public void Start()
     {
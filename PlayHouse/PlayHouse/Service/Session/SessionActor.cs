@@ -1,6 +1,4 @@
-﻿using System.Collections.Concurrent;
-using System.Diagnostics;
-using PlayHouse.Communicator;
+﻿using PlayHouse.Communicator;
 using PlayHouse.Communicator.Message;
 using PlayHouse.Production.Shared;
 using Playhouse.Protocol;
@@ -34,10 +32,16 @@ internal class StageIndexGenerator
 
 internal class SessionActor
 {
+    // base packets are compared by the MsgIdRegistry id cached in the header
+    private static readonly int AuthenticateMsgNum = MsgIdRegistry.IdOf(AuthenticateMsg.Descriptor.Name);
+    private static readonly int SessionCloseMsgNum = MsgIdRegistry.IdOf(SessionCloseMsg.Descriptor.Name);
+    private static readonly int JoinStageInfoUpdateReqNum = MsgIdRegistry.IdOf(JoinStageInfoUpdateReq.Descriptor.Name);
+    private static readonly int LeaveStageMsgNum = MsgIdRegistry.IdOf(LeaveStageMsg.Descriptor.Name);
+
     private readonly PooledByteBuffer _heartbeatBuffer = new(100);
     private readonly AtomicBoolean _isUsing = new(false);
     private readonly LOG<SessionActor> _log = new();
-    private readonly ConcurrentQueue<RoutePacket> _msgQueue = new();
+    private readonly Mailbox _mailbox;
 
     private readonly Dictionary<long, TargetAddress> _playEndpoints = new();
     private readonly IServerInfoCenter _serviceInfoCenter;
@@ -45,12 +49,16 @@ internal class SessionActor
 
     private readonly XSessionSender _sessionSender;
     private readonly HashSet<string> _signInUrIs = new();
+    private readonly TokenBucket? _rateLimiter;
     private readonly StageIndexGenerator _stageIndexGenerator = new();
     private readonly TargetServiceCache _targetServiceCache;
+    private readonly int _compressThreshold;
     private ushort _authenticateServiceId;
     private string _authServerEndpoint = "";
+    private bool _compressEnabled;
     private bool _debugMode;
-    private Stopwatch _lastUpdateTime = new();
+    private volatile bool _isClosed;
+    private long _lastReceivedMs = Environment.TickCount64;
 
     public SessionActor(
         ushort serviceId,
@@ -59,7 +67,10 @@ internal class SessionActor
         ISession session,
         IClientCommunicator clientCommunicator,
         List<string> urls,
-        RequestCache reqCache
+        RequestCache reqCache,
+        int maxPacketsPerSecond = 0,
+        int packetBurst = 0,
+        int compressThreshold = 0
     )
     {
         Sid = sid;
@@ -67,9 +78,16 @@ internal class SessionActor
         _session = session;
 
         _sessionSender = new XSessionSender(serviceId, clientCommunicator, reqCache);
+        _mailbox = new Mailbox(serviceId, clientCommunicator) { ClientReplyDropped = OnReplyDropped };
         _targetServiceCache = new TargetServiceCache(serviceInfoCenter);
 
         _signInUrIs.UnionWith(urls);
+        _compressThreshold = compressThreshold;
+
+        if (maxPacketsPerSecond > 0)
+        {
+            _rateLimiter = new TokenBucket(maxPacketsPerSecond, packetBurst > 0 ? packetBurst : maxPacketsPerSecond);
+        }
     }
 
     public bool IsAuthenticated { get; private set; }
@@ -78,6 +96,11 @@ internal class SessionActor
 
     internal long Sid { get; }
 
+    internal bool IsClosed => _isClosed;
+
+    // last receive time, written per packet and read by SessionIdleTracker only when a deadline is due
+    internal long LastReceivedMs => Volatile.Read(ref _lastReceivedMs);
+
 
     private void Authenticate(ushort serviceId, string apiEndpoint, long accountId)
     {
@@ -86,7 +109,8 @@ internal class SessionActor
         _authenticateServiceId = serviceId;
         _authServerEndpoint = apiEndpoint;
 
-        _lastUpdateTime.Start();
+        // idle time is measured from authentication on
+        Volatile.Write(ref _lastReceivedMs, Environment.TickCount64);
     }
 
     private void UpdateStageInfo(string playEndpoint, long stageId)
@@ -96,6 +120,7 @@ internal class SessionActor
 
     public void Disconnect()
     {
+        _isClosed = true;
         if (IsAuthenticated)
         {
             var serverInfo = FindSuitableServer(_authenticateServiceId, _authServerEndpoint);
@@ -124,7 +149,7 @@ internal class SessionActor
             var serviceId = clientPacket.ServiceId;
             var msgId = clientPacket.MsgId;
 
-            _lastUpdateTime.Restart();
+            Volatile.Write(ref _lastReceivedMs, Environment.TickCount64);
 
             if (msgId == PacketConst.HeartBeat) //heartbeat
             {
@@ -132,6 +157,12 @@ internal class SessionActor
                 return;
             }
 
+            if (msgId == PacketConst.Compression)
+            {
+                NegotiateCompression(clientPacket);
+                return;
+            }
+
             if (msgId == PacketConst.Debug) //debug mode
             {
                 _log.Debug(() => $"session is debug mode - [sid:{Sid}]");
@@ -139,6 +170,12 @@ internal class SessionActor
                 return;
             }
 
+            if (_rateLimiter != null && !_rateLimiter.TryTake())
+            {
+                OnRateLimited(clientPacket);
+                return;
+            }
+
             if (IsAuthenticated)
             {
                 RelayTo(serviceId, clientPacket);
@@ -182,6 +219,52 @@ internal class SessionActor
         _heartbeatBuffer.Clear();
     }
 
+    // the client says it accepts compressed frames, answered with NotSupported when compression is off on the server
+    private void NegotiateCompression(ClientPacket clientPacket)
+    {
+        _compressEnabled = _compressThreshold > 0;
+        _log.Debug(() => $"compression negotiated - [sid:{Sid},enabled:{_compressEnabled}]");
+
+        var header = clientPacket.Header;
+        var errorCode = _compressEnabled ? (ushort)BaseErrorCode.Success : (ushort)BaseErrorCode.NotSupported;
+        var reply = new ClientPacket(new Header(header.ServiceId, header.MsgId, header.MsgSeq, errorCode,
+            header.StageId), new EmptyPayload());
+        RoutePacket.WriteClientPacketBytes(reply, _heartbeatBuffer);
+        SendToClient(new ClientPacket(reply.Header, new PooledBytePayload(_heartbeatBuffer)));
+        _heartbeatBuffer.Clear();
+    }
+
+    private void OnRateLimited(ClientPacket clientPacket)
+    {
+        _log.Warn(() => $"too many packets from session - [sid:{Sid},accountId:{AccountId},msgId:{clientPacket.MsgId}]");
+
+        if (_mailbox.Policy == MailboxOverflowPolicy.Disconnect)
+        {
+            _session.ClientDisconnect();
+            return;
+        }
+
+        if (clientPacket.MsgSeq != 0)
+        {
+            var header = clientPacket.Header;
+            var reply = new ClientPacket(new Header(header.ServiceId, header.MsgId, header.MsgSeq,
+                (ushort)BaseErrorCode.TooManyRequests, header.StageId), new EmptyPayload());
+            RoutePacket.WriteClientPacketBytes(reply, _heartbeatBuffer);
+            SendToClient(new ClientPacket(reply.Header, new PooledBytePayload(_heartbeatBuffer)));
+            _heartbeatBuffer.Clear();
+        }
+    }
+
+    // a reply dropped by a full mailbox, called on the sender's thread so _heartbeatBuffer is not used
+    private void OnReplyDropped(Header header)
+    {
+        var reply = new ClientPacket(new Header(header.ServiceId, header.MsgId, header.MsgSeq,
+            (ushort)BaseErrorCode.ServerBusy, header.StageId), new EmptyPayload());
+        var buffer = new PooledByteBuffer(100);
+        RoutePacket.WriteClientPacketBytes(reply, buffer);
+        SendToClient(new ClientPacket(reply.Header, new PooledBytePayload(buffer)));
+    }
+
     private IServerInfo FindSuitableServer(ushort serviceId, string endpoint)
     {
         IServerInfo serverInfo = _serviceInfoCenter.FindServer(endpoint);
@@ -204,7 +287,7 @@ internal class SessionActor
             case ServiceType.API:
                 if (string.IsNullOrEmpty(_authServerEndpoint))
                 {
-                    serverInfo = _serviceInfoCenter.FindRoundRobinServer(serviceId);
+                    serverInfo = _serviceInfoCenter.FindServerBy(serviceId);
                 }
                 else
                 {
@@ -235,15 +318,29 @@ internal class SessionActor
         }
     }
 
+    internal int QueueCount => _mailbox.Count;
+
     public void Post(RoutePacket routePacket)
     {
-        _msgQueue.Enqueue(routePacket);
+        PlayMetrics.OnPosted(routePacket);
+        if (!_mailbox.Post(routePacket))
+        {
+            // a slow session that does not take the packets sent to its client
+            if (_mailbox.Policy == MailboxOverflowPolicy.Disconnect)
+            {
+                _session.ClientDisconnect();
+            }
+
+            return;
+        }
+
         if (_isUsing.CompareAndSet(false, true))
         {
             Task.Run(async () =>
             {
-                while (_msgQueue.TryDequeue(out var item))
+                while (_mailbox.TryDequeue(out var item))
                 {
+                    PlayMetrics.OnDequeued(item, "session");
                     try
                     {
                         using (item)
@@ -268,23 +365,24 @@ internal class SessionActor
     public async Task DispatchAsync(RoutePacket packet)
     {
         var msgId = packet.MsgId;
+        var msgNum = packet.Header.MsgNum;
         var isBase = packet.IsBase();
 
         if (isBase)
         {
-            if (msgId == AuthenticateMsg.Descriptor.Name)
+            if (msgNum == AuthenticateMsgNum)
             {
                 var authenticateMsg = AuthenticateMsg.Parser.ParseFrom(packet.Span);
                 var apiEndpoint = packet.RouteHeader.From;
                 Authenticate((ushort)authenticateMsg.ServiceId, apiEndpoint, authenticateMsg.AccountId);
                 _log.Debug(() => $"session authenticated - [accountId:{AccountId}]");
             }
-            else if (msgId == SessionCloseMsg.Descriptor.Name)
+            else if (msgNum == SessionCloseMsgNum)
             {
                 _session.ClientDisconnect();
                 _log.Debug(() => $"force session close - [accountId:{AccountId}]");
             }
-            else if (msgId == JoinStageInfoUpdateReq.Descriptor.Name)
+            else if (msgNum == JoinStageInfoUpdateReqNum)
             {
                 var joinStageMsg = JoinStageInfoUpdateReq.Parser.ParseFrom(packet.Span);
                 var playEndpoint = joinStageMsg.PlayEndpoint;
@@ -296,7 +394,7 @@ internal class SessionActor
                 _log.Debug(() =>
                     $"stageInfo updated - [accountId:{AccountId},playEndpoint:{playEndpoint},stageId:{stageId}");
             }
-            else if (msgId == LeaveStageMsg.Descriptor.Name)
+            else if (msgNum == LeaveStageMsgNum)
             {
                 var stageId = LeaveStageMsg.Parser.ParseFrom(packet.Span).StageId;
                 ClearRoomInfo(stageId);
@@ -329,42 +427,25 @@ internal class SessionActor
         using (clientPacket)
         {
             _log.Trace(() => $"sendTo:client - [accountId:{AccountId},packetInfo:{clientPacket.Header}]");
-            _session.Send(clientPacket);
-        }
-    }
-
-    internal bool IsIdleState(int idleTime)
-    {
-        if (IsAuthenticated == false)
-        {
-            return false;
-        }
-
-        if (_debugMode)
-        {
-            return false;
-        }
-
-        if (idleTime <= 0)
-        {
-            return false;
-        }
+            if (_compressEnabled)
+            {
+                var compressed = FrameCompression.CompressFrame(clientPacket.Span, _compressThreshold, out var size);
+                if (compressed != null)
+                {
+                    _session.Send(new ClientPacket(clientPacket.Header, new RentedPayload(compressed, size)));
+                    return;
+                }
+            }
 
-        if (_lastUpdateTime.ElapsedMilliseconds > idleTime)
-        {
-            return true;
+            _session.Send(clientPacket);
         }
-
-        return false;
     }
 
-    //internal void UpdateHeartBeatTime()
-    //{
-    //    _lastUpdateTime = DateTime.UtcNow;
-    //}
+    // sessions before authentication or in debug mode are never cut for idling
+    internal bool IsIdleTarget => IsAuthenticated && !_debugMode;
 
     internal long IdleTime()
     {
-        return _lastUpdateTime.ElapsedMilliseconds;
+        return Environment.TickCount64 - LastReceivedMs;
     }
 }
\ No newline at end of file
@@ -14,6 +14,8 @@ internal class SessionDispatcher : ISessionListener
     private readonly LOG<SessionDispatcher> _log = new();
     private readonly RequestCache _requestCache;
     private readonly IServerInfoCenter _serverInfoCenter;
+    private readonly SessionIdleTracker _idleTracker;
+    private readonly IDisposable _mailboxMetric;
     private readonly ushort _serviceId;
     private readonly ConcurrentDictionary<long, SessionActor> _sessionActors = new();
     private readonly SessionNetwork _sessionNetwork;
@@ -35,21 +37,30 @@ internal class SessionDispatcher : ISessionListener
 
         _sessionNetwork = new SessionNetwork(sessionOption, this);
 
-        _timer = new Timer(TimerCallback, this, 1000, 1000);
+        _idleTracker = new SessionIdleTracker(sessionOption.ClientIdleTimeoutMSec,
+            sessionOption.HeartBeatTimeoutMSec, OnIdleTimeout, Environment.TickCount64);
+        _timer = new Timer(TimerCallback, this, SessionIdleTracker.TickMs, SessionIdleTracker.TickMs);
+
+        _mailboxMetric = PlayMetrics.ObserveMailbox("session", () => _sessionActors.Values.Sum(e => (long)e.QueueCount));
     }
 
     public void OnConnect(long sid, ISession session)
     {
         if (!_sessionActors.ContainsKey(sid))
         {
-            _sessionActors[sid] = new SessionActor(
+            var sessionActor = new SessionActor(
                 _serviceId,
                 sid,
                 _serverInfoCenter,
                 session,
                 _clientCommunicator,
                 _sessionOption.Urls,
-                _requestCache);
+                _requestCache,
+                _sessionOption.MaxPacketsPerSecond,
+                _sessionOption.PacketBurst,
+                _sessionOption.CompressThreshold);
+            _sessionActors[sid] = sessionActor;
+            _idleTracker.Track(sessionActor);
         }
         else
         {
@@ -84,28 +95,26 @@ internal class SessionDispatcher : ISessionListener
     {
         _sessionNetwork.Stop();
         _timer.Dispose();
+        _mailboxMetric.Dispose();
     }
 
 
     private static void TimerCallback(object? o)
     {
         var dispacher = (SessionDispatcher)o!;
-        // 여기에 타이머 만료 시 실행할 코드 작성
-        var keysToRemove =
-            dispacher._sessionActors.Where(k => k.Value.IsIdleState(dispacher._sessionOption.ClientIdleTimeoutMSec))
-                .Select(k => k.Key).ToList();
+        dispacher._idleTracker.Advance(Environment.TickCount64);
+    }
 
-        foreach (var key in keysToRemove)
+    private void OnIdleTimeout(SessionActor client)
+    {
+        if (!_sessionActors.TryRemove(new KeyValuePair<long, SessionActor>(client.Sid, client)))
         {
-            SessionActor? client;
-            dispacher._sessionActors.Remove(key, out client);
-            if (client != null)
-            {
-                dispacher._log.Debug(() =>
-                    $"idle client disconnect - [sid:{client.Sid},accountId:{client.AccountId},idleTime:{client.IdleTime()}]");
-                client.ClientDisconnect();
-            }
+            return;
         }
+
+        _log.Debug(() =>
+            $"idle client disconnect - [sid:{client.Sid},accountId:{client.AccountId},idleTime:{client.IdleTime()}]");
+        client.ClientDisconnect();
     }
 
 
@@ -133,6 +142,12 @@ internal class SessionDispatcher : ISessionListener
     {
         using (routePacket)
         {
+            if (routePacket.RouteHeader.Sids != null)
+            {
+                FanOut(routePacket);
+                return;
+            }
+
             var sessionId = routePacket.RouteHeader.Sid;
             if (!_sessionActors.TryGetValue(sessionId, out var sessionClient))
             {
@@ -146,4 +161,24 @@ internal class SessionDispatcher : ISessionListener
             }
         }
     }
+
+    // broadcast packet, every session gets its own packet over the same client frame bytes
+    // the source payload can be a pooled buffer that is returned when routePacket is disposed,
+    // so the body is copied once into an array owned by the copies
+    private void FanOut(RoutePacket routePacket)
+    {
+        ReadOnlyMemory<byte> data = routePacket.Payload.Data.ToArray();
+        var msgId = routePacket.MsgId;
+        foreach (var sid in routePacket.RouteHeader.Sids!)
+        {
+            if (_sessionActors.TryGetValue(sid, out var sessionClient))
+            {
+                sessionClient.Post(RoutePacket.FanOutOf(routePacket, sid, new MemoryPayload(data)));
+            }
+            else
+            {
+                _log.Debug(() => $"sessionId is already disconnected - [sessionId:{sid},msgId:{msgId}]");
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+﻿using System.Collections.Concurrent;
+using PlayHouse.Service.Shared;
+
+namespace PlayHouse.Service.Session;
+
+internal class IdleEntry(SessionActor actor) : IWheelEntry
+{
+    public SessionActor Actor { get; } = actor;
+    public long DeadlineTick { get; set; }
+    public bool IsCanceled => Actor.IsClosed;
+}
+
+/// <summary>
+///     Checks session idle / heartbeat timeouts on a TimerWheel.
+///     A session only records when it last received something, here only sessions whose deadline slot expired are looked at.
+///     If a packet arrived in between the entry is put back with the new deadline, so a session is checked once per timeout.
+///     Closed sessions come back from the wheel as canceled entries and are dropped from Count.
+///     Track can be called from any thread, Advance only from the timer.
+/// </summary>
+internal class SessionIdleTracker
+{
+    public const int TickMs = 100;
+
+    private readonly ConcurrentQueue<IdleEntry> _added = new();
+    private readonly List<IdleEntry> _expired = new();
+    private readonly int _heartBeatTimeoutMs;
+    private readonly int _idleTimeoutMs;
+    private readonly Action<SessionActor> _onTimeout;
+    private readonly TimerWheel<IdleEntry> _wheel;
+    private int _advancing;
+
+    // idleTimeoutMs : disconnects an authenticated session that sends nothing for this long, 0 disables the check
+    // heartBeatTimeoutMs : disconnects any session that receives nothing (heartbeat included) for this long, 0 disables the check
+    public SessionIdleTracker(int idleTimeoutMs, int heartBeatTimeoutMs, Action<SessionActor> onTimeout, long nowMs)
+    {
+        _idleTimeoutMs = idleTimeoutMs;
+        _heartBeatTimeoutMs = heartBeatTimeoutMs;
+        _onTimeout = onTimeout;
+        _wheel = new TimerWheel<IdleEntry>(nowMs / TickMs);
+    }
+
+    public bool Enabled => _idleTimeoutMs > 0 || _heartBeatTimeoutMs > 0;
+    public int Count { get; private set; }
+
+    public void Track(SessionActor actor)
+    {
+        if (Enabled)
+        {
+            _added.Enqueue(new IdleEntry(actor));
+        }
+    }
+
+    public void Advance(long nowMs)
+    {
+        // if timer callbacks overlap the late one is skipped
+        if (Interlocked.Exchange(ref _advancing, 1) == 1)
+        {
+            return;
+        }
+
+        try
+        {
+            while (_added.TryDequeue(out var entry))
+            {
+                Count++;
+                Arm(entry, nowMs);
+            }
+
+            var targetTick = nowMs / TickMs;
+            while (_wheel.CurrentTick < targetTick)
+            {
+                _wheel.Advance(_expired);
+                foreach (var entry in _expired)
+                {
+                    Check(entry, nowMs);
+                }
+
+                _expired.Clear();
+            }
+        }
+        finally
+        {
+            Volatile.Write(ref _advancing, 0);
+        }
+    }
+
+    private void Check(IdleEntry entry, long nowMs)
+    {
+        if (entry.IsCanceled)
+        {
+            Count--;
+            return;
+        }
+
+        if (DeadlineOf(entry.Actor, nowMs) <= nowMs)
+        {
+            Count--;
+            _onTimeout(entry.Actor);
+            return;
+        }
+
+        Arm(entry, nowMs);
+    }
+
+    private void Arm(IdleEntry entry, long nowMs)
+    {
+        // rounded up so the deadline has passed when the entry is handed out
+        var deadlineTick = (DeadlineOf(entry.Actor, nowMs) + TickMs - 1) / TickMs;
+        entry.DeadlineTick = Math.Max(deadlineTick, _wheel.CurrentTick + 1);
+        _wheel.Add(entry);
+    }
+
+    // based on the last received time, sessions that are not idle targets (not authenticated, debug) are looked at again after the idle timeout
+    private long DeadlineOf(SessionActor actor, long nowMs)
+    {
+        var lastReceived = actor.LastReceivedMs;
+        var deadline = long.MaxValue;
+        if (_heartBeatTimeoutMs > 0)
+        {
+            deadline = lastReceived + _heartBeatTimeoutMs;
+        }
+
+        if (_idleTimeoutMs > 0)
+        {
+            deadline = Math.Min(deadline, actor.IsIdleTarget ? lastReceived + _idleTimeoutMs : nowMs + _idleTimeoutMs);
+        }
+
+        return deadline;
+    }
+}
\ No newline at end of file
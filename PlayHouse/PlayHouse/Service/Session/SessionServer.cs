@@ -1,5 +1,6 @@
 ﻿using CommonLib;
 using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
 using PlayHouse.Communicator.PlaySocket;
 using PlayHouse.Production.Session;
 using PlayHouse.Production.Shared;
@@ -30,21 +31,33 @@ public class SessionServer : IServer
             .SetShowQps(_commonOption.ShowQps)
             .SetNodeId(_commonOption.NodeId)
             .SetPacketProducer(_commonOption.PacketProducer)
+            .SetUseLocalTransport(_commonOption.UseLocalTransport)
             .SetAddressServerEndpoints(_commonOption.AddressServerEndpoints)
             .SetAddressServerServiceId(_commonOption.AddressServerServiceId)
             .Build();
 
         PooledBuffer.Init(_commonOption.MaxBufferPoolSize);
+        PlaySocketFactory.InitBufferPool(_commonOption.MaxBufferPoolSize);
+        PacketPool.Init(_commonOption.UsePacketPool, _commonOption.DebugPacketPool);
+        MsgIdRegistry.Init(_commonOption.UseNumericMsgId, _commonOption.MsgIdDescriptors);
+        Mailbox.Init(_commonOption.MailboxCapacity, _commonOption.MailboxOverflowPolicy);
+        foreach (var url in _sessionOption.Urls)
+        {
+            // "serviceId:msgId", packets before authentication can also arrive numeric
+            MsgIdRegistry.Register(url[(url.IndexOf(':') + 1)..]);
+        }
 
         var bindEndpoint = communicatorOption.BindEndpoint;
         var serviceId = _commonOption.ServiceId;
 
         var communicateClient =
-            new XClientCommunicator(PlaySocketFactory.CreatePlaySocket(new SocketConfig(), bindEndpoint));
+            new XClientCommunicator(PlaySocketFactory.CreatePlaySocket(
+                    new SocketConfig { CompressThreshold = _commonOption.CompressThreshold }, bindEndpoint),
+                _commonOption.SendQueueCapacity, _commonOption.UseLocalTransport);
 
         var requestCache = new RequestCache(_commonOption.RequestTimeoutSec);
 
-        var serverInfoCenter = new XServerInfoCenter();
+        var serverInfoCenter = new XServerInfoCenter(_commonOption.ServerSelectStrategy);
 
         var sessionService = new SessionService(
             serviceId,
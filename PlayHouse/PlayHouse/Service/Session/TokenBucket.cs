@@ -0,0 +1,25 @@
+﻿using System.Diagnostics;
+
+namespace PlayHouse.Service.Session;
+
+// allows up to rate per second and burst at once, used only on one session's dispatch thread
+internal class TokenBucket(int rate, int burst)
+{
+    private double _tokens = burst;
+    private long _lastTick = Stopwatch.GetTimestamp();
+
+    public bool TryTake()
+    {
+        var now = Stopwatch.GetTimestamp();
+        _tokens = Math.Min(burst, _tokens + Stopwatch.GetElapsedTime(_lastTick, now).TotalSeconds * rate);
+        _lastTick = now;
+
+        if (_tokens < 1)
+        {
+            return false;
+        }
+
+        _tokens -= 1;
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+﻿using System.Collections.Concurrent;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Shared;
+using Playhouse.Protocol;
+using PlayHouse.Utils;
+
+namespace PlayHouse.Service.Shared;
+
+// mailbox of a stage, api or session actor, a capacity of 0 means unbounded
+internal class Mailbox(
+    ushort serviceId,
+    IClientCommunicator clientCommunicator,
+    int capacity,
+    MailboxOverflowPolicy policy)
+{
+    private readonly LOG<Mailbox> _log = new();
+    private readonly ConcurrentQueue<RoutePacket> _queue = new();
+    private readonly object _dequeueLock = new();
+
+    // only a bounded DropOldest mailbox dequeues from the producer side, the others stay lock free
+    private readonly bool _lockDequeue = capacity > 0 && policy == MailboxOverflowPolicy.DropOldest;
+    private int _count;
+
+    public Mailbox(ushort serviceId, IClientCommunicator clientCommunicator)
+        : this(serviceId, clientCommunicator, DefaultCapacity, DefaultPolicy)
+    {
+    }
+
+    private static int DefaultCapacity { get; set; }
+    private static MailboxOverflowPolicy DefaultPolicy { get; set; }
+
+    public MailboxOverflowPolicy Policy => policy;
+    public int Count => Volatile.Read(ref _count);
+    public bool IsEmpty => _queue.IsEmpty;
+
+    // when a reply to the client is dropped from a session actor mailbox, the client gets the error instead of the backend
+    public Action<Header>? ClientReplyDropped { get; init; }
+
+    public static void Init(int capacity, MailboxOverflowPolicy overflowPolicy)
+    {
+        DefaultCapacity = capacity;
+        DefaultPolicy = overflowPolicy;
+    }
+
+    // false when the packet could not be queued and was dropped
+    public bool Post(RoutePacket packet)
+    {
+        var count = Interlocked.Increment(ref _count);
+        if (capacity <= 0 || count <= capacity || packet.IsBase())
+        {
+            _queue.Enqueue(packet);
+            return true;
+        }
+
+        if (policy == MailboxOverflowPolicy.DropOldest && packet.Header.MsgSeq == 0 &&
+            TryDequeueOldest(out var oldest))
+        {
+            // count already includes the new packet, take back the one that is dropped
+            Interlocked.Decrement(ref _count);
+            Drop(oldest);
+
+            _queue.Enqueue(packet);
+            return true;
+        }
+
+        Interlocked.Decrement(ref _count);
+        Drop(packet);
+        return false;
+    }
+
+    public bool TryDequeue(out RoutePacket packet)
+    {
+        if (!_lockDequeue)
+        {
+            return Dequeue(out packet);
+        }
+
+        lock (_dequeueLock)
+        {
+            return Dequeue(out packet);
+        }
+    }
+
+    private bool Dequeue(out RoutePacket packet)
+    {
+        if (_queue.TryDequeue(out packet!))
+        {
+            Interlocked.Decrement(ref _count);
+            return true;
+        }
+
+        return false;
+    }
+
+    // system packets are never dropped nor moved back, if one is at the head the new packet is dropped instead
+    // takes the consumer's lock so no other packet leaves the queue between the peek and the dequeue
+    private bool TryDequeueOldest(out RoutePacket oldest)
+    {
+        lock (_dequeueLock)
+        {
+            if (_queue.TryPeek(out oldest!) && !oldest.IsBase())
+            {
+                return _queue.TryDequeue(out oldest!);
+            }
+        }
+
+        return false;
+    }
+
+    private void Drop(RoutePacket packet)
+    {
+        using (packet)
+        {
+            var routeHeader = packet.RouteHeader;
+            _log.Warn(() => $"mailbox is full, packet is dropped - [capacity:{capacity},packetInfo:{routeHeader}]");
+
+            if (routeHeader.IsReply)
+            {
+                // never reply to a reply, if it was going to the client send it an error so it does not keep waiting
+                if (routeHeader.IsToClient && routeHeader.Header.MsgSeq != 0)
+                {
+                    ClientReplyDropped?.Invoke(routeHeader.Header);
+                }
+            }
+            else if (routeHeader.Header.MsgSeq != 0)
+            {
+                var reply = RoutePacket.ReplyOf(serviceId, routeHeader, (ushort)BaseErrorCode.ServerBusy, null);
+                clientCommunicator.Send(routeHeader.From, reply);
+            }
+        }
+    }
+}
\ No newline at end of file
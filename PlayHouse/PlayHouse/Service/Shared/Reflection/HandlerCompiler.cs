@@ -0,0 +1,48 @@
+﻿using System.Linq.Expressions;
+using System.Reflection;
+
+namespace PlayHouse.Service.Shared.Reflection;
+
+/// <summary>
+///     Compiles a handler MethodInfo into a delegate at registration, so requests do not go through MethodInfo.Invoke.
+///     Methods that do not return a Task are not compiled and keep the reflection call.
+/// </summary>
+internal static class HandlerCompiler
+{
+    // (target, arguments) => ((DeclaringType)target).Method((P0)arguments[0], (P1)arguments[1], ...)
+    public static Func<object, object[], Task>? Compile(MethodInfo method)
+    {
+        if (!typeof(Task).IsAssignableFrom(method.ReturnType) || method.ContainsGenericParameters)
+        {
+            return null;
+        }
+
+        var target = Expression.Parameter(typeof(object), "target");
+        var arguments = Expression.Parameter(typeof(object[]), "arguments");
+
+        var callArguments = method.GetParameters()
+            .Select((parameter, index) => Expression.Convert(
+                Expression.ArrayIndex(arguments, Expression.Constant(index)), parameter.ParameterType));
+
+        var instance = method.IsStatic ? null : Expression.Convert(target, method.DeclaringType!);
+        var call = Expression.Call(instance, method, callArguments);
+
+        return Expression.Lambda<Func<object, object[], Task>>(
+            Expression.Convert(call, typeof(Task)), target, arguments).Compile();
+    }
+
+    // task => ((Task<T>)task).Result, null when it is not a Task<T>
+    public static Func<Task, object?>? CompileResult(MethodInfo method)
+    {
+        var returnType = method.ReturnType;
+        if (!returnType.IsGenericType || returnType.GetGenericTypeDefinition() != typeof(Task<>))
+        {
+            return null;
+        }
+
+        var task = Expression.Parameter(typeof(Task), "task");
+        var result = Expression.Property(Expression.Convert(task, returnType), nameof(Task<object>.Result));
+
+        return Expression.Lambda<Func<Task, object?>>(Expression.Convert(result, typeof(object)), task).Compile();
+    }
+}
\ No newline at end of file
@@ -13,10 +13,13 @@ public class ReflectionMethod
         MsgId = msgId;
         ClassName = className;
         Method = method;
+        Invoker = HandlerCompiler.Compile(method);
+        ResultOf = HandlerCompiler.CompileResult(method);
         Filters.AddRange(targetFilters);
         Filters.AddRange(classFilters);
         Filters.AddRange(method.GetCustomAttributes(typeof(AspectifyAttribute), true)
             .Select(e => (AspectifyAttribute)e));
+        Chain = BuildChain();
     }
 
     public ReflectionMethod(string msgId, string className, MethodInfo method)
@@ -24,14 +27,42 @@ public class ReflectionMethod
         MsgId = msgId;
         ClassName = className;
         Method = method;
+        Invoker = HandlerCompiler.Compile(method);
+        ResultOf = HandlerCompiler.CompileResult(method);
         Filters.AddRange(method.GetCustomAttributes(typeof(AspectifyAttribute), true)
             .Select(e => (AspectifyAttribute)e));
+        Chain = BuildChain();
     }
 
     public string MsgId { get; set; }
     public string ClassName { get; set; }
     public MethodInfo Method { get; set; }
     public List<AspectifyAttribute> Filters { get; set; } = new();
+
+    internal Func<object, object[], Task>? Invoker { get; }
+    internal Func<Task, object?>? ResultOf { get; }
+
+    // the filters' Intercept calls and the final handler call, built once per msgId at registration
+    internal Func<Invocation, Task>[] Chain { get; }
+
+    // handler instance resolved at registration, not looked up by class name per request
+    internal ReflectionInstance? Instance { get; set; }
+
+    private Func<Invocation, Task>[] BuildChain()
+    {
+        var chain = new Func<Invocation, Task>[Filters.Count + 1];
+        for (var i = 0; i < Filters.Count; i++)
+        {
+            chain[i] = Filters[i].Intercept;
+        }
+
+        var invoker = Invoker;
+        var resultOf = ResultOf;
+        chain[^1] = invoker != null
+            ? invocation => invocation.InvokeTarget(invoker, resultOf)
+            : invocation => invocation.InvokeMethod();
+        return chain;
+    }
 }
 
 public class ReflectionInstance(Type type, IEnumerable<AspectifyAttribute> filters, IServiceProvider serviceProvider)
@@ -48,8 +79,16 @@ public class ReflectionInstance(Type type, IEnumerable<AspectifyAttribute> filte
     {
         await using var scope = ServiceProvider.CreateAsyncScope();
         var targetInstance = scope.ServiceProvider.GetRequiredService(Type);
-        var invocation = new Invocation(targetInstance, targetMethod.Method, arguments, targetMethod.Filters,
-            ServiceProvider);
+
+        // without filters the compiled delegate is called directly, no Invocation
+        if (targetMethod.Filters.Count == 0 && targetMethod.Invoker != null)
+        {
+            await targetMethod.Invoker(targetInstance, arguments);
+            return;
+        }
+
+        var invocation = new Invocation(targetInstance, targetMethod.Method, arguments, ServiceProvider,
+            targetMethod.Chain);
         await invocation.Proceed();
     }
 
@@ -57,8 +96,16 @@ public class ReflectionInstance(Type type, IEnumerable<AspectifyAttribute> filte
     {
         await using var scope = ServiceProvider.CreateAsyncScope();
         var targetInstance = scope.ServiceProvider.GetRequiredService(Type);
-        var invocation = new Invocation(targetInstance, targetMethod.Method, arguments, targetMethod.Filters,
-            ServiceProvider);
+
+        if (targetMethod.Filters.Count == 0 && targetMethod is { Invoker: not null, ResultOf: not null })
+        {
+            var task = targetMethod.Invoker(targetInstance, arguments);
+            await task;
+            return targetMethod.ResultOf(task)!;
+        }
+
+        var invocation = new Invocation(targetInstance, targetMethod.Method, arguments, ServiceProvider,
+            targetMethod.Chain);
         await invocation.Proceed();
         return invocation.ReturnValue!;
     }
@@ -199,7 +246,10 @@ internal class SystemHandleReflectionInvoker
                 }
 
                 _methods[key] =
-                    new ReflectionMethod(key, className, value.Method, _targetFilters, systemInstance.Filters);
+                    new ReflectionMethod(key, className, value.Method, _targetFilters, systemInstance.Filters)
+                    {
+                        Instance = systemInstance
+                    };
                 _messageIndexChecker[key] = value.GetMethodInfo().Name;
             }
         });
@@ -207,14 +257,10 @@ internal class SystemHandleReflectionInvoker
 
     public async Task InvokeMethods(string msgId, object[] arguments)
     {
-        var method = _methods[msgId];
+        if (!_methods.TryGetValue(msgId, out var method))
+            throw new ServiceException.NotRegisterMethod($"not registered message methodName:{msgId}");
 
-        if (method == null) throw new ServiceException.NotRegisterMethod($"not registered message methodName:{msgId}");
-        if (!_instances.TryGetValue(method.ClassName, out var instance))
-            throw new ServiceException.NotRegisterInstance(
-                $"{method.ClassName}: reflection instance is not registered");
-
-        await instance.Invoke(method, arguments);
+        await method.Instance!.Invoke(method, arguments);
     }
 }
 
@@ -231,10 +277,9 @@ internal class CallbackReflectionInvoker
         {
             foreach (var instance in reflections.GetInstanceBy(type))
             {
-                _instances.Add(instance.Name, instance);
+                // one class can implement several callbacks
+                _instances.TryAdd(instance.Name, instance);
             }
-
-            ;
         }
 
         ExtractMethodInfo(reflections, types);
@@ -251,7 +296,10 @@ internal class CallbackReflectionInvoker
 
                 if (_methods.ContainsKey(methodInfo.Name) == false)
                 {
-                    _methods[methodInfo.Name] = new ReflectionMethod(string.Empty, className, methodInfo);
+                    _methods[methodInfo.Name] = new ReflectionMethod(string.Empty, className, methodInfo)
+                    {
+                        Instance = systemInstance
+                    };
                 }
                 else
                 {
@@ -261,17 +309,20 @@ internal class CallbackReflectionInvoker
         }
     }
 
+    public bool HasMethod(string methodName)
+    {
+        return _methods.ContainsKey(methodName);
+    }
+
     public async Task InvokeMethods(string methodName, object[] arguements)
     {
         var method = _methods[methodName];
-        var instance = _instances[method.ClassName];
-        await instance.Invoke(method, arguements);
+        await method.Instance!.Invoke(method, arguements);
     }
 
     public async Task<object?> InvokeMethodsWithReturn(string methodName, object[] arguments)
     {
         var method = _methods[methodName];
-        var instance = _instances[method.ClassName];
-        return await instance.InvokeWithReturn(method, arguments);
+        return await method.Instance!.InvokeWithReturn(method, arguments);
     }
 }
\ No newline at end of file
@@ -1,57 +1,195 @@
 ﻿using System.Collections.Concurrent;
+using System.Diagnostics;
 using PlayHouse.Communicator.Message;
 using PlayHouse.Production.Shared;
 using PlayHouse.Service.Play;
+using PlayHouse.Utils;
 
 namespace PlayHouse.Service.Shared;
 
-internal class TimerManager(IPlayDispatcher dispatcher)
+internal readonly struct StageTimerFire(long timerId, TimerCallbackTask timerCallback)
 {
-    private readonly ConcurrentDictionary<long, Timer> _timers = new();
+    public long TimerId { get; } = timerId;
+    public TimerCallbackTask TimerCallback { get; } = timerCallback;
+}
+
+/// <summary>
+///     Stage timers on a single timing wheel thread instead of one System.Threading.Timer per timer.
+///     Register and cancel only enqueue or flag the entry, the wheel thread picks them up on its next tick.
+///     All timers of a stage that are due on the same tick are posted as one StageTimer packet.
+/// </summary>
+internal class TimerManager
+{
+    private const int TickMs = 10;
+
+    private readonly Dictionary<long, List<StageTimerFire>> _batches = new();
+    private readonly IPlayDispatcher _dispatcher;
+    private readonly List<TimerEntry> _expired = new();
+    private readonly Stack<List<StageTimerFire>> _fireListPool = new();
+    private readonly LOG<TimerManager> _log = new();
+    private readonly ConcurrentQueue<TimerEntry> _pending = new();
+    private readonly Stopwatch _stopwatch = Stopwatch.StartNew();
+    private readonly Thread _thread;
+    private readonly ConcurrentDictionary<long, TimerEntry> _timers = new();
+    private readonly TimerWheel _wheel = new();
+    private volatile bool _running = true;
+
+    public TimerManager(IPlayDispatcher dispatcher)
+    {
+        _dispatcher = dispatcher;
+        _thread = new Thread(Run) { Name = "StageTimer", IsBackground = true };
+        _thread.Start();
+    }
 
     public long RegisterRepeatTimer(long stageId, long timerId, long initialDelay, long period,
         TimerCallbackTask timerCallback)
     {
-        var timer = new Timer(timerState =>
-        {
-            var routePacket = RoutePacket.StageTimerOf(stageId, timerId, timerCallback, timerState);
-            dispatcher.OnPost(routePacket);
-        }, null, initialDelay, period);
-
-
-        _timers[timerId] = timer;
+        Register(new TimerEntry(stageId, timerId, ToTicks(period), 0, timerCallback), initialDelay);
         return timerId;
     }
 
     public long RegisterCountTimer(long stageId, long timerId, long initialDelay, int count, long period,
         TimerCallbackTask timerCallback)
     {
-        var remainingCount = count;
+        if (count <= 0)
+        {
+            return timerId;
+        }
+
+        Register(new TimerEntry(stageId, timerId, ToTicks(period), count, timerCallback), initialDelay);
+        return timerId;
+    }
+
+    public void CancelTimer(long timerId)
+    {
+        if (_timers.TryRemove(timerId, out var entry))
+        {
+            entry.Cancel();
+        }
+    }
+
+    public void Stop()
+    {
+        _running = false;
+    }
+
+    private void Register(TimerEntry entry, long initialDelay)
+    {
+        // the first tick is never the current one, so a zero delay fires on the next tick
+        entry.DeadlineTick = CurrentTick() + Math.Max(1, ToTicks(initialDelay));
+        _timers[entry.TimerId] = entry;
+        _pending.Enqueue(entry);
+    }
+
+    private static long ToTicks(long milliseconds)
+    {
+        return (milliseconds + TickMs - 1) / TickMs;
+    }
+
+    private long CurrentTick()
+    {
+        return _stopwatch.ElapsedMilliseconds / TickMs;
+    }
+
+    private void Run()
+    {
+        while (_running)
+        {
+            try
+            {
+                while (_pending.TryDequeue(out var entry))
+                {
+                    if (!entry.IsCanceled)
+                    {
+                        _wheel.Add(entry);
+                    }
+                }
+
+                var now = CurrentTick();
+                while (_wheel.CurrentTick < now)
+                {
+                    _wheel.Advance(_expired);
+                    Fire();
+                }
+            }
+            catch (Exception e)
+            {
+                _log.Error(() => e.ToString());
+            }
+
+            Thread.Sleep(TickMs);
+        }
+    }
 
-        var timer = new Timer(timerState =>
+    private void Fire()
+    {
+        if (_expired.Count == 0)
+        {
+            return;
+        }
+
+        foreach (var entry in _expired)
         {
-            if (remainingCount > 0)
+            // CancelTimer already removed it from _timers
+            if (entry.IsCanceled)
             {
-                var routePacket = RoutePacket.StageTimerOf(stageId, timerId, timerCallback, timerState);
-                dispatcher.OnPost(routePacket);
-                remainingCount--;
+                continue;
             }
-            else
+
+            if (!_batches.TryGetValue(entry.StageId, out var fires))
             {
-                CancelTimer(timerId);
+                fires = _fireListPool.Count > 0 ? _fireListPool.Pop() : new List<StageTimerFire>();
+                _batches[entry.StageId] = fires;
             }
-        }, null, initialDelay, period);
 
-        _timers[timerId] = timer;
-        return timerId;
+            fires.Add(new StageTimerFire(entry.TimerId, entry.Callback));
+            Reschedule(entry);
+        }
+
+        _expired.Clear();
+
+        foreach (var (stageId, fires) in _batches)
+        {
+            var routePacket = fires.Count == 1
+                ? RoutePacket.StageTimerOf(stageId, fires[0].TimerId, fires[0].TimerCallback, null)
+                : RoutePacket.StageTimerOf(stageId, fires.ToArray());
+
+            try
+            {
+                _dispatcher.OnPost(routePacket);
+            }
+            catch (Exception e)
+            {
+                _log.Error(() => e.ToString());
+            }
+
+            fires.Clear();
+            _fireListPool.Push(fires);
+        }
+
+        _batches.Clear();
     }
 
-    public void CancelTimer(long timerId)
+    private void Reschedule(TimerEntry entry)
     {
-        if (_timers.TryGetValue(timerId, out var timer))
+        if (entry.IsCountTimer)
+        {
+            entry.RemainingCount--;
+            if (entry.RemainingCount <= 0)
+            {
+                _timers.TryRemove(new KeyValuePair<long, TimerEntry>(entry.TimerId, entry));
+                return;
+            }
+        }
+
+        if (entry.PeriodTicks <= 0)
         {
-            timer.Dispose();
-            _timers.Remove(timerId, out _);
+            // same as System.Threading.Timer, a timer without a period fires only once
+            _timers.TryRemove(new KeyValuePair<long, TimerEntry>(entry.TimerId, entry));
+            return;
         }
+
+        entry.DeadlineTick += entry.PeriodTicks;
+        _wheel.Add(entry);
     }
 }
\ No newline at end of file
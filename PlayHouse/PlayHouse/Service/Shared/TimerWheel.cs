@@ -0,0 +1,131 @@
+﻿using PlayHouse.Production.Shared;
+
+namespace PlayHouse.Service.Shared;
+
+// an entry that can be put on a wheel, handed out on the tick its DeadlineTick is reached
+internal interface IWheelEntry
+{
+    long DeadlineTick { get; set; }
+    bool IsCanceled { get; }
+}
+
+internal class TimerEntry(long stageId, long timerId, long periodTicks, int count, TimerCallbackTask callback)
+    : IWheelEntry
+{
+    private volatile bool _canceled;
+
+    public long StageId { get; } = stageId;
+    public long TimerId { get; } = timerId;
+    public long PeriodTicks { get; } = periodTicks;
+    public TimerCallbackTask Callback { get; } = callback;
+
+    // 0 means a repeat timer without a count limit
+    public int RemainingCount { get; set; } = count;
+    public bool IsCountTimer { get; } = count > 0;
+    public long DeadlineTick { get; set; }
+    public bool IsCanceled => _canceled;
+
+    public void Cancel()
+    {
+        _canceled = true;
+    }
+}
+
+/// <summary>
+///     Hierarchical timing wheel, 4 levels of 64 slots each (2^24 ticks).
+///     Add is O(1), far timers are cascaded down a level when the lower levels wrap around.
+///     Not thread safe, it is driven by a single thread (TimerManager, SessionIdleTracker).
+/// </summary>
+internal class TimerWheel<T> where T : class, IWheelEntry
+{
+    private const int LevelBits = 6;
+    private const int SlotCount = 1 << LevelBits;
+    private const int SlotMask = SlotCount - 1;
+    private const int LevelCount = 4;
+
+    private readonly List<T>[][] _levels;
+    private List<T> _spare = new();
+
+    public TimerWheel(long currentTick = 0)
+    {
+        CurrentTick = currentTick;
+        _levels = new List<T>[LevelCount][];
+        for (var level = 0; level < LevelCount; level++)
+        {
+            _levels[level] = new List<T>[SlotCount];
+            for (var slot = 0; slot < SlotCount; slot++)
+            {
+                _levels[level][slot] = new List<T>();
+            }
+        }
+    }
+
+    public long CurrentTick { get; private set; }
+
+    public void Add(T entry)
+    {
+        var delta = Math.Max(0, entry.DeadlineTick - CurrentTick);
+
+        for (var level = 0; level < LevelCount; level++)
+        {
+            if (delta < 1L << (LevelBits * (level + 1)))
+            {
+                _levels[level][(entry.DeadlineTick >> (LevelBits * level)) & SlotMask].Add(entry);
+                return;
+            }
+        }
+
+        // beyond the wheel range, parked on the top level and re-evaluated when that slot cascades
+        _levels[LevelCount - 1][((CurrentTick - 1) >> (LevelBits * (LevelCount - 1))) & SlotMask].Add(entry);
+    }
+
+    // moves the wheel one tick forward and hands every entry due at the new tick to expired,
+    // canceled entries are handed out too (as soon as they are seen) so the consumer can release what it tracks for them
+    public void Advance(List<T> expired)
+    {
+        CurrentTick++;
+
+        for (var level = LevelCount - 1; level > 0; level--)
+        {
+            var lowerMask = (1L << (LevelBits * level)) - 1;
+            if ((CurrentTick & lowerMask) == 0)
+            {
+                Cascade(level, (int)((CurrentTick >> (LevelBits * level)) & SlotMask), expired);
+            }
+        }
+
+        var slot = (int)(CurrentTick & SlotMask);
+        var due = _levels[0][slot];
+        _levels[0][slot] = _spare;
+
+        expired.AddRange(due);
+
+        due.Clear();
+        _spare = due;
+    }
+
+    private void Cascade(int level, int slot, List<T> expired)
+    {
+        var entries = _levels[level][slot];
+        _levels[level][slot] = _spare;
+
+        foreach (var entry in entries)
+        {
+            if (entry.IsCanceled)
+            {
+                expired.Add(entry);
+            }
+            else
+            {
+                Add(entry);
+            }
+        }
+
+        entries.Clear();
+        _spare = entries;
+    }
+}
+
+internal class TimerWheel(long currentTick = 0) : TimerWheel<TimerEntry>(currentTick)
+{
+}
\ No newline at end of file
@@ -1,19 +1,35 @@
-﻿namespace PlayHouse.Service.Shared;
+﻿using System.Diagnostics;
 
+namespace PlayHouse.Service.Shared;
+
+/// <summary>
+///     timestamp(42) + nodeId(12) + sequence(10) id.
+///     Issues ids without a lock by advancing one combined timestamp + sequence value with CAS.
+///     When the sequence overflows it borrows the next ms, and only waits once it runs MaxLeadMs or more ahead of
+///     the clock. A restart issues again from the clock at that time, so MaxLeadMs must be well below restart time.
+///     The clock is UtcNow at start plus Stopwatch elapsed time, so the system clock going back has no effect.
+/// </summary>
 public class UniqueIdGenerator
 {
     private const long NodeIdBits = 12L;
     private const long SequenceBits = 10L;
     private const long NodeIdShift = 10L;
     private const long TimestampLeftShift = NodeIdBits + SequenceBits;
+    private const long SequenceMask = (1L << (int)SequenceBits) - 1;
+    private const long MaxLeadMs = 5;
+
+    // the size that fits in MaxLeadMs, a larger block could not be reserved even by waiting for the clock
+    public const int MaxBlockSize = 1 << 12;
 
     private static readonly long
         Epoch = new DateTimeOffset(2020, 1, 1, 0, 0, 0, TimeSpan.Zero).ToUnixTimeMilliseconds();
 
     private readonly long _nodeId;
-    private long _lastTimestamp = -1L;
+    private readonly long _startMs = DateTimeOffset.UtcNow.ToUnixTimeMilliseconds() - Epoch;
+    private readonly long _startTimestamp = Stopwatch.GetTimestamp();
 
-    private long _sequence;
+    // the last issued (timestamp << SequenceBits) | sequence
+    private long _last = -1L;
 
     public UniqueIdGenerator(int nodeId)
     {
@@ -27,50 +43,70 @@ public class UniqueIdGenerator
 
     public long NextId()
     {
-        lock (this)
+        return IdOf(Reserve(1));
+    }
+
+    // reserves destination.Length ids at once, filled in issue order (ascending)
+    public void NextIds(Span<long> destination)
+    {
+        if (destination.Length == 0)
         {
-            var timestamp = GetCurrentTimestamp();
+            return;
+        }
 
-            if (timestamp < _lastTimestamp)
-            {
-                throw new InvalidOperationException("Invalid system clock.");
-            }
+        var first = Reserve(destination.Length);
+        for (var i = 0; i < destination.Length; i++)
+        {
+            destination[i] = IdOf(first + i);
+        }
+    }
 
-            if (timestamp == _lastTimestamp)
-            {
-                _sequence = (_sequence + 1) & ((1L << (int)SequenceBits) - 1);
+    public long[] NextIds(int count)
+    {
+        var ids = new long[count];
+        NextIds(ids);
+        return ids;
+    }
 
-                if (_sequence == 0)
-                {
-                    timestamp = WaitForNextTimestamp(timestamp);
-                }
-            }
-            else
+    private long Reserve(int count)
+    {
+        if (count > MaxBlockSize)
+        {
+            throw new ArgumentOutOfRangeException(nameof(count), $"Block size must not exceed {MaxBlockSize}.");
+        }
+
+        var spin = new SpinWait();
+        while (true)
+        {
+            var now = CurrentMs() << (int)SequenceBits;
+            var last = Volatile.Read(ref _last);
+            var first = Math.Max(last + 1, now);
+            var end = first + count - 1;
+
+            if ((end - now) >> (int)SequenceBits > MaxLeadMs)
             {
-                _sequence = 0;
+                // when the issue rate keeps exceeding the sequence range, waits for the clock to catch up
+                spin.SpinOnce();
+                continue;
             }
 
-            _lastTimestamp = timestamp;
-
-            return ((timestamp - Epoch) << (int)TimestampLeftShift) |
-                   (_nodeId << (int)NodeIdShift) |
-                   _sequence;
+            if (Interlocked.CompareExchange(ref _last, end, last) == last)
+            {
+                return first;
+            }
         }
     }
 
-    private long GetCurrentTimestamp()
+    private long IdOf(long packed)
     {
-        return DateTimeOffset.UtcNow.ToUnixTimeMilliseconds();
+        return ((packed >> (int)SequenceBits) << (int)TimestampLeftShift) |
+               (_nodeId << (int)NodeIdShift) |
+               (packed & SequenceMask);
     }
 
-    private long WaitForNextTimestamp(long currentTimestamp)
+    // ms since the epoch, monotonic
+    private long CurrentMs()
     {
-        var timestamp = GetCurrentTimestamp();
-        while (timestamp <= currentTimestamp)
-        {
-            timestamp = GetCurrentTimestamp();
-        }
-
-        return timestamp;
+        return _startMs + (long)Stopwatch.GetElapsedTime(_startTimestamp).TotalMilliseconds;
     }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
-﻿using PlayHouse.Communicator;
+﻿using Google.Protobuf;
+using PlayHouse.Communicator;
 using PlayHouse.Communicator.Message;
 using PlayHouse.Production.Shared;
 using Playhouse.Protocol;
@@ -12,7 +13,25 @@ internal class XSender(ushort serviceId, IClientCommunicator clientCommunicator,
     private readonly LOG<XSender> _log = new();
     protected readonly IClientCommunicator ClientCommunicator = clientCommunicator;
 
-    protected RouteHeader? CurrentHeader;
+    // in a stage context other packets are handled while a handler awaits, so the header flows through an AsyncLocal
+    private AsyncLocal<RouteHeader?>? _flowingHeader;
+    private RouteHeader? _currentHeader;
+
+    protected RouteHeader? CurrentHeader
+    {
+        get => _flowingHeader != null ? _flowingHeader.Value : _currentHeader;
+        set
+        {
+            if (_flowingHeader != null)
+            {
+                _flowingHeader.Value = value;
+            }
+            else
+            {
+                _currentHeader = value;
+            }
+        }
+    }
 
     public ushort ServiceId { get; } = serviceId;
 
@@ -156,6 +175,11 @@ internal class XSender(ushort serviceId, IClientCommunicator clientCommunicator,
         CurrentHeader = null;
     }
 
+    internal void UseFlowingHeader()
+    {
+        _flowingHeader ??= new AsyncLocal<RouteHeader?>();
+    }
+
     private void Reply(ushort errorCode, IPacket? reply = null)
     {
         if (CurrentHeader != null)
@@ -339,4 +363,45 @@ internal class XSender(ushort serviceId, IClientCommunicator clientCommunicator,
 
         return replyPacket;
     }
+
+    // a request that only needs the reply's errorCode, failures and timeouts also come back as an errorCode instead of an exception
+    internal async Task<ushort> RequestToBaseStageForCode(string playEndpoint, long stageId, RoutePacket packet)
+    {
+        var seq = GetSequence();
+        var errorCode = (ushort)BaseErrorCode.RequestTimeout;
+        var deferred = new TaskCompletionSource<RoutePacket>();
+        // the reply packet is cleaned up by the callback side
+        reqCache.Put(seq, new ReplyObject((code, _) => errorCode = code, deferred));
+        var routePacket = RoutePacket.StageOf(stageId, 0, packet, true, true);
+        routePacket.SetMsgSeq(seq);
+        ClientCommunicator.Send(playEndpoint, routePacket);
+
+        try
+        {
+            await deferred.Task;
+        }
+        catch (Exception)
+        {
+            // already carried in the errorCode
+        }
+
+        return errorCode;
+    }
+
+    // relays a received request to another server and returns its reply to source
+    // source must be a header that does not go back to the pool
+    internal void RelayRequest(string endpoint, RoutePacket request, RouteHeader source)
+    {
+        var seq = GetSequence();
+        reqCache.Put(seq, new ReplyObject((errorCode, reply) =>
+        {
+            // the reply is cleaned up after the callback, so its payload is copied
+            var copied = errorCode == (ushort)BaseErrorCode.Success
+                ? CPacket.Of(reply.MsgId, ByteString.CopyFrom(reply.Payload.DataSpan))
+                : null;
+            ClientCommunicator.Send(source.From, RoutePacket.ReplyOf(ServiceId, source, errorCode, copied));
+        }));
+        request.SetMsgSeq(seq);
+        ClientCommunicator.Send(endpoint, request);
+    }
 }
\ No newline at end of file
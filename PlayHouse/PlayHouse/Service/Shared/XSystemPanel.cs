@@ -17,7 +17,12 @@ internal class XSystemPanel(
 
     public IServerInfo GetServerInfoBy(ushort serviceId)
     {
-        return serverInfoCenter.FindRoundRobinServer(serviceId);
+        return serverInfoCenter.FindServerBy(serviceId);
+    }
+
+    public IServerInfo GetServerInfoBy(ushort serviceId, ServerSelectStrategy strategy)
+    {
+        return serverInfoCenter.FindServerBy(serviceId, strategy);
     }
 
     public IServerInfo GetServerInfoBy(ushort serviceId, long accountId)
@@ -60,6 +65,11 @@ internal class XSystemPanel(
         return _uniqueIdGenerator.NextId();
     }
 
+    public void GenerateUUIDs(Span<long> destination)
+    {
+        _uniqueIdGenerator.NextIds(destination);
+    }
+
     public IServerInfo GetServerInfo()
     {
         return serverInfoCenter.FindServer(bindEndpoint);
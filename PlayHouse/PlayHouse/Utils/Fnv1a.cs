@@ -0,0 +1,41 @@
+﻿using System.Text;
+
+namespace PlayHouse.Utils;
+
+/// <summary>
+///     FNV-1a 32 bit hash, shared by the msgId hash of PacketFrame and the identity cache of the backbone socket.
+///     Only uses the BCL, ClientConnector links this file like PacketFrame.
+/// </summary>
+internal static class Fnv1a
+{
+    private const uint OffsetBasis = 2166136261;
+    private const uint Prime = 16777619;
+
+    public static int Hash32(ReadOnlySpan<byte> data)
+    {
+        var hash = OffsetBasis;
+        foreach (var b in data)
+        {
+            hash = (hash ^ b) * Prime;
+        }
+
+        return (int)hash;
+    }
+
+    // hash of the utf-8 bytes of text, ascii text is hashed straight from the chars without encoding
+    public static int Hash32(string text)
+    {
+        var hash = OffsetBasis;
+        foreach (var ch in text)
+        {
+            if (ch > 0x7F)
+            {
+                return Hash32(Encoding.UTF8.GetBytes(text).AsSpan());
+            }
+
+            hash = (hash ^ ch) * Prime;
+        }
+
+        return (int)hash;
+    }
+}
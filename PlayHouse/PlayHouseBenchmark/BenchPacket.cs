@@ -0,0 +1,20 @@
+﻿using Google.Protobuf;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Shared;
+
+namespace PlayHouseBenchmark;
+
+internal class BenchPacket(string msgId, IPayload payload) : IPacket
+{
+    public BenchPacket(IMessage message) : this(message.Descriptor.Name, new ProtoPayload(message))
+    {
+    }
+
+    public string MsgId { get; } = msgId;
+    public IPayload Payload { get; } = payload;
+
+    public void Dispose()
+    {
+        Payload.Dispose();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+﻿using System.Diagnostics;
+using ClientConnector;
+using Google.Protobuf;
+using Org.Ulalax.Playhouse.Protocol;
+
+namespace PlayHouseBenchmark.Load;
+
+// authenticates, joins a stage, then sends echo requests one at a time and times the replies
+internal class LoadClient(LoadOption option, long accountId)
+{
+    public List<long> Latencies { get; } = new(); // Stopwatch ticks
+    public int Errors { get; private set; }
+
+    public async Task RunAsync(string host, int port, CancellationToken token)
+    {
+        await using var connector = new Connector();
+        connector.Init(new ConnectorConfig { Host = host, Port = port });
+        await connector.ConnectAsync(token);
+
+        using (var reply = await connector.AuthenticateAsync(option.ApiServiceId,
+                   new Packet(LoadMsgId.Authenticate, new TestMsg { TestMsg_ = accountId.ToString() }.ToByteArray())))
+        {
+            Ensure(reply);
+        }
+
+        using (var reply = await connector.RequestAsync(option.ApiServiceId, new Packet(LoadMsgId.CreateJoinStage)))
+        {
+            Ensure(reply);
+        }
+
+        var body = new TestMsg { TestMsg_ = new string('a', option.BodySize) }.ToByteArray();
+        while (!token.IsCancellationRequested)
+        {
+            var start = Stopwatch.GetTimestamp();
+            try
+            {
+                using var reply = await connector.RequestAsync(option.PlayServiceId,
+                    new Packet(LoadMsgId.Echo, body), accountId);
+                if (reply.ErrorCode == 0)
+                {
+                    Latencies.Add(Stopwatch.GetTimestamp() - start);
+                }
+                else
+                {
+                    Errors++;
+                }
+            }
+            catch (TimeoutException)
+            {
+                Errors++;
+            }
+        }
+    }
+
+    private static void Ensure(Packet reply)
+    {
+        if (reply.ErrorCode != 0)
+        {
+            throw new InvalidOperationException($"{reply.MsgId} is failed - [errorCode:{reply.ErrorCode}]");
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+﻿using System.Collections.Concurrent;
+using Google.Protobuf;
+using Microsoft.Extensions.DependencyInjection;
+using Org.Ulalax.Playhouse.Protocol;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Api;
+using PlayHouse.Production.Play;
+using PlayHouse.Production.Session;
+using PlayHouse.Production.Shared;
+using Playhouse.Protocol;
+using PlayHouse.Service.Api;
+using PlayHouse.Service.Play;
+using PlayHouse.Service.Session;
+using PlayHouse.Service.Shared;
+
+namespace PlayHouseBenchmark.Load;
+
+// msgIds used by the load scenario, an external cluster must run the same contents
+internal static class LoadMsgId
+{
+    public const string Authenticate = "LoadAuthenticate";
+    public const string CreateJoinStage = "LoadCreateJoinStage";
+    public const string Echo = "LoadEcho";
+    public const string StageType = "echo";
+}
+
+// starts api (also address server), session and play servers in one process
+internal class LoadCluster(LoadOption option)
+{
+    private const ushort SessionServiceId = 1;
+
+    private readonly List<IServer> _servers = new();
+
+    public int SessionPort { get; private set; }
+
+    public async Task StartAsync()
+    {
+        var services = new ServiceCollection();
+        services.AddSingleton(option);
+        services.AddSingleton<LoadSystemController>();
+        services.AddTransient<LoadApiController>();
+        var serviceProvider = services.BuildServiceProvider();
+
+        var apiPort = IpFinder.FindFreePort();
+        var addressServers = new List<string> { $"127.0.0.1:{apiPort}" };
+        SessionPort = IpFinder.FindFreePort();
+
+        PlayhouseOption CommonOption(ushort serviceId, int port, int nodeId)
+        {
+            return new PlayhouseOption
+            {
+                Ip = "127.0.0.1",
+                Port = port,
+                ServiceId = serviceId,
+                NodeId = nodeId,
+                ServiceProvider = serviceProvider,
+                AddressServerEndpoints = addressServers,
+                AddressServerServiceId = option.ApiServiceId,
+                PacketProducer = (msgId, payload, _) => new BenchPacket(msgId, payload),
+                UseLocalTransport = option.LocalTransport
+            };
+        }
+
+        _servers.Add(new ApiServer(CommonOption(option.ApiServiceId, apiPort, 1), new ApiOption()));
+
+        var playOption = new PlayOption();
+        playOption.PlayProducer.Register(LoadMsgId.StageType,
+            stageSender => new EchoStage(stageSender),
+            actorSender => new EchoActor(actorSender));
+        _servers.Add(new PlayServer(CommonOption(option.PlayServiceId, IpFinder.FindFreePort(), 2), playOption));
+
+        _servers.Add(new SessionServer(CommonOption(SessionServiceId, IpFinder.FindFreePort(), 3), new SessionOption
+        {
+            SessionPort = SessionPort,
+            Urls = [$"{option.ApiServiceId}:{LoadMsgId.Authenticate}"]
+        }));
+
+        foreach (var server in _servers)
+        {
+            server.Start();
+        }
+
+        // until every server has received the others' info
+        var deadline = DateTime.UtcNow.AddSeconds(30);
+        while (ControlContext.SystemPanel.GetServers().Count(e => e.GetState() == ServerState.RUNNING) < _servers.Count)
+        {
+            if (DateTime.UtcNow > deadline)
+            {
+                throw new TimeoutException("cluster is not ready");
+            }
+
+            await Task.Delay(100);
+        }
+    }
+
+    public async Task StopAsync()
+    {
+        foreach (var server in Enumerable.Reverse(_servers))
+        {
+            await server.StopAsync();
+        }
+    }
+}
+
+internal class LoadSystemController : ISystemController, IUpdateServerInfoCallback
+{
+    private readonly ConcurrentDictionary<string, IServerInfo> _servers = new();
+
+    public void Handles(ISystemHandlerRegister handlerRegister)
+    {
+    }
+
+    public Task<List<IServerInfo>> UpdateServerInfoAsync(IServerInfo serverInfo)
+    {
+        _servers[serverInfo.GetBindEndpoint()] = serverInfo;
+        return Task.FromResult(_servers.Values.ToList());
+    }
+}
+
+internal class LoadApiController(LoadOption option) : IApiController
+{
+    public void Handles(IHandlerRegister handlerRegister)
+    {
+        handlerRegister.Add(LoadMsgId.Authenticate, Authenticate);
+        handlerRegister.Add(LoadMsgId.CreateJoinStage, CreateJoinStage);
+    }
+
+    public Task Authenticate(IPacket packet, IApiSender apiSender)
+    {
+        var message = TestMsg.Parser.ParseFrom(packet.Payload.DataSpan);
+        apiSender.Authenticate(long.Parse(message.TestMsg_));
+        apiSender.Reply((ushort)BaseErrorCode.Success);
+        return Task.CompletedTask;
+    }
+
+    // one stage per client, with its accountId as the stageId
+    public async Task CreateJoinStage(IPacket packet, IApiSender apiSender)
+    {
+        var playEndpoint = ControlContext.SystemPanel.GetServerInfoBy(option.PlayServiceId).GetBindEndpoint();
+        var result = await apiSender.CreateJoinStage(playEndpoint, LoadMsgId.StageType, apiSender.AccountId,
+            new BenchPacket(new TestMsg()), new BenchPacket(new TestMsg()));
+        apiSender.Reply(result.ErrorCode);
+    }
+}
+
+internal class EchoStage(IStageSender stageSender) : IStage
+{
+    public IStageSender StageSender { get; } = stageSender;
+
+    public Task<(ushort errorCode, IPacket reply)> OnCreate(IPacket packet)
+    {
+        return Task.FromResult(((ushort)BaseErrorCode.Success, (IPacket)new BenchPacket(new TestMsg())));
+    }
+
+    public Task<(ushort errorCode, IPacket reply)> OnJoinStage(IActor actor, IPacket packet)
+    {
+        return Task.FromResult(((ushort)BaseErrorCode.Success, (IPacket)new BenchPacket(new TestMsg())));
+    }
+
+    // the received payload is released after dispatch, so a copy is echoed back
+    public Task OnDispatch(IActor actor, IPacket packet)
+    {
+        StageSender.Reply(new BenchPacket(packet.MsgId,
+            new ByteStringPayload(ByteString.CopyFrom(packet.Payload.DataSpan))));
+        return Task.CompletedTask;
+    }
+
+    public Task OnDisconnect(IActor actor)
+    {
+        return Task.CompletedTask;
+    }
+
+    public Task OnPostCreate()
+    {
+        return Task.CompletedTask;
+    }
+
+    public Task OnPostJoinStage(IActor actor)
+    {
+        return Task.CompletedTask;
+    }
+}
+
+internal class EchoActor(IActorSender actorSender) : IActor
+{
+    public IActorSender ActorSender { get; } = actorSender;
+
+    public Task OnCreate()
+    {
+        return Task.CompletedTask;
+    }
+
+    public Task OnDestroy()
+    {
+        return Task.CompletedTask;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+﻿using System.Diagnostics;
+
+namespace PlayHouseBenchmark.Load;
+
+// N clients : tcp -> session -> api authenticate -> play CreateJoinStage -> stage echo, prints throughput and the latency distribution
+public static class LoadHarness
+{
+    public static async Task RunAsync(LoadOption option)
+    {
+        LoadCluster? cluster = null;
+        string host;
+        int port;
+
+        if (string.IsNullOrEmpty(option.Host))
+        {
+            cluster = new LoadCluster(option);
+            await cluster.StartAsync();
+            host = "127.0.0.1";
+            port = cluster.SessionPort;
+        }
+        else
+        {
+            var separator = option.Host.LastIndexOf(':');
+            host = option.Host[..separator];
+            port = int.Parse(option.Host[(separator + 1)..]);
+        }
+
+        Console.WriteLine($"load start - [clients:{option.Clients}, seconds:{option.Seconds}, body:{option.BodySize}, target:{host}:{port}]");
+
+        using var cancel = new CancellationTokenSource();
+        var clients = Enumerable.Range(1, option.Clients).Select(i => new LoadClient(option, i)).ToList();
+        var tasks = clients.Select(client => client.RunAsync(host, port, cancel.Token)).ToList();
+
+        var stopwatch = Stopwatch.StartNew();
+        cancel.CancelAfter(TimeSpan.FromSeconds(option.Seconds));
+
+        var failed = 0;
+        foreach (var task in tasks)
+        {
+            try
+            {
+                await task;
+            }
+            catch (OperationCanceledException)
+            {
+            }
+            catch (Exception e)
+            {
+                failed++;
+                Console.WriteLine($"client is failed - {e.Message}");
+            }
+        }
+
+        var elapsed = stopwatch.Elapsed.TotalSeconds;
+        Report(clients, failed, elapsed);
+
+        if (cluster != null)
+        {
+            await cluster.StopAsync();
+        }
+    }
+
+    private static void Report(List<LoadClient> clients, int failed, double elapsedSec)
+    {
+        var latencies = clients.SelectMany(e => e.Latencies).ToArray();
+        Array.Sort(latencies);
+        var errors = clients.Sum(e => e.Errors);
+
+        Console.WriteLine($"requests:{latencies.Length}, errors:{errors}, failed clients:{failed}");
+        if (latencies.Length == 0)
+        {
+            return;
+        }
+
+        Console.WriteLine($"throughput:{latencies.Length / elapsedSec:F0} req/s");
+        Console.WriteLine(
+            $"latency(ms) p50:{Percentile(latencies, 0.50):F3}, p90:{Percentile(latencies, 0.90):F3}, " +
+            $"p99:{Percentile(latencies, 0.99):F3}, p999:{Percentile(latencies, 0.999):F3}, max:{ToMs(latencies[^1]):F3}");
+    }
+
+    private static double Percentile(long[] sorted, double percentile)
+    {
+        var index = (int)Math.Ceiling(percentile * sorted.Length) - 1;
+        return ToMs(sorted[Math.Clamp(index, 0, sorted.Length - 1)]);
+    }
+
+    private static double ToMs(long ticks)
+    {
+        return ticks * 1000.0 / Stopwatch.Frequency;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+﻿namespace PlayHouseBenchmark.Load;
+
+public class LoadOption
+{
+    public int Clients { get; set; } = 100;
+    public int Seconds { get; set; } = 30;
+    public int BodySize { get; set; } = 64;
+
+    // empty starts api, session and play servers in this process, "ip:port" targets a running session server
+    public string Host { get; set; } = string.Empty;
+    public ushort ApiServiceId { get; set; } = 2;
+    public ushort PlayServiceId { get; set; } = 3;
+
+    // the servers of the in-process cluster talk through LocalTransport
+    public bool LocalTransport { get; set; }
+
+    public static LoadOption Parse(string[] args)
+    {
+        var option = new LoadOption();
+        for (var i = 0; i + 1 < args.Length; i += 2)
+        {
+            var value = args[i + 1];
+            switch (args[i])
+            {
+                case "--clients":
+                    option.Clients = int.Parse(value);
+                    break;
+                case "--seconds":
+                    option.Seconds = int.Parse(value);
+                    break;
+                case "--body":
+                    option.BodySize = int.Parse(value);
+                    break;
+                case "--host":
+                    option.Host = value;
+                    break;
+                case "--api":
+                    option.ApiServiceId = ushort.Parse(value);
+                    break;
+                case "--play":
+                    option.PlayServiceId = ushort.Parse(value);
+                    break;
+                case "--local":
+                    option.LocalTransport = bool.Parse(value);
+                    break;
+                default:
+                    throw new ArgumentException($"unknown option - {args[i]}");
+            }
+        }
+
+        return option;
+    }
+}
\ No newline at end of file
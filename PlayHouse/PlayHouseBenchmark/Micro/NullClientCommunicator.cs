@@ -0,0 +1,34 @@
+﻿using NetMQ;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+
+namespace PlayHouseBenchmark.Micro;
+
+// drops sent packets right away to keep replies and sending out of the measurement
+internal class NullClientCommunicator : IClientCommunicator
+{
+    public void Connect(string endpoint)
+    {
+    }
+
+    public void Send(string endpoint, RoutePacket routePacket)
+    {
+        routePacket.Dispose();
+    }
+
+    public void Attach(NetMQPoller poller)
+    {
+    }
+
+    public void Communicate()
+    {
+    }
+
+    public void Disconnect(string endpoint)
+    {
+    }
+
+    public void Stop()
+    {
+    }
+}
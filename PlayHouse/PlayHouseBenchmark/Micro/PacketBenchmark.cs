@@ -0,0 +1,69 @@
+﻿using BenchmarkDotNet.Attributes;
+using CommonLib;
+using Google.Protobuf;
+using Org.Ulalax.Playhouse.Protocol;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Communicator.PlaySocket;
+using PlayHouse.Service.Session.Network;
+
+namespace PlayHouseBenchmark.Micro;
+
+[MemoryDiagnoser]
+public class PacketBenchmark
+{
+    private const int FrameCount = 100;
+
+    private readonly PooledByteBuffer _buffer = new(64 * 1024);
+    private readonly PacketParser _parser = new();
+    private readonly Action<ClientPacket> _onPacket = packet => packet.Dispose();
+    private ClientPacket _clientPacket = null!;
+    private byte[] _frames = null!;
+    private RouteHeader _routeHeader = null!;
+
+    [Params(16, 1024)] public int BodySize { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        PlaySocketFactory.InitBufferPool(1024 * 1024 * 100);
+
+        var body = new TestMsg { TestMsg_ = new string('a', BodySize) };
+        _clientPacket = new ClientPacket(new Header(2, "TestMsg", 1, 0, 100), new ProtoPayload(body));
+
+        // the layout a client sends (no errorCode)
+        var bodyBytes = body.ToByteArray();
+        var frame = new byte[PacketFrame.RequestHeaderSize + "TestMsg".Length + bodyBytes.Length];
+        var headerSize = PacketFrame.WriteHeader(frame, bodyBytes.Length, 2, "TestMsg", 0, 1, 100, null);
+        bodyBytes.CopyTo(frame, headerSize);
+        _frames = new byte[frame.Length * FrameCount];
+        for (var i = 0; i < FrameCount; i++)
+        {
+            frame.CopyTo(_frames, i * frame.Length);
+        }
+
+        _routeHeader = RouteHeader.Of(new Header(2, "TestMsg", 1, 0, 100));
+        _routeHeader.Sid = 1234;
+        _routeHeader.AccountId = 5678;
+        _routeHeader.From = "tcp://127.0.0.1:10000";
+    }
+
+    [Benchmark(OperationsPerInvoke = FrameCount)]
+    public void Parse()
+    {
+        _parser.Parse(_frames, _onPacket);
+    }
+
+    [Benchmark]
+    public int WriteClientPacketBytes()
+    {
+        _buffer.Clear();
+        RoutePacket.WriteClientPacketBytes(_clientPacket, _buffer);
+        return _buffer.Count;
+    }
+
+    [Benchmark]
+    public RouteHeaderMsg RouteHeaderToMsg()
+    {
+        return _routeHeader.ToMsg();
+    }
+}
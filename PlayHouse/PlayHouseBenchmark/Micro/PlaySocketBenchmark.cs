@@ -0,0 +1,96 @@
+﻿using BenchmarkDotNet.Attributes;
+using Org.Ulalax.Playhouse.Protocol;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Communicator.PlaySocket;
+
+namespace PlayHouseBenchmark.Micro;
+
+// send + receive between two router sockets connected over loopback
+[MemoryDiagnoser]
+public class PlaySocketBenchmark
+{
+    private const int BatchCount = 1000;
+
+    private NetMqPlaySocket _receiver = null!;
+    private string _receiverEndpoint = null!;
+    private NetMqPlaySocket _sender = null!;
+    private TestMsg _message = null!;
+
+    [Params(16, 1024)] public int BodySize { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        PlaySocketFactory.InitBufferPool(1024 * 1024 * 100);
+
+        _receiverEndpoint = $"tcp://127.0.0.1:{IpFinder.FindFreePort()}";
+        _receiver = new NetMqPlaySocket(new SocketConfig(), _receiverEndpoint);
+        _receiver.Bind();
+
+        _sender = new NetMqPlaySocket(new SocketConfig(), $"tcp://127.0.0.1:{IpFinder.FindFreePort()}");
+        _sender.Bind();
+        _sender.Connect(_receiverEndpoint);
+
+        _message = new TestMsg { TestMsg_ = new string('a', BodySize) };
+
+        // with RouterMandatory a send fails until the connection is established
+        var deadline = DateTime.UtcNow.AddSeconds(10);
+        while (true)
+        {
+            try
+            {
+                SendOne();
+                break;
+            }
+            catch (Exception) when (DateTime.UtcNow < deadline)
+            {
+                Thread.Sleep(10);
+            }
+        }
+
+        ReceiveAll(1);
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        _sender.Close();
+        _receiver.Close();
+    }
+
+    [Benchmark(OperationsPerInvoke = BatchCount)]
+    public void SendReceive()
+    {
+        for (var i = 0; i < BatchCount; i++)
+        {
+            SendOne();
+        }
+
+        ReceiveAll(BatchCount);
+    }
+
+    private void SendOne()
+    {
+        using var packet = RoutePacket.Of(_message);
+        _sender.Send(_receiverEndpoint, packet);
+    }
+
+    private void ReceiveAll(int count)
+    {
+        var received = 0;
+        var spin = new SpinWait();
+        while (received < count)
+        {
+            var packet = _receiver.Receive();
+            if (packet == null)
+            {
+                spin.SpinOnce();
+                continue;
+            }
+
+            packet.Dispose();
+            received++;
+        }
+    }
+}
\ No newline at end of file
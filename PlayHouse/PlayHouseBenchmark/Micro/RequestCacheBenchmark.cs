@@ -0,0 +1,41 @@
+﻿using BenchmarkDotNet.Attributes;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Service.Shared;
+
+namespace PlayHouseBenchmark.Micro;
+
+// from registering a request until the reply calls its callback
+[MemoryDiagnoser]
+public class RequestCacheBenchmark
+{
+    private const int BatchCount = 1000;
+
+    private readonly ReplyCallback _callback = (_, _) => { };
+    private RouteHeader _replyHeader = null!;
+    private RequestCache _requestCache = null!;
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        PacketProducer.Init((msgId, payload, _) => new BenchPacket(msgId, payload));
+
+        // measured including the timeout wheel
+        _requestCache = new RequestCache(5);
+        _replyHeader = RouteHeader.Of(new Header(msgId: "TestMsg"));
+    }
+
+    [Benchmark(OperationsPerInvoke = BatchCount)]
+    public void PutAndReply()
+    {
+        for (var i = 0; i < BatchCount; i++)
+        {
+            var seq = _requestCache.GetSequence();
+            _requestCache.Put(seq, new ReplyObject(_callback));
+
+            var reply = RoutePacket.Of(_replyHeader, new EmptyPayload());
+            reply.SetMsgSeq(seq);
+            _requestCache.OnReply(reply);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+﻿using BenchmarkDotNet.Attributes;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Play;
+using PlayHouse.Service.Play;
+using PlayHouse.Service.Play.Base;
+
+namespace PlayHouseBenchmark.Micro;
+
+// floods one stage with packets until its mailbox is drained, including the path through the scheduler
+[MemoryDiagnoser]
+public class StageBenchmark
+{
+    private const int PacketCount = 10000;
+    private const long StageId = 1;
+
+    private readonly ManualResetEventSlim _drained = new(false);
+    private AsyncPostCallback _callback = null!;
+    private PlayDispatcher _dispatcher = null!;
+    private int _remain;
+    private BaseStage _stage = null!;
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        var clientCommunicator = new NullClientCommunicator();
+        var requestCache = new RequestCache(0);
+        const string endpoint = "tcp://127.0.0.1:0";
+
+        _dispatcher = new PlayDispatcher(2, clientCommunicator, requestCache, new XServerInfoCenter(), endpoint,
+            new PlayOption());
+        _dispatcher.Start();
+
+        var stageSender = new XStageSender(2, StageId, _dispatcher, clientCommunicator, requestCache);
+        _stage = new BaseStage(StageId, _dispatcher, clientCommunicator, requestCache, new XServerInfoCenter(),
+            new NullSessionUpdater(), stageSender);
+
+        _callback = _ =>
+        {
+            if (--_remain == 0)
+            {
+                _drained.Set();
+            }
+
+            return Task.CompletedTask;
+        };
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        _dispatcher.Stop();
+    }
+
+    [Benchmark(OperationsPerInvoke = PacketCount)]
+    public void PostAndDrain()
+    {
+        _drained.Reset();
+        _remain = PacketCount;
+
+        for (var i = 0; i < PacketCount; i++)
+        {
+            _stage.Post(AsyncBlockPacket.Of(StageId, _callback, i));
+        }
+
+        _drained.Wait();
+    }
+
+    private class NullSessionUpdater : ISessionUpdater
+    {
+        public Task UpdateStageInfo(string sessionEndpoint, long sid)
+        {
+            return Task.CompletedTask;
+        }
+    }
+}
\ No newline at end of file
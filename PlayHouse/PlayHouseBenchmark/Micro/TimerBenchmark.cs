@@ -0,0 +1,63 @@
+﻿using BenchmarkDotNet.Attributes;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Shared;
+using PlayHouse.Service.Play;
+using PlayHouse.Service.Shared;
+
+namespace PlayHouseBenchmark.Micro;
+
+[MemoryDiagnoser]
+public class TimerBenchmark
+{
+    private const int TimerCount = 10000;
+
+    private readonly TimerCallbackTask _callback = () => Task.CompletedTask;
+    private readonly List<TimerEntry> _expired = new();
+    private long _timerId;
+    private TimerManager _timerManager = null!;
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        _timerManager = new TimerManager(new NullPlayDispatcher());
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        _timerManager.Stop();
+    }
+
+    // register and cancel only enqueue, contention with the wheel thread included
+    [Benchmark(OperationsPerInvoke = TimerCount)]
+    public void RegisterAndCancel()
+    {
+        for (var i = 0; i < TimerCount; i++)
+        {
+            var timerId = _timerManager.RegisterRepeatTimer(1, ++_timerId, 1000, 1000, _callback);
+            _timerManager.CancelTimer(timerId);
+        }
+    }
+
+    // one timer per stage all due on the next tick, the cost of one wheel tick
+    [Benchmark(OperationsPerInvoke = TimerCount)]
+    public void WheelTick()
+    {
+        var wheel = new TimerWheel();
+        for (var i = 0; i < TimerCount; i++)
+        {
+            wheel.Add(new TimerEntry(i, i, 0, 1, _callback) { DeadlineTick = 1 });
+        }
+
+        _expired.Clear();
+        wheel.Advance(_expired);
+    }
+
+    private class NullPlayDispatcher : IPlayDispatcher
+    {
+        public void OnPost(RoutePacket routePacket)
+        {
+            routePacket.Dispose();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+﻿using BenchmarkDotNet.Running;
+using PlayHouseBenchmark.Load;
+
+namespace PlayHouseBenchmark;
+
+// dotnet run -c Release -- --filter *PacketBenchmark*   : micro benchmarks (BenchmarkDotNet arguments as is)
+// dotnet run -c Release -- load --clients 100 --seconds 30 : end to end load test
+public static class Program
+{
+    public static async Task Main(string[] args)
+    {
+        if (args.Length > 0 && args[0] == "load")
+        {
+            await LoadHarness.RunAsync(LoadOption.Parse(args[1..]));
+            return;
+        }
+
+        BenchmarkSwitcher.FromAssembly(typeof(Program).Assembly).Run(args);
+    }
+}
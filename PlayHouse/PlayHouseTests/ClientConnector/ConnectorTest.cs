@@ -0,0 +1,138 @@
+﻿using System.Net;
+using System.Net.Sockets;
+using ClientConnector;
+using FluentAssertions;
+using Org.Ulalax.Playhouse.Protocol;
+using PlayHouse.Service.Session.Network;
+using Xunit;
+
+namespace PlayHouseTests.ClientConnector;
+
+// loopback server that only exchanges frames, standing in for a session
+internal sealed class FrameServer : IDisposable
+{
+    private readonly TcpListener _listener = new(IPAddress.Loopback, 0);
+    private Socket? _client;
+
+    public FrameServer()
+    {
+        _listener.Start();
+    }
+
+    public int Port => ((IPEndPoint)_listener.LocalEndpoint).Port;
+
+    public void Dispose()
+    {
+        _client?.Dispose();
+        _listener.Stop();
+    }
+
+    public async Task AcceptAsync()
+    {
+        _client = await _listener.AcceptSocketAsync();
+    }
+
+    // skips heartbeats and reads count request frames
+    public async Task<List<(FrameHeader header, byte[] body)>> ReadAsync(int count)
+    {
+        var result = new List<(FrameHeader, byte[])>();
+        var buffer = new byte[64 * 1024];
+        var received = 0;
+
+        while (result.Count < count)
+        {
+            received += await _client!.ReceiveAsync(buffer.AsMemory(received), SocketFlags.None);
+
+            int frameSize;
+            while ((frameSize = PacketFrame.FrameSizeOf(buffer.AsSpan(0, received), false)) > 0 &&
+                   received >= frameSize)
+            {
+                var header = PacketFrame.ReadHeader(buffer, false);
+                if (header.MsgSeq != 0)
+                {
+                    result.Add((header, buffer.AsSpan(header.BodyOffset, header.BodySize).ToArray()));
+                }
+
+                Buffer.BlockCopy(buffer, frameSize, buffer, 0, received - frameSize);
+                received -= frameSize;
+            }
+        }
+
+        return result;
+    }
+
+    public async Task ReplyAsync(FrameHeader request, string msgId, byte[] body, ushort errorCode = 0)
+    {
+        var frame = new byte[PacketFrame.ReplyHeaderSize + msgId.Length + body.Length];
+        var size = PacketFrame.WriteHeader(frame, body.Length, request.ServiceId, msgId, 0, request.MsgSeq,
+            request.StageId, errorCode);
+        body.CopyTo(frame, size);
+        await _client!.SendAsync(frame, SocketFlags.None);
+    }
+}
+
+public class ConnectorTest
+{
+    [Fact]
+    public async Task PipelinedRequestsAreMatchedByMsgSeq()
+    {
+        using var server = new FrameServer();
+        await using var connector = new Connector();
+        connector.Init(new ConnectorConfig { Port = server.Port, HeartBeatIntervalMs = 0 });
+
+        var accept = server.AcceptAsync();
+        await connector.ConnectAsync();
+        await accept;
+
+        // sent back to back without waiting for replies
+        var first = connector.RequestAsync(2, new Packet(new TestMsg { TestMsg_ = "first" })).AsTask();
+        var second = connector.RequestAsync(2, new Packet(new TestMsg { TestMsg_ = "second" }), 100).AsTask();
+        var third = connector.RequestAsync(2, new Packet(new TestMsg { TestMsg_ = "third" })).AsTask();
+
+        var requests = await server.ReadAsync(3);
+        requests.Select(e => e.header.MsgSeq).Should().OnlyHaveUniqueItems();
+        requests[1].header.StageId.Should().Be(100);
+
+        // replies in reverse order still reach their own requests
+        for (var i = requests.Count - 1; i >= 0; i--)
+        {
+            var (header, body) = requests[i];
+            await server.ReplyAsync(header, TestMsg.Descriptor.Name, body, (ushort)i);
+        }
+
+        using var firstReply = await first;
+        using var secondReply = await second;
+        using var thirdReply = await third;
+
+        firstReply.Parse(TestMsg.Parser).TestMsg_.Should().Be("first");
+        secondReply.Parse(TestMsg.Parser).TestMsg_.Should().Be("second");
+        secondReply.ErrorCode.Should().Be(1);
+        secondReply.StageId.Should().Be(100);
+        thirdReply.Parse(TestMsg.Parser).TestMsg_.Should().Be("third");
+        thirdReply.MsgId.Should().Be(TestMsg.Descriptor.Name);
+    }
+
+    [Fact]
+    public async Task RequestWithoutReplyShouldTimeout()
+    {
+        using var server = new FrameServer();
+        await using var connector = new Connector();
+        connector.Init(new ConnectorConfig
+            { Port = server.Port, HeartBeatIntervalMs = 0, RequestTimeoutMs = 200, MaxPendingRequests = 2 });
+
+        var accept = server.AcceptAsync();
+        await connector.ConnectAsync();
+        await accept;
+
+        var request = async () => await connector.RequestAsync(2, new Packet(new TestMsg { TestMsg_ = "lost" }));
+        await request.Should().ThrowAsync<TimeoutException>();
+
+        // a timed out slot can be used again
+        var pending = connector.RequestAsync(2, new Packet(new TestMsg { TestMsg_ = "again" })).AsTask();
+        var requests = await server.ReadAsync(2);
+        await server.ReplyAsync(requests[1].header, TestMsg.Descriptor.Name, requests[1].body);
+
+        using var reply = await pending;
+        reply.Parse(TestMsg.Parser).TestMsg_.Should().Be("again");
+    }
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 ﻿using CommonLib;
 using FluentAssertions;
+using Google.Protobuf;
+using Moq;
+using NetMQ;
 using Org.Ulalax.Playhouse.Protocol;
 using PlayHouse.Communicator;
 using PlayHouse.Communicator.Message;
@@ -92,4 +95,28 @@ public class CommunicatorTest
         sessionListener.Results.Count.Should().Be(1);
         sessionListener.Results[0].MsgId.Should().Be(messageId);
     }
+
+    [Fact]
+    public void Invalid_message_should_not_stop_the_receive_loop()
+    {
+        Action? receiveReady = null;
+        var playSocket = new Mock<IPlaySocket>();
+        playSocket.Setup(s => s.Attach(It.IsAny<NetMQPoller>(), It.IsAny<Action>()))
+            .Callback<NetMQPoller, Action>((_, action) => receiveReady = action);
+        playSocket.SetupSequence(s => s.Receive())
+            .Throws(new InvalidProtocolBufferException("broken header"))
+            .Returns(RoutePacket.Of(new TestMsg { TestMsg_ = "after" }))
+            .Returns((RoutePacket?)null);
+
+        var listener = new TestListener();
+        var communicator = new XServerCommunicator(playSocket.Object);
+        communicator.Bind(listener);
+        using var poller = new NetMQPoller();
+        communicator.Attach(poller);
+
+        receiveReady!.Invoke();
+
+        listener.Results.Should().HaveCount(1);
+        TestMsg.Parser.ParseFrom(listener.Results[0].Span).TestMsg_.Should().Be("after");
+    }
 }
\ No newline at end of file
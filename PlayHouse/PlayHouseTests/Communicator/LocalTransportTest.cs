@@ -0,0 +1,105 @@
+﻿using System.Buffers.Binary;
+using CommonLib;
+using FluentAssertions;
+using Google.Protobuf;
+using NetMQ;
+using Org.Ulalax.Playhouse.Protocol;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Communicator.PlaySocket;
+using Playhouse.Protocol;
+using Xunit;
+
+namespace PlayHouseTests.Communicator;
+
+[Collection("ZSocketCommunicateTest")]
+public class LocalTransportTest : IDisposable
+{
+    private readonly XClientCommunicator _client;
+    private readonly string _clientEndpoint;
+    private readonly LocalEndpoint _localEndpoint;
+    private readonly TestListener _listener = new();
+    private readonly NetMQPoller _poller = new();
+    private readonly string _targetEndpoint;
+
+    public LocalTransportTest()
+    {
+        PooledBuffer.Init();
+
+        var localIp = IpFinder.FindLocalIp();
+        _clientEndpoint = $"tcp://{localIp}:{IpFinder.FindFreePort()}";
+        _targetEndpoint = $"tcp://{localIp}:{IpFinder.FindFreePort()}";
+
+        _client = new XClientCommunicator(new NetMqPlaySocket(new SocketConfig(), _clientEndpoint),
+            useLocalTransport: true);
+
+        _localEndpoint = new LocalEndpoint(_listener);
+        _localEndpoint.Attach(_poller);
+        _poller.RunAsync();
+        LocalTransport.Register(_targetEndpoint, _localEndpoint);
+    }
+
+    public void Dispose()
+    {
+        LocalTransport.Unregister(_targetEndpoint, _localEndpoint);
+        _poller.Stop();
+        _poller.Dispose();
+        _localEndpoint.Dispose();
+    }
+
+    private RoutePacket Received()
+    {
+        SpinWait.SpinUntil(() => _listener.Results.Count > 0, TimeSpan.FromSeconds(3));
+        _listener.Results.Count.Should().Be(1);
+        return _listener.Results[0];
+    }
+
+    [Fact]
+    public void Reply_should_keep_msgSeq_and_come_from_sender()
+    {
+        var message = new TestMsg { TestMsg_ = "local" };
+        var sourceHeader = new RouteHeader(new Header(msgSeq: 7)) { IsBackend = true };
+        var reply = RoutePacket.ReplyOf(2, sourceHeader, 0, new TestPacket(message));
+
+        _client.Send(_targetEndpoint, reply);
+
+        var packet = Received();
+        packet.RouteHeader.From.Should().Be(_clientEndpoint);
+        packet.MsgId.Should().Be(TestMsg.Descriptor.Name);
+        packet.MsgSeq.Should().Be(7);
+        packet.IsReply().Should().BeTrue();
+        packet.IsBackend().Should().BeTrue();
+        packet.IsToClient().Should().BeFalse();
+        TestMsg.Parser.ParseFrom(packet.Span).TestMsg_.Should().Be("local");
+    }
+
+    [Fact]
+    public void Client_packet_should_be_framed_like_socket()
+    {
+        var message = new TestMsg { TestMsg_ = "client" };
+        var routePacket = RoutePacket.ClientOf(3, 11, new TestPacket(message), 5);
+
+        _client.Send(_targetEndpoint, routePacket);
+
+        var packet = Received();
+        packet.RouteHeader.Sid.Should().Be(11);
+        packet.IsToClient().Should().BeFalse();
+
+        var frame = packet.Span;
+        var body = message.ToByteArray();
+        BinaryPrimitives.ReadInt32BigEndian(frame).Should().Be(body.Length);
+        BinaryPrimitives.ReadUInt16BigEndian(frame[4..]).Should().Be(3);
+        frame[^body.Length..].ToArray().Should().Equal(body);
+    }
+
+    [Fact]
+    public void Unregistered_endpoint_should_go_through_socket()
+    {
+        LocalTransport.Unregister(_targetEndpoint, _localEndpoint);
+
+        _client.Send(_targetEndpoint, RoutePacket.Of(new HeaderMsg()));
+
+        Thread.Sleep(100);
+        _listener.Results.Should().BeEmpty();
+    }
+}
\ No newline at end of file
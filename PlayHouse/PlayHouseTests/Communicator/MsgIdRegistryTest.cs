@@ -0,0 +1,72 @@
+﻿using FluentAssertions;
+using PlayHouse.Communicator.Message;
+using Playhouse.Protocol;
+using Xunit;
+
+namespace PlayHouseTests.Communicator;
+
+public class MsgIdRegistryTest
+{
+    [Fact]
+    public void IdOf_Should_Be_Fnv1a_Of_MsgId()
+    {
+        MsgIdRegistry.IdOf("a").Should().Be(unchecked((int)0xe40c292c));
+        MsgIdRegistry.IdOf("").Should().Be(0);
+    }
+
+    [Fact]
+    public void Proto_Messages_Should_Be_Registered_By_Default()
+    {
+        var id = MsgIdRegistry.IdOf(CreateStageReq.Descriptor.Name);
+
+        MsgIdRegistry.IsRegistered(id).Should().BeTrue();
+        MsgIdRegistry.NameOf(id).Should().BeSameAs(CreateStageReq.Descriptor.Name);
+    }
+
+    [Fact]
+    public void Header_Should_Resolve_Numeric_MsgId()
+    {
+        var id = MsgIdRegistry.Register("MsgIdRegistryTestMsg");
+
+        var header = Header.Of(new HeaderMsg { MsgNum = id, MsgSeq = 1 });
+
+        header.MsgId.Should().Be("MsgIdRegistryTestMsg");
+        header.MsgNum.Should().Be(id);
+    }
+
+    [Fact]
+    public void MsgNum_Should_Follow_MsgId_Change()
+    {
+        var header = new Header(msgId: "first");
+        var first = header.MsgNum;
+
+        header.MsgId = "second";
+
+        header.MsgNum.Should().NotBe(first);
+        header.MsgNum.Should().Be(MsgIdRegistry.IdOf("second"));
+    }
+
+    [Fact]
+    public void Unknown_Numeric_MsgId_Should_Keep_The_Id()
+    {
+        var id = MsgIdRegistry.IdOf("MsgIdRegistryTestUnknownMsg");
+
+        var header = Header.Of(new HeaderMsg { MsgNum = id, MsgSeq = 1 });
+
+        header.MsgId.Should().BeEmpty();
+        header.MsgNum.Should().Be(id);
+
+        // without a known name the received numeric id is passed on as is
+        header.ToMsg().MsgNum.Should().Be(id);
+    }
+
+    [Fact]
+    public void Locally_Registered_MsgId_Should_Be_Sent_As_String()
+    {
+        var id = MsgIdRegistry.Register("MsgIdRegistryTestLocalMsg");
+
+        MsgIdRegistry.IsShared(id).Should().BeFalse();
+        MsgIdRegistry.WriteNumeric("MsgIdRegistryTestLocalMsg", id).Should().BeFalse();
+        MsgIdRegistry.IsShared(MsgIdRegistry.IdOf(CreateStageReq.Descriptor.Name)).Should().BeTrue();
+    }
+}
\ No newline at end of file
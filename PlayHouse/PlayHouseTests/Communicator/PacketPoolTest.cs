@@ -0,0 +1,88 @@
+﻿using FluentAssertions;
+using PlayHouse.Communicator.Message;
+using Xunit;
+
+namespace PlayHouseTests.Communicator;
+
+public class PacketPoolTest
+{
+    [Fact]
+    public void Returned_Item_Should_Be_Rented_Again_On_The_Same_Thread()
+    {
+        var pool = new ObjectPool<object>(() => new object(), 4, 4);
+        var item = pool.Rent();
+
+        pool.Return(item);
+
+        pool.Rent().Should().BeSameAs(item);
+    }
+
+    [Fact]
+    public void Item_Returned_On_Another_Thread_Should_Come_Back_Through_Shared_Queue()
+    {
+        var pool = new ObjectPool<object>(() => new object(), 0, 4);
+        var item = pool.Rent();
+
+        var thread = new Thread(() => pool.Return(item));
+        thread.Start();
+        thread.Join();
+
+        pool.Rent().Should().BeSameAs(item);
+    }
+
+    [Fact]
+    public void MoveOf_Should_Move_Payload_And_Keep_Header()
+    {
+        var payload = new ProtoPayload(new Playhouse.Protocol.HeaderMsg { MsgId = "test" });
+        var source = RoutePacket.Of("test", payload);
+        var routeHeader = source.RouteHeader;
+
+        var moved = RoutePacket.MoveOf(source);
+        source.Dispose();
+
+        moved.Payload.Should().BeSameAs(payload);
+        moved.RouteHeader.Should().BeSameAs(routeHeader);
+        moved.MsgId.Should().Be("test");
+    }
+    private class CountingPayload : IPayload
+    {
+        public int Disposed { get; private set; }
+        public ReadOnlyMemory<byte> Data => new byte[] { 1 };
+
+        public void Dispose()
+        {
+            Disposed++;
+        }
+    }
+
+    [Fact]
+    public void MoveOf_Should_Dispose_Once_After_The_Last_Owner()
+    {
+        var payload = new CountingPayload();
+        var source = RoutePacket.Of("test", payload);
+
+        var moved = RoutePacket.MoveOf(source);
+        moved.Should().BeSameAs(source);
+
+        source.Dispose();
+        payload.Disposed.Should().Be(0);
+        moved.Span.ToArray().Should().Equal(1);
+
+        moved.Dispose();
+        payload.Disposed.Should().Be(1);
+    }
+
+    [Fact]
+    public void MoveOf_Should_Keep_AsyncBlock_State()
+    {
+        var result = new object();
+        var source = AsyncBlockPacket.Of(1, _ => Task.CompletedTask, result);
+
+        var moved = (AsyncBlockPacket)RoutePacket.MoveOf(source);
+        source.Dispose();
+
+        moved.Result.Should().BeSameAs(result);
+        moved.StageId.Should().Be(1);
+        moved.Dispose();
+    }
+}
\ No newline at end of file
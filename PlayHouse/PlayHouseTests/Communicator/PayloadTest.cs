@@ -0,0 +1,63 @@
+﻿using System.Buffers;
+using FluentAssertions;
+using Google.Protobuf;
+using PlayHouse.Communicator.Message;
+using Playhouse.Protocol;
+using Xunit;
+
+namespace PlayHouseTests.Communicator;
+
+public class PayloadTest
+{
+    private readonly HeaderMsg _proto = new() { MsgId = "test", MsgSeq = 3, StageId = 100 };
+
+    [Fact]
+    public void ProtoPayload_Should_Serialize_Once()
+    {
+        IPayload payload = new ProtoPayload(_proto);
+
+        payload.Length.Should().Be(_proto.CalculateSize());
+        payload.Data.Equals(payload.Data).Should().BeTrue();
+        payload.DataSpan.ToArray().Should().Equal(_proto.ToByteArray());
+    }
+
+    [Fact]
+    public void ProtoPayload_Should_Write_Directly_Into_BufferWriter()
+    {
+        IPayload payload = new ProtoPayload(_proto);
+        var writer = new ArrayBufferWriter<byte>();
+
+        payload.WriteTo(writer);
+
+        writer.WrittenSpan.ToArray().Should().Equal(_proto.ToByteArray());
+    }
+
+    [Fact]
+    public void ProtoPayload_Should_Cache_Bytes_From_Second_Write()
+    {
+        IPayload payload = new ProtoPayload(_proto);
+        var first = new byte[payload.Length];
+        payload.WriteTo(first);
+        var second = new byte[payload.Length];
+        payload.WriteTo(second);
+
+        second.Should().Equal(first);
+
+        // once written twice the cached bytes go out even if the proto changes
+        _proto.MsgSeq = 4;
+        var third = new byte[payload.Length];
+        payload.WriteTo(third);
+
+        third.Should().Equal(first);
+        payload.Data.ToArray().Should().Equal(first);
+    }
+
+    [Fact]
+    public void ByteStringPayload_Should_Expose_Memory_Without_Copy()
+    {
+        var byteString = _proto.ToByteString();
+        IPayload payload = new ByteStringPayload(byteString);
+
+        payload.Data.Equals(byteString.Memory).Should().BeTrue();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+﻿using System.Diagnostics.Metrics;
+using FluentAssertions;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using Xunit;
+
+namespace PlayHouseTests.Communicator;
+
+public class PlayMetricsTest
+{
+    [Fact]
+    public void MailboxWait_Should_Be_Recorded_Only_While_Listening()
+    {
+        using var packet = RoutePacket.Of("test", new EmptyPayload());
+
+        PlayMetrics.OnPosted(packet);
+        packet.PostedAt.Should().Be(0);
+
+        var recorded = new List<double>();
+        using var listener = new MeterListener();
+        listener.InstrumentPublished = (instrument, l) =>
+        {
+            if (instrument.Meter.Name == PlayMetrics.MeterName && instrument.Name == "playhouse.mailbox.wait")
+            {
+                l.EnableMeasurementEvents(instrument);
+            }
+        };
+        listener.SetMeasurementEventCallback<double>((_, value, tags, _) =>
+        {
+            foreach (var tag in tags)
+            {
+                if (tag is { Key: "actor", Value: "metrics-test" })
+                {
+                    recorded.Add(value);
+                }
+            }
+        });
+        listener.Start();
+
+        PlayMetrics.OnPosted(packet);
+        packet.PostedAt.Should().NotBe(0);
+        PlayMetrics.OnDequeued(packet, "metrics-test");
+
+        recorded.Should().ContainSingle().Which.Should().BeGreaterOrEqualTo(0);
+    }
+
+    [Fact]
+    public void MailboxDepth_Should_Not_Be_Reported_After_Dispose()
+    {
+        var observed = new List<long>();
+        using var listener = new MeterListener();
+        listener.InstrumentPublished = (instrument, l) =>
+        {
+            if (instrument.Meter.Name == PlayMetrics.MeterName && instrument.Name == "playhouse.mailbox.depth")
+            {
+                l.EnableMeasurementEvents(instrument);
+            }
+        };
+        listener.SetMeasurementEventCallback<long>((_, value, tags, _) =>
+        {
+            foreach (var tag in tags)
+            {
+                if (tag is { Key: "actor", Value: "depth-test" })
+                {
+                    observed.Add(value);
+                }
+            }
+        });
+        listener.Start();
+
+        var registration = PlayMetrics.ObserveMailbox("depth-test", () => 5);
+        listener.RecordObservableInstruments();
+        observed.Should().Equal(5);
+
+        registration.Dispose();
+        listener.RecordObservableInstruments();
+        observed.Should().Equal(5);
+    }
+}
\ No newline at end of file
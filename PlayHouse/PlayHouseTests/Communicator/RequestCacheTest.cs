@@ -0,0 +1,91 @@
+﻿using FluentAssertions;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Service.Shared;
+using PlayHouse.Utils;
+using Xunit;
+
+namespace PlayHouseTests.Communicator;
+
+public class RequestCacheTest
+{
+    private static RoutePacket ReplyOf(ushort msgSeq)
+    {
+        return RoutePacket.Of(RouteHeader.Of(new Header(msgId: "reply", msgSeq: msgSeq)), new EmptyPayload());
+    }
+
+    [Fact]
+    public async Task Reply_Should_Complete_Pending_Request()
+    {
+        var cache = new RequestCache(0);
+        var seq = cache.GetSequence();
+        var deferred = new TaskCompletionSource<RoutePacket>();
+        cache.Put(seq, new ReplyObject(null, deferred));
+
+        cache.InFlightCount.Should().Be(1);
+
+        cache.OnReply(ReplyOf(seq));
+
+        (await deferred.Task).MsgSeq.Should().Be(seq);
+        cache.InFlightCount.Should().Be(0);
+        cache.Get(seq).Should().BeNull();
+    }
+
+    [Fact]
+    public void Reply_Without_Request_Should_Be_Counted_As_Late()
+    {
+        var cache = new RequestCache(0);
+
+        cache.OnReply(ReplyOf(100));
+
+        cache.LateReplyCount.Should().Be(1);
+    }
+
+    [Fact]
+    public async Task Pending_Request_Should_Time_Out()
+    {
+        var cache = new RequestCache(1);
+        var seq = cache.GetSequence();
+        var deferred = new TaskCompletionSource<RoutePacket>();
+        cache.Put(seq, new ReplyObject(null, deferred));
+
+        var action = async () => await deferred.Task.WaitAsync(TimeSpan.FromSeconds(5));
+
+        await action.Should().ThrowAsync<PlayHouseException>();
+        cache.TimedOutCount.Should().Be(1);
+        cache.InFlightCount.Should().Be(0);
+
+        cache.OnReply(ReplyOf(seq));
+        cache.LateReplyCount.Should().Be(1);
+    }
+
+    [Fact]
+    public async Task Failing_Timeout_Should_Not_Stop_The_Rest_Of_The_Bucket()
+    {
+        var cache = new RequestCache(1);
+
+        // the task is already completed, so timing it out throws
+        var completed = new TaskCompletionSource<RoutePacket>();
+        completed.SetResult(ReplyOf(0));
+        cache.Put(cache.GetSequence(), new ReplyObject(null, completed));
+
+        var pending = new TaskCompletionSource<RoutePacket>();
+        cache.Put(cache.GetSequence(), new ReplyObject(null, pending));
+
+        var action = async () => await pending.Task.WaitAsync(TimeSpan.FromSeconds(5));
+        await action.Should().ThrowAsync<PlayHouseException>();
+        cache.TimedOutCount.Should().Be(2);
+
+        cache.Stop();
+    }
+
+    [Fact]
+    public void Sequence_Should_Skip_Zero()
+    {
+        var cache = new RequestCache(0);
+        for (var i = 0; i < ushort.MaxValue + 10; i++)
+        {
+            cache.GetSequence().Should().NotBe(0);
+        }
+    }
+}
\ No newline at end of file
@@ -120,4 +120,51 @@ public class ServerInfoCenterFuncSpecTest
         _serverInfoCenter.Update(_serverList);
         _serverInfoCenter.GetServerList().Should().HaveCount(9);
     }
+
+    [Fact]
+    public void AccountShouldStayOnItsServerWhenAnotherServerLeaves()
+    {
+        _serverInfoCenter.Update(_serverList);
+        var serviceId = (ushort)ServiceType.API;
+
+        var before = Enumerable.Range(0, 1000)
+            .ToDictionary(accountId => (long)accountId,
+                accountId => _serverInfoCenter.FindServerByAccountId(serviceId, accountId).GetBindEndpoint());
+
+        _serverInfoCenter.Update(new List<XServerInfo>
+        {
+            XServerInfo.Of("tcp://127.0.0.1:0011", ServiceType.API, serviceId, ServerState.DISABLE, 1, _curTime)
+        });
+
+        foreach (var (accountId, endpoint) in before)
+        {
+            var after = _serverInfoCenter.FindServerByAccountId(serviceId, accountId).GetBindEndpoint();
+            if (endpoint != "tcp://127.0.0.1:0011")
+            {
+                after.Should().Be(endpoint);
+            }
+            else
+            {
+                after.Should().NotBe(endpoint);
+            }
+        }
+
+        before.Values.Distinct().Should().HaveCount(3);
+    }
+
+    [Fact]
+    public void LoadAwareStrategyShouldAvoidTheBusiestServer()
+    {
+        _serverInfoCenter.Update(_serverList);
+        var serviceId = (ushort)ServiceType.API;
+
+        _serverInfoCenter.FindServerBy(serviceId, ServerSelectStrategy.LeastActor).GetBindEndpoint().Should()
+            .Be("tcp://127.0.0.1:0001");
+
+        for (var i = 0; i < 100; i++)
+        {
+            _serverInfoCenter.FindServerBy(serviceId, ServerSelectStrategy.PowerOfTwoChoices).GetBindEndpoint()
+                .Should().NotBe("tcp://127.0.0.1:0021");
+        }
+    }
 }
\ No newline at end of file
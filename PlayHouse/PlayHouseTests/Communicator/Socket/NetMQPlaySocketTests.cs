@@ -98,4 +98,35 @@ public class NetMQPlaySocketTests : IDisposable
 
         receiveBody.Should().Be(message);
     }
+
+    [Fact]
+    public void Received_Body_Should_Be_Forwarded_And_Released()
+    {
+        // a large body is received into a pool buffer and owned by the payload without a copy
+        var message = new TestMsg { TestMsg_ = new string('x', 64 * 1024), TestNumber = 3 };
+        var header = new HeaderMsg { MsgId = TestMsg.Descriptor.Name };
+        clientSocket!.Send(serverBindEndpoint, RoutePacket.Of(RouteHeader.Of(header), new ProtoPayload(message)));
+
+        var received = ReceiveFrom(serverSocket!);
+        received.Payload.Should().BeOfType<MsgPayload>();
+
+        // the received body is forwarded as is and goes back to the pool once sent
+        serverSocket!.Send(clientBindEndpoint, received);
+
+        using var forwarded = ReceiveFrom(clientSocket);
+        TestMsg.Parser.ParseFrom(forwarded.Span).Should().Be(message);
+    }
+
+    private static RoutePacket ReceiveFrom(NetMqPlaySocket socket)
+    {
+        RoutePacket? packet = null;
+        for (var i = 0; packet == null && i < 300; i++)
+        {
+            packet = socket.Receive();
+            Thread.Sleep(10);
+        }
+
+        packet.Should().NotBeNull();
+        return packet!;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+﻿using FluentAssertions;
+using Moq;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Shared;
+using PlayHouse.Service.Api;
+using PlayHouse.Service.Shared;
+using Xunit;
+
+namespace PlayHouseTests.Service.Api;
+
+public class ApiActorRegistryTest
+{
+    private readonly IClientCommunicator _communicator = Mock.Of<IClientCommunicator>();
+
+    private ApiActor NewActor(long _)
+    {
+        // only base packets are sent, so reflection is never used
+        return new ApiActor(1, new RequestCache(0), _communicator, null!, null!);
+    }
+
+    private static RoutePacket BasePacketOf(string msgId)
+    {
+        var packet = RoutePacket.Of(msgId, new EmptyPayload());
+        packet.RouteHeader.IsBase = true;
+        return packet;
+    }
+
+    [Fact]
+    public void SameAccount_ShouldUseTheSameActor()
+    {
+        using var registry = new ApiActorRegistry(NewActor, 0);
+
+        registry.Post(1, BasePacketOf("a"));
+        var actor = registry.Find(1);
+        registry.Post(1, BasePacketOf("b"));
+        registry.Post(2, BasePacketOf("c"));
+
+        registry.Find(1).Should().BeSameAs(actor);
+        registry.Count.Should().Be(2);
+    }
+
+    [Fact]
+    public void IdleActor_ShouldBeEvicted_OnlyAfterTheTimeout()
+    {
+        using var registry = new ApiActorRegistry(NewActor, 60000);
+        registry.Post(1, BasePacketOf("a"));
+        var actor = registry.Find(1)!;
+        SpinWait.SpinUntil(() => actor.QueueCount == 0, 1000);
+        var now = Environment.TickCount64;
+
+        registry.Evict(now + 1000).Should().Be(0);
+        SpinWait.SpinUntil(() => registry.Evict(now + 61000) == 1, 1000);
+
+        registry.Count.Should().Be(0);
+        actor.IsEvicted.Should().BeTrue();
+    }
+
+    [Fact]
+    public void EvictedActor_ShouldNotTakePackets_AndRegistryShouldCreateANewOne()
+    {
+        // 0 so the timer never evicts, the test evicts directly
+        using var registry = new ApiActorRegistry(NewActor, 0);
+        registry.Post(1, BasePacketOf("a"));
+        var actor = registry.Find(1)!;
+        SpinWait.SpinUntil(() => actor.TryEvict(Environment.TickCount64 + 10, 1), 1000);
+
+        var packet = BasePacketOf("b");
+        actor.TryPost(packet).Should().BeFalse();
+
+        registry.Post(1, packet);
+        registry.Find(1).Should().NotBeSameAs(actor);
+        registry.Count.Should().Be(1);
+    }
+
+    [Fact]
+    public void RecentlyUsedActor_ShouldNotBeEvicted()
+    {
+        var actor = NewActor(1);
+        actor.TryPost(BasePacketOf("a")).Should().BeTrue();
+        SpinWait.SpinUntil(() => actor.QueueCount == 0, 1000);
+
+        actor.TryEvict(Environment.TickCount64, 60000).Should().BeFalse();
+        actor.IsEvicted.Should().BeFalse();
+        actor.TryPost(BasePacketOf("b")).Should().BeTrue();
+    }
+
+    [Fact]
+    public async Task WorkerPool_ShouldBoundConcurrency()
+    {
+        var running = 0;
+        var maxRunning = 0;
+        var done = 0;
+        var mailbox = new Mailbox(1, _communicator, 0, MailboxOverflowPolicy.Reject);
+        var pool = new ApiWorkerPool(mailbox, 2, async _ =>
+        {
+            var now = Interlocked.Increment(ref running);
+            InterlockedMax(ref maxRunning, now);
+            await Task.Delay(10);
+            Interlocked.Decrement(ref running);
+            Interlocked.Increment(ref done);
+        });
+
+        for (var i = 0; i < 20; i++)
+        {
+            pool.Post(BasePacketOf($"{i}"));
+        }
+
+        await WaitUntil(() => Volatile.Read(ref done) == 20);
+        maxRunning.Should().BeLessOrEqualTo(2);
+        pool.WorkerCount.Should().Be(0);
+    }
+
+    [Fact]
+    public void WorkerPool_ShouldRejectRequestsOverCapacity()
+    {
+        var gate = new TaskCompletionSource();
+        var mailbox = new Mailbox(1, _communicator, 1, MailboxOverflowPolicy.Reject);
+        var pool = new ApiWorkerPool(mailbox, 1, _ => gate.Task);
+
+        pool.Post(BasePacketOf("running"));
+        SpinWait.SpinUntil(() => pool.QueueCount == 0, 1000);
+        pool.Post(RoutePacket.Of("queued", new EmptyPayload()));
+
+        var rejected = RoutePacket.Of("rejected", new EmptyPayload());
+        rejected.RouteHeader.Header.MsgSeq = 3;
+        rejected.RouteHeader.From = "tcp://127.0.0.1:0001";
+        pool.Post(rejected);
+
+        Mock.Get(_communicator).Verify(c => c.Send("tcp://127.0.0.1:0001",
+            It.Is<RoutePacket>(p => p.Header.MsgSeq == 3)));
+        gate.SetResult();
+    }
+
+    private static void InterlockedMax(ref int target, int value)
+    {
+        int current;
+        while ((current = Volatile.Read(ref target)) < value &&
+               Interlocked.CompareExchange(ref target, value, current) != current)
+        {
+        }
+    }
+
+    private static async Task WaitUntil(Func<bool> condition)
+    {
+        for (var i = 0; i < 500 && !condition(); i++)
+        {
+            await Task.Delay(10);
+        }
+    }
+}
\ No newline at end of file
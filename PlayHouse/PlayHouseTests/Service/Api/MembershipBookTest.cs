@@ -0,0 +1,86 @@
+﻿using FluentAssertions;
+using PlayHouse.Communicator;
+using PlayHouse.Production.Shared;
+using PlayHouse.Service.Api;
+using Xunit;
+
+namespace PlayHouseTests.Service.Api;
+
+public class MembershipBookTest
+{
+    private static List<IServerInfo> ServersOf(long timestamp, params string[] endpoints)
+    {
+        return endpoints.Select(e => (IServerInfo)XServerInfo.Of(e, ServiceType.Play, (ushort)ServiceType.Play,
+            ServerState.RUNNING, 0, timestamp)).ToList();
+    }
+
+    [Fact]
+    public void Should_Send_Only_Changes_After_Known_Version()
+    {
+        var book = new MembershipBook(8.0, 3000);
+
+        var full = book.Apply(ServersOf(1, "tcp://127.0.0.1:0001", "tcp://127.0.0.1:0002"), 0, 0);
+        full.Delta.Should().BeFalse();
+        full.ServerInfos.Should().HaveCount(2);
+
+        var same = book.Apply(ServersOf(2, "tcp://127.0.0.1:0001", "tcp://127.0.0.1:0002"), full.Epoch, full.Version);
+        same.Delta.Should().BeTrue();
+        same.ServerInfos.Should().BeEmpty();
+
+        var left = book.Apply(ServersOf(3, "tcp://127.0.0.1:0001"), same.Epoch, same.Version);
+        left.Delta.Should().BeTrue();
+        left.ServerInfos.Should().ContainSingle(e => e.Endpoint == "tcp://127.0.0.1:0002" &&
+                                                     e.ServerState == nameof(ServerState.DISABLE));
+    }
+
+    [Fact]
+    public void Should_Send_Full_List_When_Epoch_Is_Unknown()
+    {
+        var book = new MembershipBook(8.0, 3000);
+        var first = book.Apply(ServersOf(1, "tcp://127.0.0.1:0001"), 0, 0);
+
+        var res = book.Apply(ServersOf(2, "tcp://127.0.0.1:0001"), first.Epoch + 1, first.Version);
+        res.Delta.Should().BeFalse();
+        res.ServerInfos.Should().HaveCount(1);
+    }
+
+    [Fact]
+    public void Phi_Should_Grow_While_Heartbeats_Are_Missing()
+    {
+        var detector = new PhiAccrualDetector(1000, 0);
+        for (var i = 0; i <= 10; i++)
+        {
+            detector.Heartbeat(i * 1000);
+        }
+
+        detector.IsAvailable(10_500, 8.0).Should().BeTrue();
+        detector.IsAvailable(20_000, 8.0).Should().BeFalse();
+    }
+
+    [Fact]
+    public void Small_Load_Change_Should_Be_Published_After_Refresh_Interval()
+    {
+        var book = new MembershipBook(8.0, 3000, 0);
+        var first = book.Apply(ServersOf(1, "tcp://127.0.0.1:0001"), 0, 0);
+
+        var loaded = new List<IServerInfo>
+        {
+            XServerInfo.Of("tcp://127.0.0.1:0001", ServiceType.Play, (ushort)ServiceType.Play, ServerState.RUNNING, 3, 2)
+        };
+
+        var res = book.Apply(loaded, first.Epoch, first.Version);
+        res.Delta.Should().BeTrue();
+        res.ServerInfos.Should().ContainSingle(e => e.ActorCount == 3);
+    }
+
+    [Fact]
+    public void Partial_List_Should_Not_Remove_Unseen_Servers()
+    {
+        var book = new MembershipBook(8.0, 3000);
+        var full = book.Apply(ServersOf(1, "tcp://127.0.0.1:0001", "tcp://127.0.0.1:0002"), 0, 0);
+
+        var partial = book.Apply(ServersOf(2, "tcp://127.0.0.1:0001"), full.Epoch, full.Version, false);
+        partial.Delta.Should().BeTrue();
+        partial.ServerInfos.Should().BeEmpty();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+﻿using FluentAssertions;
+using Moq;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Shared;
+using Playhouse.Protocol;
+using PlayHouse.Service.Shared;
+using Xunit;
+
+namespace PlayHouseTests.Service;
+
+public class MailboxTest
+{
+    private readonly Mock<IClientCommunicator> _communicator = new();
+
+    private static RoutePacket PacketOf(string msgId, ushort msgSeq = 0)
+    {
+        var packet = RoutePacket.Of(msgId, new EmptyPayload());
+        packet.RouteHeader.Header.MsgSeq = msgSeq;
+        packet.RouteHeader.From = "tcp://127.0.0.1:0001";
+        return packet;
+    }
+
+    [Fact]
+    public void DropOldest_Should_Keep_The_Latest_Packets()
+    {
+        var mailbox = new Mailbox(1, _communicator.Object, 2, MailboxOverflowPolicy.DropOldest);
+
+        mailbox.Post(PacketOf("1")).Should().BeTrue();
+        mailbox.Post(PacketOf("2")).Should().BeTrue();
+        mailbox.Post(PacketOf("3")).Should().BeTrue();
+
+        mailbox.Count.Should().Be(2);
+        mailbox.TryDequeue(out var first).Should().BeTrue();
+        first.MsgId.Should().Be("2");
+    }
+
+    [Fact]
+    public void Request_Should_Be_Rejected_With_ServerBusy()
+    {
+        var mailbox = new Mailbox(1, _communicator.Object, 1, MailboxOverflowPolicy.DropOldest);
+
+        mailbox.Post(PacketOf("1")).Should().BeTrue();
+        mailbox.Post(PacketOf("2", 7)).Should().BeFalse();
+
+        _communicator.Verify(c => c.Send("tcp://127.0.0.1:0001",
+            It.Is<RoutePacket>(p => p.Header.MsgSeq == 7 && p.ErrorCode == (ushort)BaseErrorCode.ServerBusy)));
+        mailbox.Count.Should().Be(1);
+    }
+    [Fact]
+    public void Dropped_Reply_Should_Not_Be_Answered()
+    {
+        Header? dropped = null;
+        var mailbox = new Mailbox(1, _communicator.Object, 1, MailboxOverflowPolicy.Reject)
+            { ClientReplyDropped = header => dropped = header };
+
+        mailbox.Post(PacketOf("1")).Should().BeTrue();
+
+        var reply = PacketOf("2", 7);
+        reply.RouteHeader.IsReply = true;
+        reply.RouteHeader.IsToClient = true;
+        mailbox.Post(reply).Should().BeFalse();
+
+        _communicator.Verify(c => c.Send(It.IsAny<string>(), It.IsAny<RoutePacket>()), Times.Never());
+        dropped!.MsgSeq.Should().Be(7);
+    }
+
+    [Fact]
+    public void DropOldest_Should_Not_Reorder_Base_Packets()
+    {
+        var mailbox = new Mailbox(1, _communicator.Object, 2, MailboxOverflowPolicy.DropOldest);
+
+        var basePacket = PacketOf("base");
+        basePacket.RouteHeader.IsBase = true;
+        mailbox.Post(basePacket).Should().BeTrue();
+        mailbox.Post(PacketOf("1")).Should().BeTrue();
+
+        // with a system packet at the head the new packet is dropped
+        mailbox.Post(PacketOf("2")).Should().BeFalse();
+        mailbox.Post(PacketOf("3")).Should().BeFalse();
+
+        mailbox.Count.Should().Be(2);
+        mailbox.TryDequeue(out var first).Should().BeTrue();
+        first.MsgId.Should().Be("base");
+        mailbox.TryDequeue(out var second).Should().BeTrue();
+        second.MsgId.Should().Be("1");
+    }
+}
\ No newline at end of file
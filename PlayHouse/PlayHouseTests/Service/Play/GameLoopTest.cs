@@ -0,0 +1,179 @@
+﻿using System.Collections.Concurrent;
+using FluentAssertions;
+using Moq;
+using Org.Ulalax.Playhouse.Protocol;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Play;
+using PlayHouse.Production.Shared;
+using PlayHouse.Service.Play;
+using PlayHouse.Service.Play.Base;
+using PlayHouse.Service.Shared;
+using Xunit;
+
+namespace PlayHouseTests.Service.Play;
+
+internal class LoopStage(IStageSender stageSender) : IGameLoopStage
+{
+    public readonly ConcurrentQueue<(string name, int inputs, TimeSpan delta)> Events = new();
+
+    public IStageSender StageSender { get; } = stageSender;
+    public int TickRate => 50;
+
+    public Task<(ushort errorCode, IPacket reply)> OnCreate(IPacket packet)
+    {
+        return Task.FromResult<(ushort, IPacket)>((0, new TestPacket("created")));
+    }
+
+    public Task<(ushort errorCode, IPacket reply)> OnJoinStage(IActor actor, IPacket packet)
+    {
+        return Task.FromResult<(ushort, IPacket)>((0, new TestPacket("joined")));
+    }
+
+    public Task OnDispatch(IActor actor, IPacket packet)
+    {
+        Events.Enqueue(("dispatch", 1, TimeSpan.Zero));
+        return Task.CompletedTask;
+    }
+
+    public Task OnDisconnect(IActor actor)
+    {
+        return Task.CompletedTask;
+    }
+
+    public Task OnPostCreate()
+    {
+        return Task.CompletedTask;
+    }
+
+    public Task OnPostJoinStage(IActor actor)
+    {
+        return Task.CompletedTask;
+    }
+
+    public Task OnInputs(IReadOnlyList<StageInput> inputs)
+    {
+        Events.Enqueue(("inputs", inputs.Count, TimeSpan.Zero));
+        return Task.CompletedTask;
+    }
+
+    public Task OnTick(TimeSpan deltaTime)
+    {
+        Events.Enqueue(("tick", 0, deltaTime));
+        return Task.CompletedTask;
+    }
+}
+
+public class GameLoopTest : IDisposable
+{
+    private const long StageId = 7;
+    private const long AccountId = 100;
+    private const string StageType = "loop";
+
+    private readonly Mock<IClientCommunicator> _clientCommunicator = new();
+    private readonly PlayDispatcher _dispatcher;
+    private readonly List<(string endpoint, RoutePacket packet)> _sent = new();
+    private readonly BaseStage _stage;
+    private readonly XStageSender _stageSender;
+    private LoopStage? _loopStage;
+
+    public GameLoopTest()
+    {
+        var reqCache = new RequestCache(0);
+        var serverInfoCenter = Mock.Of<IServerInfoCenter>();
+        var playOption = new PlayOption();
+        playOption.PlayProducer.Register(StageType, sender => _loopStage = new LoopStage(sender),
+            _ => Mock.Of<IActor>());
+
+        _clientCommunicator.Setup(x => x.Send(It.IsAny<string>(), It.IsAny<RoutePacket>()))
+            .Callback<string, RoutePacket>((endpoint, packet) => _sent.Add((endpoint, packet)));
+
+        _dispatcher = new PlayDispatcher(2, _clientCommunicator.Object, reqCache, serverInfoCenter,
+            "tcp://127.0.0.1:8777", playOption);
+        _dispatcher.Start();
+
+        _stageSender = new XStageSender(2, StageId, _dispatcher, _clientCommunicator.Object, reqCache);
+        _stage = new BaseStage(StageId, _dispatcher, _clientCommunicator.Object, reqCache, serverInfoCenter,
+            Mock.Of<ISessionUpdater>(), _stageSender);
+
+        PacketProducer.Init((msgId, payload, msgSeq) => new TestPacket(msgId, payload, msgSeq));
+    }
+
+    public void Dispose()
+    {
+        _stage.OnDestroy();
+        _dispatcher.Stop();
+    }
+
+    [Fact]
+    public void Frame_sends_should_be_coalesced_per_session_server()
+    {
+        var samePacket = new TestPacket(new TestMsg { TestMsg_ = "state" });
+        var other = new TestPacket(new TestMsg { TestMsg_ = "other" });
+
+        _stageSender.BeginFrame();
+        _stageSender.SendToClient("session1", 1, samePacket);
+        _stageSender.SendToClient("session1", 2, samePacket);
+        _stageSender.SendToClient("session2", 3, samePacket);
+        _stageSender.SendToClient("session1", 1, other);
+        _sent.Should().BeEmpty();
+
+        _stageSender.EndFrame();
+
+        _sent.Select(s => s.endpoint).Should().Equal("session1", "session2", "session1");
+        _sent[0].packet.RouteHeader.Sids.Should().Equal(1, 2);
+        _sent[1].packet.RouteHeader.Sid.Should().Be(3);
+        _sent[2].packet.RouteHeader.Sid.Should().Be(1);
+        TestMsg.Parser.ParseFrom(_sent[2].packet.Span).TestMsg_.Should().Be("other");
+    }
+
+    [Fact]
+    public async Task Inputs_should_come_as_one_batch_before_tick()
+    {
+        await _stage.Create(StageType, new TestPacket("create"));
+        _sent.Clear();
+
+        var actorSender = new XActorSender(AccountId, "session1", 1, "api", _stage, Mock.Of<IServerInfoCenter>());
+        _stage.AddActor(new BaseActor(Mock.Of<IActor>(), actorSender));
+
+        await _stage.OnPostCreate();
+        SpinWait.SpinUntil(() => !_loopStage!.Events.IsEmpty, TimeSpan.FromSeconds(3));
+
+        for (var i = 0; i < 3; i++)
+        {
+            _stage.Post(RoutePacket.StageOf(StageId, AccountId,
+                RoutePacket.Of(new TestMsg { TestMsg_ = $"input{i}" }), false, true));
+        }
+
+        SpinWait.SpinUntil(() => _loopStage!.Events.Count(e => e.name == "tick") >= 10, TimeSpan.FromSeconds(3));
+
+        var events = _loopStage!.Events.ToArray();
+        events.Should().NotContain(e => e.name == "dispatch");
+
+        // they arrive at once on the next frame, right before the tick
+        var inputs = Array.FindIndex(events, e => e.name == "inputs");
+        inputs.Should().BePositive();
+        events[inputs].inputs.Should().Be(3);
+        events[inputs + 1].name.Should().Be("tick");
+
+        var ticks = events.Where(e => e.name == "tick").Skip(1).Select(e => e.delta.TotalMilliseconds).ToArray();
+        ticks.Should().NotBeEmpty();
+        ticks.Average().Should().BeInRange(10, 40);
+    }
+
+    [Fact]
+    public void Queued_inputs_should_be_disposed_on_release()
+    {
+        var loop = new StageGameLoop(_stage, new LoopStage(_stageSender), _stageSender);
+        var queued = new Mock<IPacket>();
+        loop.AddInput(Mock.Of<IActor>(), queued.Object);
+
+        loop.Release();
+        queued.Verify(p => p.Dispose(), Times.Once);
+
+        // inputs arriving after stop are dropped right away
+        var late = new Mock<IPacket>();
+        loop.AddInput(Mock.Of<IActor>(), late.Object);
+        late.Verify(p => p.Dispose(), Times.Once);
+    }
+}
\ No newline at end of file
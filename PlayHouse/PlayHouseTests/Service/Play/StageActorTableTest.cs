@@ -0,0 +1,80 @@
+﻿using FluentAssertions;
+using Moq;
+using PlayHouse.Communicator;
+using PlayHouse.Production.Play;
+using PlayHouse.Service.Play;
+using PlayHouse.Service.Play.Base;
+using PlayHouse.Service.Shared;
+using Xunit;
+
+namespace PlayHouseTests.Service.Play;
+
+public class StageActorTableTest : IDisposable
+{
+    private const long AccountId = 100;
+
+    private readonly IClientCommunicator _clientCommunicator = Mock.Of<IClientCommunicator>();
+    private readonly PlayDispatcher _dispatcher;
+    private readonly RequestCache _reqCache = new(0);
+    private readonly IServerInfoCenter _serverInfoCenter = Mock.Of<IServerInfoCenter>();
+
+    public StageActorTableTest()
+    {
+        _dispatcher = new PlayDispatcher(2, _clientCommunicator, _reqCache, _serverInfoCenter,
+            "tcp://127.0.0.1:8777", new PlayOption());
+        _dispatcher.Start();
+    }
+
+    public void Dispose()
+    {
+        _dispatcher.Stop();
+    }
+
+    private BaseStage MakeStage(long stageId)
+    {
+        var stageSender = new XStageSender(2, stageId, _dispatcher, _clientCommunicator, _reqCache);
+        return new BaseStage(stageId, _dispatcher, _clientCommunicator, _reqCache, _serverInfoCenter,
+            Mock.Of<ISessionUpdater>(), stageSender);
+    }
+
+    private BaseActor MakeActor(BaseStage stage)
+    {
+        var actorSender = new XActorSender(AccountId, "session", 1, "api", stage, _serverInfoCenter);
+        return new BaseActor(Mock.Of<IActor>(), actorSender);
+    }
+
+    [Fact]
+    public void Account_should_be_actor_of_several_stages()
+    {
+        var lobby = MakeStage(1);
+        var match = MakeStage(2);
+
+        var lobbyActor = MakeActor(lobby);
+        var matchActor = MakeActor(match);
+        lobby.AddActor(lobbyActor);
+        match.AddActor(matchActor);
+
+        lobby.FindActor(AccountId).Should().BeSameAs(lobbyActor);
+        match.FindActor(AccountId).Should().BeSameAs(matchActor);
+        _dispatcher.StagesOf(AccountId).Should().BeEquivalentTo(new long[] { 1, 2 });
+        _dispatcher.GetActorCount().Should().Be(1);
+    }
+
+    [Fact]
+    public void Destroyed_stage_should_leave_account_index()
+    {
+        var lobby = MakeStage(1);
+        var match = MakeStage(2);
+        lobby.AddActor(MakeActor(lobby));
+        match.AddActor(MakeActor(match));
+
+        match.OnDestroy();
+
+        SpinWait.SpinUntil(() => _dispatcher.StagesOf(AccountId).Length == 1, TimeSpan.FromSeconds(3));
+        _dispatcher.StagesOf(AccountId).Should().Equal(1);
+        match.FindActor(AccountId).Should().BeNull();
+
+        _dispatcher.RemoveActorStage(AccountId, 1);
+        _dispatcher.GetActorCount().Should().Be(0);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+﻿using System.Collections.Concurrent;
+using FluentAssertions;
+using Moq;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Play;
+using PlayHouse.Service.Play;
+using PlayHouse.Service.Play.Base;
+using PlayHouse.Service.Shared;
+using Xunit;
+
+namespace PlayHouseTests.Service.Play;
+
+public class StageContextTest : IDisposable
+{
+    private const long StageId = 1;
+
+    private readonly Mock<IClientCommunicator> _clientCommunicator = new();
+    private readonly PlayDispatcher _dispatcher;
+    private readonly ConcurrentQueue<RoutePacket> _replies = new();
+    private readonly BaseStage _stage;
+    private readonly XStageSender _stageSender;
+
+    public StageContextTest()
+    {
+        var reqCache = new RequestCache(0);
+        var serverInfoCenter = Mock.Of<IServerInfoCenter>();
+
+        _clientCommunicator.Setup(x => x.Send(It.IsAny<string>(), It.IsAny<RoutePacket>()))
+            .Callback<string, RoutePacket>((_, packet) => _replies.Enqueue(packet));
+
+        _dispatcher = new PlayDispatcher(2, _clientCommunicator.Object, reqCache, serverInfoCenter,
+            "tcp://127.0.0.1:8777", new PlayOption());
+        _dispatcher.Start();
+
+        _stageSender = new XStageSender(2, StageId, _dispatcher, _clientCommunicator.Object, reqCache);
+        _stage = new BaseStage(StageId, _dispatcher, _clientCommunicator.Object, reqCache, serverInfoCenter,
+            Mock.Of<ISessionUpdater>(), _stageSender, useStageContext: true);
+    }
+
+    public void Dispose()
+    {
+        _dispatcher.Stop();
+    }
+
+    private RoutePacket BlockPacket(ushort msgSeq, AsyncPostCallback callback)
+    {
+        var packet = AsyncBlockPacket.Of(StageId, callback, 0);
+        packet.RouteHeader.Header.MsgSeq = msgSeq;
+        packet.RouteHeader.From = "tcp://127.0.0.1:5555";
+        return packet;
+    }
+
+    [Fact]
+    public void Awaiting_handler_should_not_block_next_packet()
+    {
+        var gate = new TaskCompletionSource();
+        var order = new ConcurrentQueue<string>();
+        var running = 0;
+        var overlapped = false;
+
+        void Enter()
+        {
+            if (Interlocked.Increment(ref running) != 1)
+            {
+                overlapped = true;
+            }
+        }
+
+        void Exit()
+        {
+            Interlocked.Decrement(ref running);
+        }
+
+        _stage.Post(BlockPacket(1, async _ =>
+        {
+            Enter();
+            order.Enqueue("first-start");
+            Exit();
+
+            await gate.Task;
+
+            Enter();
+            order.Enqueue("first-end");
+            _stageSender.Reply(10);
+            Exit();
+        }));
+
+        _stage.Post(BlockPacket(2, _ =>
+        {
+            Enter();
+            order.Enqueue("second");
+            _stageSender.Reply(20);
+            Exit();
+            return Task.CompletedTask;
+        }));
+
+        SpinWait.SpinUntil(() => order.Count == 2, TimeSpan.FromSeconds(3));
+        order.Should().Equal("first-start", "second");
+
+        gate.SetResult();
+
+        SpinWait.SpinUntil(() => _replies.Count == 2, TimeSpan.FromSeconds(3));
+        order.Should().Equal("first-start", "second", "first-end");
+        overlapped.Should().BeFalse();
+
+        // a reply after an await still goes out with its own request's header
+        var replies = _replies.ToArray();
+        replies[0].MsgSeq.Should().Be(2);
+        replies[0].ErrorCode.Should().Be(20);
+        replies[1].MsgSeq.Should().Be(1);
+        replies[1].ErrorCode.Should().Be(10);
+    }
+
+    [Fact]
+    public void Continuation_should_resume_on_stage_context()
+    {
+        SynchronizationContext? before = null;
+        SynchronizationContext? after = null;
+        var done = new ManualResetEventSlim(false);
+
+        _stage.Post(BlockPacket(0, async _ =>
+        {
+            before = SynchronizationContext.Current;
+            await Task.Delay(10);
+            after = SynchronizationContext.Current;
+            done.Set();
+        }));
+
+        done.Wait(TimeSpan.FromSeconds(3)).Should().BeTrue();
+        before.Should().BeOfType<StageSynchronizationContext>();
+        after.Should().BeSameAs(before);
+    }
+}
\ No newline at end of file
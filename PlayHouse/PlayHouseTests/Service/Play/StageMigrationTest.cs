@@ -0,0 +1,340 @@
+﻿using FluentAssertions;
+using Moq;
+using Org.Ulalax.Playhouse.Protocol;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Play;
+using PlayHouse.Production.Shared;
+using Playhouse.Protocol;
+using PlayHouse.Service.Play;
+using PlayHouse.Service.Shared;
+using Xunit;
+
+namespace PlayHouseTests.Service.Play;
+
+public class StageMigrationTest : IDisposable
+{
+    private const string SourceEndpoint = "tcp://127.0.0.1:8777";
+    private const string TargetEndpoint = "tcp://127.0.0.1:8778";
+    private const string SessionEndpoint = "tcp://127.0.0.1:5555";
+    private const string StageType = "match";
+    private const string PlainStageType = "lobby";
+    private const long StageId = 10;
+    private const long AccountId = 100;
+
+    private readonly PlayDispatcher _source;
+    private readonly RequestCache _sourceCache = new(0);
+    private readonly List<CounterStage> _sourceStages = new();
+    private readonly PlayDispatcher _target;
+    private readonly RequestCache _targetCache = new(0);
+    private readonly List<CounterStage> _targetStages = new();
+    private readonly IServerInfoCenter _serverInfoCenter = Mock.Of<IServerInfoCenter>();
+
+    // the target's reply reaches the source as a timeout
+    private bool _timeoutReplies;
+    private int _targetSessionUpdates;
+
+    public StageMigrationTest()
+    {
+        PacketProducer.Init((msgId, payload, msgSeq) => new TestPacket(msgId, payload, msgSeq));
+        Mock.Get(_serverInfoCenter).Setup(e => e.GetServerList()).Returns(new List<XServerInfo>());
+
+        // packets from source to target go straight to the target dispatcher, replies to the source request cache
+        var sourceCommunicator = new Mock<IClientCommunicator>();
+        sourceCommunicator.Setup(e => e.Send(It.IsAny<string>(), It.IsAny<RoutePacket>()))
+            .Callback<string, RoutePacket>((endpoint, packet) =>
+            {
+                if (endpoint == TargetEndpoint)
+                {
+                    packet.RouteHeader.From = SourceEndpoint;
+                    Task.Run(() => _target!.OnPost(packet));
+                }
+                else
+                {
+                    ReplyFromSession(_sourceCache, packet);
+                }
+            });
+
+        var targetCommunicator = new Mock<IClientCommunicator>();
+        targetCommunicator.Setup(e => e.Send(It.IsAny<string>(), It.IsAny<RoutePacket>()))
+            .Callback<string, RoutePacket>((endpoint, packet) =>
+            {
+                if (endpoint == SourceEndpoint)
+                {
+                    if (_timeoutReplies)
+                    {
+                        packet.RouteHeader.Header.ErrorCode = (ushort)BaseErrorCode.RequestTimeout;
+                    }
+
+                    Task.Run(() => _sourceCache.OnReply(packet));
+                }
+                else
+                {
+                    if (packet.MsgId == JoinStageInfoUpdateReq.Descriptor.Name)
+                    {
+                        Interlocked.Increment(ref _targetSessionUpdates);
+                    }
+
+                    ReplyFromSession(_targetCache, packet);
+                }
+            });
+
+        _source = new PlayDispatcher(2, sourceCommunicator.Object, _sourceCache, _serverInfoCenter, SourceEndpoint,
+            MakeOption(_sourceStages));
+        _target = new PlayDispatcher(2, targetCommunicator.Object, _targetCache, _serverInfoCenter, TargetEndpoint,
+            MakeOption(_targetStages));
+        _source.Start();
+        _target.Start();
+    }
+
+    public void Dispose()
+    {
+        _source.Stop();
+        _target.Stop();
+    }
+
+    private static PlayOption MakeOption(List<CounterStage> stages)
+    {
+        var playOption = new PlayOption();
+        playOption.PlayProducer.Register(StageType, stageSender =>
+        {
+            var stage = new CounterStage(stageSender);
+            lock (stages)
+            {
+                stages.Add(stage);
+            }
+
+            return stage;
+        }, MakeActor);
+        playOption.PlayProducer.Register(PlainStageType, stageSender => new PlainStage(stageSender), MakeActor);
+        return playOption;
+    }
+
+    private static IActor MakeActor(IActorSender actorSender)
+    {
+        return Mock.Of<IActor>(e => e.ActorSender == actorSender);
+    }
+
+    private static void ReplyFromSession(RequestCache cache, RoutePacket packet)
+    {
+        if (packet.MsgId != JoinStageInfoUpdateReq.Descriptor.Name)
+        {
+            return;
+        }
+
+        var reply = RoutePacket.ReplyOf(2, packet.RouteHeader, 0, CPacket.Of(new JoinStageInfoUpdateRes()));
+        Task.Run(() => cache.OnReply(reply));
+    }
+
+    private static RoutePacket CreateJoinPacket(string stageType)
+    {
+        var request = new CreateJoinStageReq
+        {
+            StageType = stageType,
+            CreatePayloadId = TestMsg.Descriptor.Name,
+            JoinPayloadId = TestMsg.Descriptor.Name,
+            SessionEndpoint = SessionEndpoint,
+            Sid = 1
+        };
+
+        var packet = RoutePacket.StageOf(StageId, AccountId, RoutePacket.Of(request), true, true);
+        packet.SetMsgSeq(1);
+        return packet;
+    }
+
+    private static async Task WaitUntil(Func<bool> condition)
+    {
+        for (var i = 0; i < 100 && !condition(); i++)
+        {
+            await Task.Delay(20);
+        }
+
+        condition().Should().BeTrue();
+    }
+
+    private async Task CreateStage(string stageType = StageType)
+    {
+        _source.OnPost(CreateJoinPacket(stageType));
+        await WaitUntil(() => _source.StagesOf(AccountId).Length == 1);
+    }
+
+    [Fact]
+    public async Task Migrate_ShouldRestoreStateActorsAndTimersOnTarget()
+    {
+        await CreateStage();
+        _sourceStages[0].Counter = 7;
+
+        var errorCode = await _source.MigrateStage(StageId, TargetEndpoint);
+
+        errorCode.Should().Be((ushort)BaseErrorCode.Success);
+        _source.FindRoom(StageId)!.IsMoved.Should().BeTrue();
+        _source.StagesOf(AccountId).Should().BeEmpty();
+        _target.StagesOf(AccountId).Should().BeEquivalentTo(new[] { StageId });
+
+        var restored = _targetStages.Single();
+        restored.Counter.Should().Be(7);
+        restored.RestoredActors!.Select(e => e.ActorSender.AccountId()).Should().Equal(AccountId);
+
+        var timer = restored.RestoredTimers!.Single();
+        timer.IsRepeat.Should().BeTrue();
+        timer.Period.Should().Be(TimeSpan.FromSeconds(10));
+        timer.RemainingDelay.Should().BeLessOrEqualTo(TimeSpan.FromSeconds(10));
+    }
+
+    [Fact]
+    public async Task MovedStage_ShouldForwardPacketsToTarget()
+    {
+        await CreateStage();
+        (await _source.MigrateStage(StageId, TargetEndpoint)).Should().Be((ushort)BaseErrorCode.Success);
+
+        _source.OnPost(RoutePacket.StageOf(StageId, AccountId, RoutePacket.Of(new TestMsg { TestMsg_ = "hit" }),
+            false, false));
+
+        await WaitUntil(() => _targetStages.Single().Counter == 1);
+        _sourceStages.Single().Counter.Should().Be(0);
+    }
+
+    [Fact]
+    public async Task CommittedStage_ShouldUpdateSessions()
+    {
+        await CreateStage();
+        (await _source.MigrateStage(StageId, TargetEndpoint)).Should().Be((ushort)BaseErrorCode.Success);
+
+        await WaitUntil(() => Volatile.Read(ref _targetSessionUpdates) == 1);
+    }
+
+    [Fact]
+    public async Task TimedOutMigration_ShouldAbortPreparedStageOnTarget()
+    {
+        await CreateStage();
+        _timeoutReplies = true;
+
+        var errorCode = await _source.MigrateStage(StageId, TargetEndpoint);
+
+        errorCode.Should().Be((ushort)BaseErrorCode.RequestTimeout);
+        _source.FindRoom(StageId)!.IsMoved.Should().BeFalse();
+        _source.StagesOf(AccountId).Should().BeEquivalentTo(new[] { StageId });
+
+        // the target gets the abort and drops the prepared stage, sessions are not switched
+        await WaitUntil(() => _target.FindRoom(StageId) == null);
+        _target.StagesOf(AccountId).Should().BeEmpty();
+        _targetSessionUpdates.Should().Be(0);
+
+        _source.OnPost(RoutePacket.StageOf(StageId, AccountId, RoutePacket.Of(new TestMsg()), false, false));
+        await WaitUntil(() => _sourceStages.Single().Counter == 1);
+    }
+
+    [Fact]
+    public async Task MigrateAgain_ShouldBeRejected()
+    {
+        await CreateStage();
+        (await _source.MigrateStage(StageId, TargetEndpoint)).Should().Be((ushort)BaseErrorCode.Success);
+
+        (await _source.MigrateStage(StageId, TargetEndpoint)).Should().Be((ushort)BaseErrorCode.StageIsNotExist);
+    }
+
+    [Fact]
+    public async Task NotMigratableStage_ShouldStayOnSource()
+    {
+        await CreateStage(PlainStageType);
+
+        var errorCode = await _source.MigrateStage(StageId, TargetEndpoint);
+
+        errorCode.Should().Be((ushort)BaseErrorCode.StageIsNotMigratable);
+        _source.FindRoom(StageId)!.IsMoved.Should().BeFalse();
+        _source.StagesOf(AccountId).Should().BeEquivalentTo(new[] { StageId });
+    }
+
+    [Fact]
+    public async Task WithoutTarget_ShouldFailAndKeepProcessing()
+    {
+        await CreateStage();
+
+        var errorCode = await _source.MigrateStage(StageId);
+
+        errorCode.Should().Be((ushort)BaseErrorCode.MigrationTargetIsNotExist);
+        _source.OnPost(RoutePacket.StageOf(StageId, AccountId, RoutePacket.Of(new TestMsg()), false, false));
+        await WaitUntil(() => _sourceStages.Single().Counter == 1);
+    }
+
+    [Fact]
+    public void TimerSnapshot_ShouldKeepRemainingCount()
+    {
+        var stageSender = new XStageSender(2, StageId, _source, Mock.Of<IClientCommunicator>(), _sourceCache);
+        var countTimer = stageSender.AddCountTimer(TimeSpan.FromSeconds(1), 3, TimeSpan.FromSeconds(1),
+            () => Task.CompletedTask);
+        var canceled = stageSender.AddRepeatTimer(TimeSpan.FromSeconds(1), TimeSpan.FromSeconds(1),
+            () => Task.CompletedTask);
+        stageSender.CancelTimer(canceled);
+
+        stageSender.OnTimerFired(countTimer);
+        stageSender.OnTimerFired(countTimer);
+
+        var timer = stageSender.SnapshotTimers().Single();
+        timer.TimerId.Should().Be(countTimer);
+        timer.Type.Should().Be(TimerMsg.Types.Type.Count);
+        timer.Count.Should().Be(1);
+
+        stageSender.OnTimerFired(countTimer);
+        stageSender.HasTimer(countTimer).Should().BeFalse();
+        stageSender.SnapshotTimers().Should().BeEmpty();
+    }
+
+    private class PlainStage(IStageSender stageSender) : IStage
+    {
+        public int Counter { get; set; }
+
+        public IStageSender StageSender { get; } = stageSender;
+
+        public Task<(ushort errorCode, IPacket reply)> OnCreate(IPacket packet)
+        {
+            return Task.FromResult(((ushort)0, CPacket.Of(new TestMsg())));
+        }
+
+        public Task<(ushort errorCode, IPacket reply)> OnJoinStage(IActor actor, IPacket packet)
+        {
+            return Task.FromResult(((ushort)0, CPacket.Of(new TestMsg())));
+        }
+
+        public Task OnDispatch(IActor actor, IPacket packet)
+        {
+            Counter++;
+            return Task.CompletedTask;
+        }
+
+        public Task OnDisconnect(IActor actor)
+        {
+            return Task.CompletedTask;
+        }
+
+        public Task OnPostCreate()
+        {
+            StageSender.AddRepeatTimer(TimeSpan.FromSeconds(10), TimeSpan.FromSeconds(10), () => Task.CompletedTask);
+            return Task.CompletedTask;
+        }
+
+        public Task OnPostJoinStage(IActor actor)
+        {
+            return Task.CompletedTask;
+        }
+    }
+
+    private class CounterStage(IStageSender stageSender) : PlainStage(stageSender), IMigratableStage
+    {
+        public IReadOnlyList<IActor>? RestoredActors { get; private set; }
+        public IReadOnlyList<MigratedTimer>? RestoredTimers { get; private set; }
+
+        public Task<byte[]> OnSnapshot()
+        {
+            return Task.FromResult(BitConverter.GetBytes(Counter));
+        }
+
+        public Task OnRestore(byte[] snapshot, IReadOnlyList<IActor> actors, IReadOnlyList<MigratedTimer> timers)
+        {
+            Counter = BitConverter.ToInt32(snapshot);
+            RestoredActors = actors;
+            RestoredTimers = timers;
+            return Task.CompletedTask;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+﻿using System.Collections.Concurrent;
+using FluentAssertions;
+using PlayHouse.Service.Play.Base;
+using Xunit;
+
+namespace PlayHouseTests.Service.Play;
+
+public class StageSchedulerTest
+{
+    [Fact]
+    public void WorkerScheduler_Should_Run_Every_Scheduled_Drain()
+    {
+        var scheduler = new WorkerStageScheduler(4, 0);
+        scheduler.Start();
+
+        var executed = new ConcurrentBag<long>();
+        using var countdown = new CountdownEvent(100);
+
+        for (long stageId = 0; stageId < 100; stageId++)
+        {
+            var id = stageId;
+            scheduler.Schedule(id, () =>
+            {
+                executed.Add(id);
+                countdown.Signal();
+                return Task.CompletedTask;
+            });
+        }
+
+        countdown.Wait(TimeSpan.FromSeconds(5)).Should().BeTrue();
+        executed.Should().HaveCount(100).And.OnlyHaveUniqueItems();
+
+        scheduler.Stop();
+    }
+
+    [Fact]
+    public void WorkerScheduler_Should_Keep_Order_Of_A_Stage()
+    {
+        var scheduler = new WorkerStageScheduler(1, 0);
+        scheduler.Start();
+
+        var executed = new ConcurrentQueue<int>();
+        using var countdown = new CountdownEvent(10);
+
+        for (var i = 0; i < 10; i++)
+        {
+            var seq = i;
+            scheduler.Schedule(1, () =>
+            {
+                executed.Enqueue(seq);
+                countdown.Signal();
+                return Task.CompletedTask;
+            });
+        }
+
+        countdown.Wait(TimeSpan.FromSeconds(5)).Should().BeTrue();
+        executed.Should().BeInAscendingOrder();
+
+        scheduler.Stop();
+    }
+
+    [Fact]
+    public async Task WorkerScheduler_Should_Resume_On_The_Worker_After_Await()
+    {
+        var scheduler = new WorkerStageScheduler(2, 0);
+        scheduler.Start();
+
+        var threads = new TaskCompletionSource<(int before, int after, string? name)>();
+        scheduler.Schedule(1, async () =>
+        {
+            var before = Environment.CurrentManagedThreadId;
+            await Task.Delay(10);
+            await Task.Yield();
+            threads.SetResult((before, Environment.CurrentManagedThreadId, Thread.CurrentThread.Name));
+        });
+
+        var (before, after, name) = await threads.Task.WaitAsync(TimeSpan.FromSeconds(5));
+        after.Should().Be(before);
+        name.Should().StartWith("StageWorker-");
+
+        scheduler.Stop();
+    }
+
+    [Fact]
+    public void WorkerScheduler_Should_Wake_An_Idle_Peer_When_The_Home_Worker_Is_Backed_Up()
+    {
+        var scheduler = new WorkerStageScheduler(2, 0);
+        scheduler.Start();
+
+        using var started = new ManualResetEventSlim(false);
+        using var gate = new ManualResetEventSlim(false);
+        scheduler.Schedule(0, () =>
+        {
+            started.Set();
+            gate.Wait(TimeSpan.FromSeconds(5));
+            return Task.CompletedTask;
+        });
+        started.Wait(TimeSpan.FromSeconds(5)).Should().BeTrue();
+
+        // the home worker is blocked, so the backlog can only run on the peer
+        using var countdown = new CountdownEvent(2);
+        for (var i = 0; i < 2; i++)
+        {
+            scheduler.Schedule(0, () =>
+            {
+                countdown.Signal();
+                return Task.CompletedTask;
+            });
+        }
+
+        countdown.Wait(TimeSpan.FromSeconds(5)).Should().BeTrue();
+
+        gate.Set();
+        scheduler.Stop();
+    }
+
+    [Fact]
+    public async Task WorkerScheduler_Should_Release_Drains_After_Stop()
+    {
+        var scheduler = new WorkerStageScheduler(1, 0);
+        scheduler.Start();
+
+        var resumed = new TaskCompletionSource();
+        var gate = new TaskCompletionSource();
+        scheduler.Schedule(1, async () =>
+        {
+            await gate.Task;
+            resumed.SetResult();
+        });
+
+        scheduler.Stop();
+        gate.SetResult();
+
+        var scheduled = new TaskCompletionSource();
+        scheduler.Schedule(1, () =>
+        {
+            scheduled.SetResult();
+            return Task.CompletedTask;
+        });
+
+        await resumed.Task.WaitAsync(TimeSpan.FromSeconds(5));
+        await scheduled.Task.WaitAsync(TimeSpan.FromSeconds(5));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+﻿using FluentAssertions;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Service.Session.Network;
+using Xunit;
+
+namespace PlayHouseTests.Service.Session;
+
+public class FrameCompressionTest
+{
+    private static byte[] Frame(byte[] body, bool hasErrorCode)
+    {
+        var frame = new byte[PacketFrame.ReplyHeaderSize + 16 + body.Length];
+        var headerSize = PacketFrame.WriteHeader(frame, body.Length, 1, "Inventory", 0, 3, 77,
+            hasErrorCode ? (ushort)0 : null);
+        body.CopyTo(frame, headerSize);
+        return frame[..(headerSize + body.Length)];
+    }
+
+    private static byte[] Compressible(int size)
+    {
+        return Enumerable.Range(0, size).Select(i => (byte)(i % 16)).ToArray();
+    }
+
+    [Fact]
+    public void CompressedFrame_ShouldBeParsedBackToTheOriginalBody()
+    {
+        var body = Compressible(64 * 1024);
+        var frame = Frame(body, false);
+
+        var compressed = FrameCompression.CompressFrame(frame, 1024, out var size);
+
+        compressed.Should().NotBeNull();
+        size.Should().BeLessThan(frame.Length / 10);
+        PacketFrame.IsCompressed(compressed!).Should().BeTrue();
+
+        var packets = new List<ClientPacket>();
+        new PacketParser().Parse(compressed!.AsSpan(0, size), packets.Add);
+
+        packets.Should().HaveCount(1);
+        packets[0].MsgId.Should().Be("Inventory");
+        packets[0].MsgSeq.Should().Be(3);
+        packets[0].Header.StageId.Should().Be(77);
+        packets[0].Span.ToArray().Should().Equal(body);
+    }
+
+    [Fact]
+    public void CompressedFrame_ShouldBeParsedAcrossReceives()
+    {
+        var body = Compressible(8 * 1024);
+        var compressed = FrameCompression.CompressFrame(Frame(body, false), 1024, out var size)!;
+
+        var parser = new PacketParser();
+        var packets = new List<ClientPacket>();
+        parser.Parse(compressed.AsSpan(0, 5), packets.Add);
+        parser.Parse(compressed.AsSpan(5, size - 5), packets.Add);
+
+        packets.Should().ContainSingle().Which.Span.ToArray().Should().Equal(body);
+    }
+
+    [Fact]
+    public void CompressFrame_ShouldSkipSmallOrIncompressibleBody()
+    {
+        FrameCompression.CompressFrame(Frame(Compressible(100), true), 1024, out _).Should().BeNull();
+
+        var random = new byte[4096];
+        new Random(1).NextBytes(random);
+        FrameCompression.CompressFrame(Frame(random, true), 1024, out _).Should().BeNull();
+    }
+
+    [Fact]
+    public void BrokenCompressedBody_ShouldThrow()
+    {
+        var compressed = FrameCompression.CompressFrame(Frame(Compressible(8 * 1024), false), 1024, out var size)!;
+        compressed.AsSpan(size - 8, 8).Fill(0xFF);
+
+        var parse = () => new PacketParser().Parse(compressed.AsSpan(0, size), _ => { });
+
+        parse.Should().Throw<Exception>();
+    }
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 ﻿using CommonLib;
 using FluentAssertions;
+using PlayHouse.Communicator.Message;
 using PlayHouse.Service.Session.Network;
+using PlayHouse.Utils;
 using Xunit;
 
 namespace PlayHouseTests.Service.Session;
@@ -193,4 +195,79 @@ public class PacketParserTests
 
         
     }
-}
+
+    [Fact]
+    public void Parse_Span_SplitFrames_ShouldCarryPartialFrame()
+    {
+        var buffer = new PooledByteBuffer(1024);
+        var msgId = "12345";
+        var body = new byte[] { 1, 2, 3, 4, 5 };
+        for (int i = 0; i < 3; i++)
+        {
+            buffer.WriteInt32(body.Length);
+            buffer.WriteInt16(1);
+            buffer.Write(msgId);
+            buffer.WriteInt16((ushort)(i + 1));
+            buffer.WriteInt64(67890L);
+            buffer.Write(body);
+        }
+
+        var bytes = buffer.Buffer().AsSpan(0, buffer.Count).ToArray();
+        var packets = new List<ClientPacket>();
+
+        // receiving one byte at a time gives the same result whatever the frame boundaries
+        for (int i = 0; i < bytes.Length; i++)
+        {
+            _parser.Parse(bytes.AsSpan(i, 1), packets.Add);
+        }
+
+        packets.Should().HaveCount(3);
+        for (int i = 0; i < packets.Count; i++)
+        {
+            packets[i].Header.MsgId.Should().Be(msgId);
+            packets[i].Header.MsgSeq.Should().Be((ushort)(i + 1));
+            packets[i].Header.StageId.Should().Be(67890L);
+            packets[i].Payload.Data.ToArray().Should().Equal(body);
+        }
+    }
+
+    [Fact]
+    public void Parse_Span_NumericMsgId_ShouldResolveRegisteredName()
+    {
+        var msgNum = MsgIdRegistry.Register("PacketParserNumericMsg");
+        var buffer = new PooledByteBuffer(1024);
+        buffer.WriteInt32(0);
+        buffer.WriteInt16(1);
+        buffer.Write((byte)0);
+        buffer.WriteInt32(msgNum);
+        buffer.WriteInt16(1);
+        buffer.WriteInt64(0);
+
+        var packets = new List<ClientPacket>();
+        _parser.Parse(buffer.Buffer().AsSpan(0, buffer.Count), packets.Add);
+
+        packets.Should().HaveCount(1);
+        packets[0].Header.MsgId.Should().BeSameAs(MsgIdRegistry.NameOf(msgNum));
+        packets[0].Payload.Data.Length.Should().Be(0);
+    }
+
+    [Fact]
+    public void Parse_Span_UnknownNumericMsgId_ShouldKeepTheId()
+    {
+        var msgNum = MsgIdRegistry.IdOf("PacketParserUnknownMsg");
+        var buffer = new PooledByteBuffer(1024);
+        buffer.WriteInt32(0);
+        buffer.WriteInt16(1);
+        buffer.Write((byte)0);
+        buffer.WriteInt32(msgNum);
+        buffer.WriteInt16(1);
+        buffer.WriteInt64(0);
+
+        var packets = new List<ClientPacket>();
+        _parser.Parse(buffer.Buffer().AsSpan(0, buffer.Count), packets.Add);
+
+        packets.Should().HaveCount(1);
+        packets[0].Header.MsgId.Should().BeEmpty();
+        packets[0].Header.MsgNum.Should().Be(msgNum);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+﻿using System.Collections.Concurrent;
+using CommonLib;
+using FluentAssertions;
+using Google.Protobuf;
+using Moq;
+using Org.Ulalax.Playhouse.Protocol;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Production.Session;
+using PlayHouse.Service.Session;
+using PlayHouse.Service.Session.Network;
+using PlayHouse.Service.Shared;
+using Xunit;
+
+namespace PlayHouseTests.Service.Session;
+
+// clears the buffer on Dispose to mimic a buffer returned to the pool
+internal class RecycledPayload(byte[] data) : IPayload
+{
+    public ReadOnlyMemory<byte> Data => data;
+
+    public void Dispose()
+    {
+        Array.Clear(data);
+    }
+}
+
+public class SessionBroadcastTest
+{
+    public SessionBroadcastTest()
+    {
+        PooledBuffer.Init();
+    }
+
+    [Fact]
+    public async Task BroadcastBody_ShouldSurvive_SourcePacketDispose()
+    {
+        var dispatcher = new SessionDispatcher(1, new SessionOption { SessionPort = IpFinder.FindFreePort() },
+            new XServerInfoCenter(), Mock.Of<IClientCommunicator>(), new RequestCache(0));
+
+        var received = new ConcurrentDictionary<long, byte[]>();
+        var sids = new long[] { 1, 2, 3 };
+        foreach (var sid in sids)
+        {
+            var session = new Mock<ISession>();
+            session.Setup(s => s.Send(It.IsAny<ClientPacket>()))
+                .Callback<ClientPacket>(packet => received[sid] = packet.Span.ToArray());
+            dispatcher.OnConnect(sid, session.Object);
+        }
+
+        var body = new TestMsg { TestMsg_ = "broadcast" }.ToByteArray();
+        var packet = XPacket.Of(new TestMsg());
+        var broadcast = RoutePacket.ClientOf(2, sids, packet, new RecycledPayload(body.ToArray()), 100);
+
+        // the original is already disposed once OnPost returns
+        dispatcher.OnPost(broadcast);
+
+        for (var i = 0; i < 100 && received.Count < sids.Length; i++)
+        {
+            await Task.Delay(10);
+        }
+
+        received.Keys.Should().BeEquivalentTo(sids);
+        foreach (var data in received.Values)
+        {
+            TestMsg.Parser.ParseFrom(data).TestMsg_.Should().Be("broadcast");
+        }
+
+        dispatcher.Stop();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+﻿using CommonLib;
+using FluentAssertions;
+using Moq;
+using PlayHouse.Communicator;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Service.Session;
+using PlayHouse.Service.Session.Network;
+using Xunit;
+
+namespace PlayHouseTests.Service.Session;
+
+public class SessionIdleTrackerTest
+{
+    private readonly List<SessionActor> _timedOut = new();
+
+    public SessionIdleTrackerTest()
+    {
+        PooledBuffer.Init();
+    }
+
+    private static SessionActor ActorOf(long sid)
+    {
+        return new SessionActor(1, sid, new XServerInfoCenter(), Mock.Of<ISession>(), Mock.Of<IClientCommunicator>(),
+            new List<string>(), new RequestCache(0));
+    }
+
+    private SessionIdleTracker TrackerOf(int idleTimeoutMs, int heartBeatTimeoutMs, long nowMs)
+    {
+        return new SessionIdleTracker(idleTimeoutMs, heartBeatTimeoutMs, _timedOut.Add, nowMs);
+    }
+
+    [Fact]
+    public void Session_ShouldTimeout_OnlyAfterHeartBeatTimeout()
+    {
+        var now = Environment.TickCount64;
+        var tracker = TrackerOf(0, 1000, now);
+        var actor = ActorOf(1);
+        tracker.Track(actor);
+
+        tracker.Advance(now);
+        tracker.Advance(now + 500);
+        _timedOut.Should().BeEmpty();
+
+        tracker.Advance(now + 1200);
+        _timedOut.Should().Equal(actor);
+        tracker.Count.Should().Be(0);
+
+        tracker.Advance(now + 5000);
+        _timedOut.Should().HaveCount(1);
+    }
+
+    [Fact]
+    public void ReceivedPacket_ShouldPushTheDeadlineBack()
+    {
+        var now = Environment.TickCount64;
+        var tracker = TrackerOf(0, 300, now);
+        var actor = ActorOf(1);
+        tracker.Track(actor);
+        tracker.Advance(now);
+
+        Thread.Sleep(200);
+        actor.Dispatch(new ClientPacket(new Header(msgId: PacketConst.HeartBeat), new EmptyPayload()));
+        var received = actor.LastReceivedMs;
+
+        tracker.Advance(now + 350);
+        _timedOut.Should().BeEmpty();
+
+        tracker.Advance(received + 400);
+        _timedOut.Should().Equal(actor);
+    }
+
+    [Fact]
+    public void UnauthenticatedSession_ShouldNotBeIdleDisconnected()
+    {
+        var now = Environment.TickCount64;
+        var tracker = TrackerOf(1000, 0, now);
+        tracker.Track(ActorOf(1));
+
+        tracker.Advance(now + 10000);
+
+        _timedOut.Should().BeEmpty();
+        tracker.Count.Should().Be(1);
+    }
+
+    [Fact]
+    public void ClosedSession_ShouldBeDroppedWithoutTimeout()
+    {
+        var now = Environment.TickCount64;
+        var tracker = TrackerOf(0, 1000, now);
+        var actor = ActorOf(1);
+        tracker.Track(actor);
+        tracker.Track(ActorOf(2));
+        tracker.Advance(now);
+
+        actor.Disconnect();
+        tracker.Advance(now + 1200);
+
+        _timedOut.Should().ContainSingle().Which.Sid.Should().Be(2);
+        tracker.Count.Should().Be(0);
+    }
+
+    [Fact]
+    public void DisabledTracker_ShouldNotTrack()
+    {
+        var now = Environment.TickCount64;
+        var tracker = TrackerOf(0, 0, now);
+        tracker.Track(ActorOf(1));
+
+        tracker.Advance(now + 100000);
+
+        tracker.Enabled.Should().BeFalse();
+        tracker.Count.Should().Be(0);
+        _timedOut.Should().BeEmpty();
+    }
+}
\ No newline at end of file
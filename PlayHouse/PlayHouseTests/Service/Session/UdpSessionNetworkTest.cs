@@ -0,0 +1,284 @@
+﻿using System.Collections.Concurrent;
+using System.Net;
+using System.Net.Sockets;
+using FluentAssertions;
+using PlayHouse.Communicator.Message;
+using PlayHouse.Service.Session.Network;
+using PlayHouse.Service.Session.Network.udp;
+using Xunit;
+
+namespace PlayHouseTests.Service.Session;
+
+public class UdpSessionNetworkTest : IDisposable
+{
+    private readonly Socket _client = new(AddressFamily.InterNetwork, SocketType.Dgram, ProtocolType.Udp);
+    private readonly FakeListener _listener = new();
+    private readonly UdpSessionServer _server;
+
+    public UdpSessionNetworkTest()
+    {
+        _server = new UdpSessionServer(0, _listener, new HashSet<string> { "StateUpdate" }, 10000, 3);
+        _server.Start();
+        _client.Connect(new IPEndPoint(IPAddress.Loopback, _server.Port));
+        _client.ReceiveTimeout = 3000;
+    }
+
+    public void Dispose()
+    {
+        _server.Stop();
+        _client.Dispose();
+    }
+
+    private static byte[] Frame(string msgId, ushort msgSeq, bool hasErrorCode = false)
+    {
+        var buffer = new byte[64];
+        var size = PacketFrame.WriteHeader(buffer, 0, 1, msgId, 0, msgSeq, 0, hasErrorCode ? (ushort)0 : null);
+        return buffer[..size];
+    }
+
+    private ulong Challenge(Socket client, ulong nonce)
+    {
+        var datagram = new byte[UdpDatagram.ConnectSize];
+        UdpDatagram.WriteConnect(datagram, 0, nonce);
+        client.Send(datagram);
+        var challenge = Receive(client);
+        UdpDatagram.TypeOf(challenge).Should().Be(UdpPacketType.Challenge);
+        return UdpDatagram.CookieOf(challenge);
+    }
+
+    private void SendConnect(Socket client, ulong nonce, ulong cookie)
+    {
+        var datagram = new byte[UdpDatagram.CookieConnectSize];
+        UdpDatagram.WriteConnect(datagram, 0, nonce, cookie);
+        client.Send(datagram);
+    }
+
+    private ulong Connect(ulong nonce = 7)
+    {
+        SendConnect(_client, nonce, Challenge(_client, nonce));
+        var accept = Receive();
+        UdpDatagram.TypeOf(accept).Should().Be(UdpPacketType.Accept);
+        return UdpDatagram.TokenOf(accept);
+    }
+
+    private void SendData(ulong token, UdpChannel channel, uint seq, byte[] frames)
+    {
+        var datagram = new byte[UdpDatagram.Mtu];
+        var length = UdpDatagram.WriteData(datagram, token, channel, seq, frames);
+        _client.Send(datagram.AsSpan(0, length));
+    }
+
+    private byte[] Receive()
+    {
+        return Receive(_client);
+    }
+
+    private static byte[] Receive(Socket client)
+    {
+        var buffer = new byte[UdpDatagram.Mtu];
+        var size = client.Receive(buffer);
+        return buffer[..size];
+    }
+
+    private Socket NewClient()
+    {
+        var client = new Socket(AddressFamily.InterNetwork, SocketType.Dgram, ProtocolType.Udp);
+        client.Connect(new IPEndPoint(IPAddress.Loopback, _server.Port));
+        client.ReceiveTimeout = 3000;
+        return client;
+    }
+
+    [Fact]
+    public void Connect_ShouldIssueToken_AndNotifyListener()
+    {
+        var token = Connect();
+
+        token.Should().NotBe(0);
+        _listener.Connected.Should().HaveCount(1);
+
+        // a Connect resent after a lost Accept gets the same session
+        Connect().Should().Be(token);
+        _listener.Connected.Should().HaveCount(1);
+    }
+
+    [Fact]
+    public void ReliableData_ShouldBeDeliveredInOrder_AndAcked()
+    {
+        var token = Connect();
+
+        SendData(token, UdpChannel.ReliableOrdered, 1, Frame("Second", 2));
+        var ack = Receive();
+        UdpDatagram.AckOf(ack).Should().Be((0u, 1u));
+        _listener.Received.Should().BeEmpty();
+
+        SendData(token, UdpChannel.ReliableOrdered, 0, Frame("First", 1));
+        UdpDatagram.AckOf(Receive()).Should().Be((2u, 0u));
+
+        SpinWait.SpinUntil(() => _listener.Received.Count == 2, 1000);
+        _listener.Received.Select(p => p.MsgId).Should().Equal("First", "Second");
+    }
+
+    [Fact]
+    public void UnreliableData_ShouldDropStaleSeq()
+    {
+        var token = Connect();
+
+        SendData(token, UdpChannel.UnreliableSequenced, 5, Frame("New", 0));
+        SendData(token, UdpChannel.UnreliableSequenced, 3, Frame("Old", 0));
+        SendData(token, UdpChannel.UnreliableSequenced, 6, Frame("Newer", 0));
+
+        SpinWait.SpinUntil(() => _listener.Received.Count == 2, 1000);
+        Thread.Sleep(50);
+        _listener.Received.Select(p => p.MsgId).Should().Equal("New", "Newer");
+    }
+
+    [Fact]
+    public void Send_ShouldPickChannelByMsgId_AndRetransmitUntilAcked()
+    {
+        var token = Connect();
+        var session = _listener.Connected.Values.Single();
+
+        session.Send(new ClientPacket(new Header(msgId: "StateUpdate"), new MemoryPayload(Frame("StateUpdate", 0))));
+        var state = Receive();
+        UdpDatagram.ChannelOf(state).Should().Be(UdpChannel.UnreliableSequenced);
+
+        session.Send(new ClientPacket(new Header(msgId: "Reply", msgSeq: 1),
+            new MemoryPayload(Frame("Reply", 1, true))));
+        var reply = Receive();
+        UdpDatagram.ChannelOf(reply).Should().Be(UdpChannel.ReliableOrdered);
+        UdpDatagram.SeqOf(reply).Should().Be(0);
+
+        // without an ack it comes again
+        var again = Receive();
+        again.Should().Equal(reply);
+
+        var ack = new byte[UdpDatagram.AckSize];
+        UdpDatagram.WriteAck(ack, token, 1, 0);
+        _client.Send(ack);
+        Thread.Sleep(600);
+        _client.Available.Should().Be(0);
+    }
+
+    [Fact]
+    public void UnknownToken_ShouldBeIgnored()
+    {
+        Connect();
+
+        SendData(12345, UdpChannel.ReliableOrdered, 0, Frame("Spoofed", 1));
+
+        Thread.Sleep(100);
+        _client.Available.Should().Be(0);
+        _listener.Received.Should().BeEmpty();
+    }
+
+    [Fact]
+    public void ClientDisconnect_ShouldCloseSession()
+    {
+        var token = Connect();
+
+        var datagram = new byte[UdpDatagram.HeaderSize];
+        UdpDatagram.WriteHeader(datagram, UdpPacketType.Disconnect, token);
+        _client.Send(datagram);
+
+        SpinWait.SpinUntil(() => _listener.Disconnected.Count == 1, 1000);
+        _listener.Disconnected.Should().HaveCount(1);
+        _server.SessionCount.Should().Be(0);
+    }
+
+    [Fact]
+    public void Connect_ShouldNotCreateSession_WithoutValidCookie()
+    {
+        Challenge(_client, 7);
+        _listener.Connected.Should().BeEmpty();
+
+        SendConnect(_client, 7, 12345);
+        Thread.Sleep(100);
+        _client.Available.Should().Be(0);
+        _listener.Connected.Should().BeEmpty();
+
+        // a cookie issued to another address cannot be used
+        using var other = NewClient();
+        SendConnect(other, 7, Challenge(_client, 7));
+        Thread.Sleep(100);
+        other.Available.Should().Be(0);
+        _listener.Connected.Should().BeEmpty();
+    }
+
+    [Fact]
+    public void Connect_ShouldBeRateLimited_PerSource()
+    {
+        for (ulong nonce = 1; nonce <= 3; nonce++)
+        {
+            Connect(nonce);
+        }
+
+        SendConnect(_client, 4, Challenge(_client, 4));
+        Thread.Sleep(100);
+        _client.Available.Should().Be(0);
+        _listener.Connected.Should().HaveCount(3);
+    }
+
+    [Fact]
+    public void Rebind_ShouldHappen_OnlyForUnseenSeq()
+    {
+        var token = Connect();
+        SendData(token, UdpChannel.ReliableOrdered, 0, Frame("First", 1));
+        Receive();
+
+        // an already received seq replayed from another address is ignored
+        using var other = NewClient();
+        var datagram = new byte[UdpDatagram.Mtu];
+        var length = UdpDatagram.WriteData(datagram, token, UdpChannel.ReliableOrdered, 0, Frame("First", 1));
+        other.Send(datagram.AsSpan(0, length));
+        Thread.Sleep(100);
+        other.Available.Should().Be(0);
+
+        // a new seq moves the session to that address and the ack goes there
+        length = UdpDatagram.WriteData(datagram, token, UdpChannel.ReliableOrdered, 1, Frame("Second", 2));
+        other.Send(datagram.AsSpan(0, length));
+        UdpDatagram.AckOf(Receive(other)).Should().Be((2u, 0u));
+        _client.Available.Should().Be(0);
+    }
+
+    [Fact]
+    public void ReliableSender_ShouldKeepWindow_AndReleaseOnSelectiveAck()
+    {
+        var sent = new List<uint>();
+        var sender = new ReliableSender(1, datagram => sent.Add(UdpDatagram.SeqOf(datagram)), 2);
+
+        sender.Write(new byte[UdpDatagram.MaxSegmentSize * 3 + 1], 0);
+        sent.Should().Equal(0u, 1u);
+        sender.WaitingCount.Should().Be(2);
+
+        // only 1 received (bit 0 = nextExpected + 1)
+        sender.OnAck(0, 1, 10);
+        sent.Should().Equal(0u, 1u, 2u);
+        sender.InFlightCount.Should().Be(2);
+
+        sender.OnAck(3, 0, 20);
+        sent.Should().Equal(0u, 1u, 2u, 3u);
+        sender.InFlightCount.Should().Be(1);
+    }
+
+    private class FakeListener : ISessionListener
+    {
+        public ConcurrentDictionary<long, ISession> Connected { get; } = new();
+        public ConcurrentQueue<long> Disconnected { get; } = new();
+        public ConcurrentQueue<ClientPacket> Received { get; } = new();
+
+        public void OnConnect(long sid, ISession session)
+        {
+            Connected[sid] = session;
+        }
+
+        public void OnReceive(long sid, ClientPacket clientPacket)
+        {
+            Received.Enqueue(clientPacket);
+        }
+
+        public void OnDisconnect(long sid)
+        {
+            Disconnected.Enqueue(sid);
+        }
+    }
+}
\ No newline at end of file
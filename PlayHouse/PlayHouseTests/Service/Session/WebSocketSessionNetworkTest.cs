@@ -0,0 +1,71 @@
+﻿using ClientConnector;
+using CommonLib;
+using FluentAssertions;
+using Org.Ulalax.Playhouse.Protocol;
+using PlayHouse.Communicator;
+using PlayHouse.Production.Session;
+using PlayHouse.Service.Session.Network;
+using Xunit;
+
+namespace PlayHouseTests.Service.Session;
+
+[Collection("SessionNetworkTest")]
+public class WebSocketSessionNetworkTest
+{
+    public WebSocketSessionNetworkTest()
+    {
+        PooledBuffer.Init(1024 * 1024);
+    }
+
+    [Theory]
+    [InlineData(0)]
+    [InlineData(16 * 1024)]
+    public async Task BinaryMessagesAreExchangedOverWebSocket(int sendFlushBytes)
+    {
+        SessionServerListener serverListener = new() { UseWebSocket = true };
+        var port = IpFinder.FindFreePort();
+
+        var sessionNetwork = new SessionNetwork(
+            new SessionOption
+            {
+                UseWebSocket = true, WebSocketBinaryMode = true, SessionPort = port,
+                SendFlushBytes = sendFlushBytes
+            },
+            serverListener);
+
+        var serverThread = new Thread(() =>
+        {
+            sessionNetwork.Start();
+            sessionNetwork.Await();
+        });
+        serverThread.Start();
+
+        await Task.Delay(100);
+
+        await using (var connector = new Connector())
+        {
+            connector.Init(new ConnectorConfig
+                { Host = "127.0.0.1", Port = port, UseWebsocket = true, HeartBeatIntervalMs = 0 });
+            await connector.ConnectAsync();
+
+            await Task.Delay(100);
+            serverListener.ResultValue.Should().Be("onConnect");
+
+            // several frames batched in one message each get their own reply
+            var requests = Enumerable.Range(0, 10)
+                .Select(_ => connector.RequestAsync(1, new Packet(new TestMsg { TestMsg_ = "request" })).AsTask())
+                .ToList();
+
+            foreach (var request in requests)
+            {
+                using var reply = await request;
+                reply.Parse(TestMsg.Parser).TestMsg_.Should().Be("request");
+            }
+        }
+
+        await Task.Delay(100);
+        serverListener.ResultValue.Should().Be("onDisconnect");
+
+        sessionNetwork.Stop();
+    }
+}
\ No newline at end of file
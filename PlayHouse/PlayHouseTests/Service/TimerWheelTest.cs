@@ -0,0 +1,96 @@
+﻿using FluentAssertions;
+using PlayHouse.Service.Shared;
+using Xunit;
+
+namespace PlayHouseTests.Service;
+
+public class TimerWheelTest
+{
+    private static TimerEntry EntryOf(long timerId, long deadlineTick)
+    {
+        return new TimerEntry(1, timerId, 0, 0, () => Task.CompletedTask) { DeadlineTick = deadlineTick };
+    }
+
+    private static long FireTickOf(TimerWheel wheel, long maxTick)
+    {
+        var expired = new List<TimerEntry>();
+        while (wheel.CurrentTick < maxTick)
+        {
+            wheel.Advance(expired);
+            if (expired.Count > 0)
+            {
+                return wheel.CurrentTick;
+            }
+        }
+
+        return -1;
+    }
+
+    [Theory]
+    [InlineData(1)]
+    [InlineData(63)]
+    [InlineData(64)]
+    [InlineData(5000)]
+    [InlineData(300000)]
+    public void Entry_Should_Expire_On_Its_Deadline_Tick(long deadlineTick)
+    {
+        var wheel = new TimerWheel();
+        wheel.Add(EntryOf(1, deadlineTick));
+
+        FireTickOf(wheel, deadlineTick + 1).Should().Be(deadlineTick);
+    }
+
+    [Fact]
+    public void Canceled_Entry_Should_Be_Handed_Out_Once_As_Canceled()
+    {
+        var wheel = new TimerWheel();
+        var entry = EntryOf(1, 100);
+        wheel.Add(entry);
+
+        entry.Cancel();
+
+        var expired = new List<TimerEntry>();
+        while (wheel.CurrentTick < 300)
+        {
+            wheel.Advance(expired);
+        }
+
+        expired.Should().ContainSingle().Which.IsCanceled.Should().BeTrue();
+    }
+
+    [Fact]
+    public void Canceled_Far_Entry_Should_Be_Handed_Out_When_Its_Slot_Cascades()
+    {
+        var wheel = new TimerWheel();
+        var entry = EntryOf(1, 5000);
+        wheel.Add(entry);
+
+        entry.Cancel();
+
+        var expired = new List<TimerEntry>();
+        while (wheel.CurrentTick < 5000 && expired.Count == 0)
+        {
+            wheel.Advance(expired);
+        }
+
+        wheel.CurrentTick.Should().BeLessThan(5000);
+        expired.Should().ContainSingle().Which.IsCanceled.Should().BeTrue();
+    }
+
+    [Fact]
+    public void Entries_On_The_Same_Tick_Should_Expire_Together()
+    {
+        var wheel = new TimerWheel();
+        wheel.Add(EntryOf(1, 10));
+        wheel.Add(EntryOf(2, 10));
+        wheel.Add(EntryOf(3, 11));
+
+        var expired = new List<TimerEntry>();
+        for (var i = 0; i < 10; i++)
+        {
+            wheel.Advance(expired);
+        }
+
+        expired.Select(e => e.TimerId).Should().BeEquivalentTo(new[] { 1L, 2L });
+    }
+}
\ No newline at end of file
@@ -45,4 +45,57 @@ public class UniqueIdGeneratorTest
 
         ids.Count.Should().Be(10000);
     }
+
+    [Fact]
+    public void ReservedBlockShouldBeUniqueAndInOrder()
+    {
+        var before = _generator.NextId();
+        var block = _generator.NextIds(5000);
+        var after = _generator.NextId();
+
+        block.Distinct().Count().Should().Be(5000);
+        block.Should().BeInAscendingOrder();
+        block[0].Should().BeGreaterThan(before);
+        after.Should().BeGreaterThan(block[^1]);
+    }
+
+    [Fact]
+    public void SequenceOverflowShouldNotThrow()
+    {
+        // issuing more than 1024 in 1ms borrows the next ms
+        var ids = new long[UniqueIdGenerator.MaxBlockSize];
+        _generator.NextIds(ids);
+
+        ids.Distinct().Count().Should().Be(ids.Length);
+
+        var tooLarge = () => _generator.NextIds(UniqueIdGenerator.MaxBlockSize + 1);
+        tooLarge.Should().Throw<ArgumentOutOfRangeException>();
+    }
+
+    [Fact]
+    public void NodeIdShouldBeEncoded()
+    {
+        var generator = new UniqueIdGenerator(4095);
+        var id = generator.NextId();
+
+        ((id >> 10) & 4095).Should().Be(4095);
+    }
+
+    [Fact]
+    public void ConcurrentBlocksShouldNotOverlap()
+    {
+        var ids = new ConcurrentHashSet<long>();
+
+        Parallel.For(0, 100, _ =>
+        {
+            Span<long> block = stackalloc long[100];
+            _generator.NextIds(block);
+            foreach (var id in block)
+            {
+                ids.Add(id);
+            }
+        });
+
+        ids.Count.Should().Be(10000);
+    }
 }
\ No newline at end of file